@@ -0,0 +1,232 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "ActivityGate.h"
+
+#include <cstddef>
+
+// Below about -40 dBFS there is nothing worth demodulating
+const float ENERGY_THRESHOLD = 0.0001F;
+
+// Ratio of first difference energy to energy, about 0.1 for a 2400 Hz tone and 2.0 for white noise
+const float MAX_HF_RATIO = 0.5F;
+
+// Zero crossings per 48 kHz sample, 0.1 for a 2400 Hz tone and 0.5 for white noise
+const float MAX_CROSSING_RATE = 0.25F;
+
+// Four seconds, longer than the slowest receiver takes to declare a lost signal
+const uint16_t HANG_WINDOWS = 400U;
+
+CActivityGate::CActivityGate() :
+m_enabled(false),
+m_open(true),
+m_samples(NULL),
+m_dcSamples(NULL),
+m_ptr(0U),
+m_count(0U),
+m_replay(0U),
+m_energy(0.0F),
+m_diffEnergy(0.0F),
+m_crossings(0U),
+m_windowCount(0U),
+m_prev(0.0F),
+m_hang(HANG_WINDOWS),
+m_skipped(0U),
+m_processed(0U),
+m_closes(0U)
+{
+  m_samples   = new float[GATE_LOOKBACK_SAMPLES];
+  m_dcSamples = new float[GATE_LOOKBACK_SAMPLES];
+}
+
+CActivityGate::~CActivityGate()
+{
+  delete[] m_samples;
+  delete[] m_dcSamples;
+}
+
+void CActivityGate::setEnabled(bool enabled)
+{
+  m_enabled = enabled;
+
+  reset();
+}
+
+bool CActivityGate::isEnabled() const
+{
+  return m_enabled;
+}
+
+void CActivityGate::reset()
+{
+  m_open        = true;
+  m_hang        = HANG_WINDOWS;
+  m_count       = 0U;
+  m_replay      = 0U;
+  m_energy      = 0.0F;
+  m_diffEnergy  = 0.0F;
+  m_crossings   = 0U;
+  m_windowCount = 0U;
+}
+
+bool CActivityGate::process(const float* samples, const float* dcSamples, uint16_t length)
+{
+  if (!m_enabled) {
+    m_processed++;
+    return true;
+  }
+
+  bool opened = false;
+
+  for (uint16_t i = 0U; i < length; i++) {
+    float sample = dcSamples[i];
+
+    // Keep the history since the gate closed so that it can be replayed
+    if (!m_open) {
+      m_samples[m_ptr]   = samples[i];
+      m_dcSamples[m_ptr] = sample;
+
+      m_ptr++;
+      if (m_ptr >= GATE_LOOKBACK_SAMPLES)
+        m_ptr = 0U;
+
+      if (m_count < GATE_LOOKBACK_SAMPLES)
+        m_count++;
+    }
+
+    float diff = sample - m_prev;
+
+    m_energy     += sample * sample;
+    m_diffEnergy += diff * diff;
+
+    if ((sample < 0.0F) != (m_prev < 0.0F))
+      m_crossings++;
+
+    m_prev = sample;
+
+    m_windowCount++;
+    if (m_windowCount >= GATE_WINDOW_SAMPLES) {
+      if (isActive()) {
+        if (!m_open) {
+          m_open   = true;
+          m_replay = m_count;
+          opened   = true;
+        }
+
+        m_hang = HANG_WINDOWS;
+      } else if (m_hang > 0U) {
+        m_hang--;
+
+        if (m_hang == 0U && m_open) {
+          m_open  = false;
+          m_count = 0U;
+          m_closes++;
+        }
+      }
+
+      m_energy      = 0.0F;
+      m_diffEnergy  = 0.0F;
+      m_crossings   = 0U;
+      m_windowCount = 0U;
+    }
+  }
+
+  // The current block is part of the history and is returned by replay()
+  if (opened)
+    return false;
+
+  if (!m_open) {
+    m_skipped++;
+    return false;
+  }
+
+  m_processed++;
+
+  return true;
+}
+
+bool CActivityGate::hasReplay() const
+{
+  return m_replay > 0U;
+}
+
+bool CActivityGate::replay(float* samples, float* dcSamples, uint16_t length)
+{
+  if (m_replay < length)
+    return false;
+
+  uint16_t ptr = m_ptr + GATE_LOOKBACK_SAMPLES - m_replay;
+  if (ptr >= GATE_LOOKBACK_SAMPLES)
+    ptr -= GATE_LOOKBACK_SAMPLES;
+
+  for (uint16_t i = 0U; i < length; i++) {
+    samples[i]   = m_samples[ptr];
+    dcSamples[i] = m_dcSamples[ptr];
+
+    ptr++;
+    if (ptr >= GATE_LOOKBACK_SAMPLES)
+      ptr = 0U;
+  }
+
+  m_replay -= length;
+
+  // All but the block that opened the gate were counted as skipped
+  if (m_replay >= length && m_skipped > 0U)
+    m_skipped--;
+
+  m_processed++;
+
+  if (m_replay < length)
+    m_replay = 0U;
+
+  return true;
+}
+
+bool CActivityGate::isOpen() const
+{
+  return m_open;
+}
+
+bool CActivityGate::isQuiet() const
+{
+  return m_enabled && m_open && m_hang < HANG_WINDOWS;
+}
+
+void CActivityGate::getStats(uint32_t& skipped, uint32_t& processed, uint32_t& closes) const
+{
+  skipped   = m_skipped;
+  processed = m_processed;
+  closes    = m_closes;
+}
+
+bool CActivityGate::isActive() const
+{
+  float energy = m_energy / float(GATE_WINDOW_SAMPLES);
+  if (energy < ENERGY_THRESHOLD)
+    return false;
+
+  // Open squelch noise is broadband, 4FSK and GMSK are not
+  if (m_diffEnergy > (MAX_HF_RATIO * m_energy))
+    return false;
+
+  float crossings = float(m_crossings) / float(GATE_WINDOW_SAMPLES * RX_DECIMATION);
+  if (crossings > MAX_CROSSING_RATE)
+    return false;
+
+  return true;
+}
@@ -0,0 +1,79 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(ACTIVITYGATE_H)
+#define  ACTIVITYGATE_H
+
+#include "RXRate.h"
+
+#include <cstdint>
+
+// 100ms of history, enough for the filters to settle and for the first sync to be seen
+const uint16_t GATE_LOOKBACK_SAMPLES = RX_SAMPLE_RATE / 10U;
+
+// 10ms analysis window
+const uint16_t GATE_WINDOW_SAMPLES   = RX_SAMPLE_RATE / 100U;
+
+class CActivityGate {
+public:
+  CActivityGate();
+  ~CActivityGate();
+
+  void setEnabled(bool enabled);
+  bool isEnabled() const;
+
+  // Returns true if the demodulators should see this block
+  bool process(const float* samples, const float* dcSamples, uint16_t length);
+
+  bool hasReplay() const;
+
+  // After the gate opens, returns the look-back history oldest first
+  bool replay(float* samples, float* dcSamples, uint16_t length);
+
+  void reset();
+
+  bool isOpen() const;
+
+  // True when the gate is open but the last window had nothing in it
+  bool isQuiet() const;
+
+  // Blocks kept from and given to the demodulators, and the times the gate has closed
+  void getStats(uint32_t& skipped, uint32_t& processed, uint32_t& closes) const;
+
+private:
+  bool     m_enabled;
+  bool     m_open;
+  float*   m_samples;
+  float*   m_dcSamples;
+  uint16_t m_ptr;
+  uint16_t m_count;
+  uint16_t m_replay;
+  float    m_energy;
+  float    m_diffEnergy;
+  uint16_t m_crossings;
+  uint16_t m_windowCount;
+  float    m_prev;
+  uint16_t m_hang;
+  uint32_t m_skipped;
+  uint32_t m_processed;
+  uint32_t m_closes;
+
+  bool isActive() const;
+};
+
+#endif
@@ -19,6 +19,9 @@ public:
 	virtual void readCallback(const float* input, unsigned int nSamples) = 0;
 	virtual void writeCallback(float* output, int& nSamples) = 0;
 
+	// The sound card lost samples while capturing or playing
+	virtual void xrunCallback(bool capture) {}
+
 private:
 };
 
@@ -0,0 +1,328 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "AudioHub.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+const uint32_t HUB_MAGIC = 0x4D4D4842U;             // "MMHB"
+
+const uint32_t HUB_RING_MASK = HUB_RING_LENGTH - 1U;
+
+// How far ahead of the sound card the owner keeps the playback ring
+const uint32_t HUB_PLAYBACK_MS = 40U;
+
+static std::string getShmName(const std::string& name)
+{
+  return "/mmdvm-" + name;
+}
+
+CAudioHubPort::CAudioHubPort() :
+m_channel(NULL)
+{
+}
+
+void CAudioHubPort::setChannel(HubChannel* channel)
+{
+  m_channel = channel;
+}
+
+void CAudioHubPort::readCallback(const float* input, unsigned int nSamples)
+{
+  uint32_t head = m_channel->captureHead.load(std::memory_order_relaxed);
+
+  for (unsigned int i = 0U; i < nSamples; i++)
+    m_channel->capture[(head + i) & HUB_RING_MASK] = input[i];
+
+  m_channel->captureHead.store(head + nSamples, std::memory_order_release);
+}
+
+void CAudioHubPort::writeCallback(float* output, int& nSamples)
+{
+  uint32_t tail = m_channel->playbackTail.load(std::memory_order_relaxed);
+  uint32_t head = m_channel->playbackHead.load(std::memory_order_acquire);
+
+  uint32_t n = head - tail;
+  if (n > uint32_t(nSamples)) {
+    n = nSamples;
+  } else if (n < uint32_t(nSamples) && m_channel->owner.load(std::memory_order_relaxed) != 0) {
+    m_channel->underruns.fetch_add(1U, std::memory_order_relaxed);
+  }
+
+  for (uint32_t i = 0U; i < n; i++)
+    output[i] = m_channel->playback[(tail + i) & HUB_RING_MASK];
+
+  for (int i = n; i < nSamples; i++)
+    output[i] = 0.0F;
+
+  m_channel->playbackTail.store(tail + n, std::memory_order_release);
+}
+
+void CAudioHubPort::xrunCallback(bool capture)
+{
+  if (capture)
+    m_channel->captureXruns.fetch_add(1U, std::memory_order_relaxed);
+  else
+    m_channel->playbackXruns.fetch_add(1U, std::memory_order_relaxed);
+}
+
+CAudioHub::CAudioHub(const std::string& name, unsigned int sampleRate) :
+m_name(name),
+m_sampleRate(sampleRate),
+m_shared(NULL),
+m_ports()
+{
+}
+
+CAudioHub::~CAudioHub()
+{
+  close();
+}
+
+bool CAudioHub::open()
+{
+  std::string name = getShmName(m_name);
+
+  int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR, 0666);
+  if (fd == -1) {
+    ::fprintf(stderr, "Unable to create the audio hub %s, errno=%d\n", name.c_str(), errno);
+    return false;
+  }
+
+  if (::ftruncate(fd, sizeof(HubShared)) == -1) {
+    ::fprintf(stderr, "Unable to size the audio hub %s, errno=%d\n", name.c_str(), errno);
+    ::close(fd);
+    return false;
+  }
+
+  void* ptr = ::mmap(NULL, sizeof(HubShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if (ptr == MAP_FAILED) {
+    ::fprintf(stderr, "Unable to map the audio hub %s, errno=%d\n", name.c_str(), errno);
+    return false;
+  }
+
+  // Clients wait for the magic number, so it is written last
+  m_shared = static_cast<HubShared*>(ptr);
+  ::memset(ptr, 0x00U, sizeof(HubShared));
+  m_shared->sampleRate = m_sampleRate;
+  std::atomic_thread_fence(std::memory_order_release);
+  m_shared->magic = HUB_MAGIC;
+
+  for (unsigned int i = 0U; i < HUB_CHANNELS; i++)
+    m_ports[i].setChannel(&m_shared->channels[i]);
+
+  ::printf("Opened the audio hub %s\n", name.c_str());
+
+  return true;
+}
+
+IAudioCallback* CAudioHub::getPort(unsigned int channel)
+{
+  assert(channel < HUB_CHANNELS);
+
+  return &m_ports[channel];
+}
+
+void CAudioHub::close()
+{
+  if (m_shared == NULL)
+    return;
+
+  ::munmap(m_shared, sizeof(HubShared));
+  m_shared = NULL;
+
+  ::shm_unlink(getShmName(m_name).c_str());
+}
+
+CAudioHubClient::CAudioHubClient(const std::string& name, unsigned int channel) :
+CThread(),
+m_name(name),
+m_channel(channel),
+m_callback(NULL),
+m_shared(NULL),
+m_owner(false),
+m_killed(false),
+m_tail(0U),
+m_latency(0U),
+m_overruns(0U),
+m_captureXruns(0U),
+m_playbackXruns(0U),
+m_buffer(NULL)
+{
+  assert(channel < HUB_CHANNELS);
+
+  m_buffer = new float[HUB_RING_LENGTH];
+}
+
+CAudioHubClient::~CAudioHubClient()
+{
+  delete[] m_buffer;
+}
+
+void CAudioHubClient::setCallback(IAudioCallback* callback)
+{
+  assert(callback != NULL);
+
+  m_callback = callback;
+}
+
+bool CAudioHubClient::open()
+{
+  assert(m_callback != NULL);
+
+  std::string name = getShmName(m_name);
+
+  int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+  if (fd == -1) {
+    ::fprintf(stderr, "Unable to open the audio hub %s, is the hub running?\n", name.c_str());
+    return false;
+  }
+
+  void* ptr = ::mmap(NULL, sizeof(HubShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if (ptr == MAP_FAILED) {
+    ::fprintf(stderr, "Unable to map the audio hub %s, errno=%d\n", name.c_str(), errno);
+    return false;
+  }
+
+  m_shared = static_cast<HubShared*>(ptr);
+
+  if (m_shared->magic != HUB_MAGIC) {
+    ::fprintf(stderr, "The audio hub %s is not ready\n", name.c_str());
+    ::munmap(m_shared, sizeof(HubShared));
+    m_shared = NULL;
+    return false;
+  }
+
+  HubChannel& channel = m_shared->channels[m_channel];
+
+  // Only one process may transmit on a channel, the others only receive
+  int32_t pid   = ::getpid();
+  int32_t owner = 0;
+  if (channel.owner.compare_exchange_strong(owner, pid)) {
+    m_owner = true;
+  } else if (::kill(owner, 0) == -1 && errno == ESRCH && channel.owner.compare_exchange_strong(owner, pid)) {
+    // The previous owner has gone away
+    m_owner = true;
+  } else {
+    ::fprintf(stderr, "Channel %u of the audio hub %s is owned by process %d, receive only\n", m_channel, name.c_str(), owner);
+  }
+
+  if (m_owner)
+    channel.playbackHead.store(channel.playbackTail.load(std::memory_order_acquire), std::memory_order_release);
+
+  m_tail = channel.captureHead.load(std::memory_order_acquire);
+
+  m_latency = m_shared->sampleRate * HUB_PLAYBACK_MS / 1000U;
+  if (m_latency > (HUB_RING_LENGTH / 2U))
+    m_latency = HUB_RING_LENGTH / 2U;
+
+  m_captureXruns  = channel.captureXruns.load(std::memory_order_relaxed);
+  m_playbackXruns = channel.playbackXruns.load(std::memory_order_relaxed);
+
+  ::printf("Attached to channel %u of the audio hub %s\n", m_channel, name.c_str());
+
+  return run();
+}
+
+void CAudioHubClient::close()
+{
+  m_killed = true;
+
+  wait();
+
+  if (m_owner)
+    m_shared->channels[m_channel].owner.store(0, std::memory_order_release);
+
+  ::munmap(m_shared, sizeof(HubShared));
+  m_shared = NULL;
+}
+
+void CAudioHubClient::entry()
+{
+  HubChannel& channel = m_shared->channels[m_channel];
+
+  while (!m_killed) {
+    uint32_t head = channel.captureHead.load(std::memory_order_acquire);
+
+    if ((head - m_tail) > HUB_RING_LENGTH) {
+      m_overruns++;
+      ::fprintf(stderr, "Audio hub overrun on channel %u, %u so far\n", m_channel, m_overruns);
+      m_tail = head - (HUB_RING_LENGTH / 2U);
+      m_callback->xrunCallback(true);
+    }
+
+    // Pass on the sound card's own xruns
+    for (uint32_t xruns = channel.captureXruns.load(std::memory_order_relaxed); m_captureXruns != xruns; m_captureXruns++)
+      m_callback->xrunCallback(true);
+    for (uint32_t xruns = channel.playbackXruns.load(std::memory_order_relaxed); m_playbackXruns != xruns; m_playbackXruns++)
+      m_callback->xrunCallback(false);
+
+    uint32_t captured = head - m_tail;
+
+    // The samples are passed straight from the shared memory
+    while (m_tail != head) {
+      uint32_t ptr = m_tail & HUB_RING_MASK;
+
+      uint32_t n = head - m_tail;
+      if (n > (HUB_RING_LENGTH - ptr))
+        n = HUB_RING_LENGTH - ptr;
+
+      m_callback->readCallback(channel.capture + ptr, n);
+
+      m_tail += n;
+    }
+
+    if (m_owner) {
+      uint32_t playHead = channel.playbackHead.load(std::memory_order_relaxed);
+      uint32_t fill     = playHead - channel.playbackTail.load(std::memory_order_acquire);
+
+      if (fill < m_latency) {
+        int n = m_latency - fill;
+
+        for (int i = 0; i < n; i++)
+          m_buffer[i] = 0.0F;
+
+        m_callback->writeCallback(m_buffer, n);
+
+        for (int i = 0; i < n; i++)
+          channel.playback[(playHead + i) & HUB_RING_MASK] = m_buffer[i];
+
+        channel.playbackHead.store(playHead + n, std::memory_order_release);
+      }
+    } else if (captured > 0U) {
+      // Anything a receive only modem transmits is dropped at the capture rate
+      int n = captured;
+      m_callback->writeCallback(m_buffer, n);
+    }
+
+    CThread::sleep(1U);
+  }
+}
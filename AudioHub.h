@@ -0,0 +1,113 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(AUDIOHUB_H)
+#define  AUDIOHUB_H
+
+#include "AudioCallback.h"
+#include "Thread.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+const unsigned int HUB_CHANNELS    = 2U;        // Left and right
+const uint32_t     HUB_RING_LENGTH = 16384U;    // Samples, a power of two, 340 ms at 48 kHz
+
+// One sound card channel in the shared memory. The hub writes the capture
+// ring and any number of readers follow it, only the owner writes playback.
+struct HubChannel {
+  std::atomic<uint32_t> captureHead;
+  std::atomic<uint32_t> playbackHead;
+  std::atomic<uint32_t> playbackTail;
+  std::atomic<int32_t>  owner;              // The process id that may transmit, zero for none
+  std::atomic<uint32_t> underruns;
+  std::atomic<uint32_t> captureXruns;      // The sound card's, passed on to the clients
+  std::atomic<uint32_t> playbackXruns;
+  float                 capture[HUB_RING_LENGTH];
+  float                 playback[HUB_RING_LENGTH];
+};
+
+struct HubShared {
+  uint32_t   magic;
+  uint32_t   sampleRate;
+  HubChannel channels[HUB_CHANNELS];
+};
+
+// The hub side of one channel, driven by the sound card
+class CAudioHubPort : public IAudioCallback {
+public:
+  CAudioHubPort();
+
+  void setChannel(HubChannel* channel);
+
+  virtual void readCallback(const float* input, unsigned int nSamples);
+  virtual void writeCallback(float* output, int& nSamples);
+  virtual void xrunCallback(bool capture);
+
+private:
+  HubChannel* m_channel;
+};
+
+// Owns the PCM device's samples in shared memory, named /mmdvm-<name>
+class CAudioHub {
+public:
+  CAudioHub(const std::string& name, unsigned int sampleRate);
+  ~CAudioHub();
+
+  bool open();
+
+  IAudioCallback* getPort(unsigned int channel);
+
+  void close();
+
+private:
+  std::string   m_name;
+  unsigned int  m_sampleRate;
+  HubShared*    m_shared;
+  CAudioHubPort m_ports[HUB_CHANNELS];
+};
+
+// A modem or a monitor attached to one channel of a hub, in place of a sound card
+class CAudioHubClient : public CThread {
+public:
+  CAudioHubClient(const std::string& name, unsigned int channel);
+  virtual ~CAudioHubClient();
+
+  void setCallback(IAudioCallback* callback);
+  bool open();
+  void close();
+
+  virtual void entry();
+
+private:
+  std::string     m_name;
+  unsigned int    m_channel;
+  IAudioCallback* m_callback;
+  HubShared*      m_shared;
+  bool            m_owner;
+  bool            m_killed;
+  uint32_t        m_tail;
+  uint32_t        m_latency;
+  uint32_t        m_overruns;
+  uint32_t        m_captureXruns;
+  uint32_t        m_playbackXruns;
+  float*          m_buffer;
+};
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "AudioStats.h"
+
+#include <cstdio>
+#include <ctime>
+
+const uint64_t LOG_INTERVAL = 60000U;
+
+// In the order of AUDIO_EVENT
+static const char* EVENT_NAMES[AUDIO_EVENT_COUNT] = {
+  "rx_overflow", "tx_overflow", "tx_underrun", "capture_xrun", "playback_xrun"
+};
+
+CAudioStats::CAudioStats(uint16_t rxLength, uint16_t txLength) :
+m_rxLength(rxLength),
+m_txLength(txLength),
+m_rxLevel(),
+m_txLevel(),
+m_rxHighWater(),
+m_txHighWater(),
+m_events(),
+m_samples(),
+m_recent(),
+m_recentHead(),
+m_logTime(0U),
+m_logged(0U)
+{
+  m_rxLevel.store(0U, std::memory_order_relaxed);
+  m_txLevel.store(0U, std::memory_order_relaxed);
+  m_rxHighWater.store(0U, std::memory_order_relaxed);
+  m_txHighWater.store(0U, std::memory_order_relaxed);
+
+  for (unsigned int i = 0U; i < AUDIO_EVENT_COUNT; i++) {
+    m_events[i].store(0U, std::memory_order_relaxed);
+    m_samples[i].store(0U, std::memory_order_relaxed);
+  }
+
+  for (unsigned int i = 0U; i < RECENT_EVENTS; i++)
+    m_recent[i].store(0U, std::memory_order_relaxed);
+
+  m_recentHead.store(0U, std::memory_order_relaxed);
+}
+
+void CAudioStats::addEvent(AUDIO_EVENT event, uint32_t samples)
+{
+  m_events[event].fetch_add(1U, std::memory_order_relaxed);
+  m_samples[event].fetch_add(samples, std::memory_order_relaxed);
+
+  uint32_t pos = m_recentHead.fetch_add(1U, std::memory_order_relaxed);
+  m_recent[pos % RECENT_EVENTS].store((getTime() << 8) | event, std::memory_order_relaxed);
+}
+
+void CAudioStats::setRXLevel(uint16_t level)
+{
+  m_rxLevel.store(level, std::memory_order_relaxed);
+
+  // Each level is only set by one thread, so there is no race on the high water mark
+  if (level > m_rxHighWater.load(std::memory_order_relaxed))
+    m_rxHighWater.store(level, std::memory_order_relaxed);
+}
+
+void CAudioStats::setTXLevel(uint16_t level)
+{
+  m_txLevel.store(level, std::memory_order_relaxed);
+
+  if (level > m_txHighWater.load(std::memory_order_relaxed))
+    m_txHighWater.store(level, std::memory_order_relaxed);
+}
+
+uint16_t CAudioStats::getRXLevel() const
+{
+  return m_rxLevel.load(std::memory_order_relaxed);
+}
+
+uint16_t CAudioStats::getTXLevel() const
+{
+  return m_txLevel.load(std::memory_order_relaxed);
+}
+
+uint16_t CAudioStats::getRXHighWater() const
+{
+  return m_rxHighWater.load(std::memory_order_relaxed);
+}
+
+uint16_t CAudioStats::getTXHighWater() const
+{
+  return m_txHighWater.load(std::memory_order_relaxed);
+}
+
+uint16_t CAudioStats::getRXLength() const
+{
+  return m_rxLength;
+}
+
+uint16_t CAudioStats::getTXLength() const
+{
+  return m_txLength;
+}
+
+uint32_t CAudioStats::getEvents(AUDIO_EVENT event) const
+{
+  return m_events[event].load(std::memory_order_relaxed);
+}
+
+uint32_t CAudioStats::getSamples(AUDIO_EVENT event) const
+{
+  return m_samples[event].load(std::memory_order_relaxed);
+}
+
+unsigned int CAudioStats::getRecent(AudioEvent* events) const
+{
+  uint32_t head = m_recentHead.load(std::memory_order_relaxed);
+
+  unsigned int count = 0U;
+  while (count < RECENT_EVENTS && count < head) {
+    uint64_t value = m_recent[(head - count - 1U) % RECENT_EVENTS].load(std::memory_order_relaxed);
+
+    events[count].event = AUDIO_EVENT(value & 0xFFU);
+    events[count].time  = value >> 8;
+    count++;
+  }
+
+  return count;
+}
+
+const char* CAudioStats::getName(AUDIO_EVENT event)
+{
+  return EVENT_NAMES[event];
+}
+
+uint64_t CAudioStats::getTime()
+{
+  struct timespec ts;
+  ::clock_gettime(CLOCK_REALTIME, &ts);
+
+  return uint64_t(ts.tv_sec) * 1000U + ts.tv_nsec / 1000000U;
+}
+
+void CAudioStats::log(const std::string& name)
+{
+  uint64_t time = getTime();
+  if (m_logTime == 0U)
+    m_logTime = time;
+
+  if ((time - m_logTime) < LOG_INTERVAL)
+    return;
+
+  m_logTime = time;
+
+  // A changed high water mark is enough to log, it is what the rings are sized from
+  uint32_t logged = getRXHighWater() + getTXHighWater();
+  for (unsigned int i = 0U; i < AUDIO_EVENT_COUNT; i++)
+    logged += getEvents(AUDIO_EVENT(i));
+
+  if (logged == m_logged)
+    return;
+
+  m_logged = logged;
+
+  ::fprintf(stderr, "Audio %s: rx ring %u/%u max %u, tx ring %u/%u max %u", name.c_str(),
+    getRXLevel(), m_rxLength, getRXHighWater(), getTXLevel(), m_txLength, getTXHighWater());
+
+  for (unsigned int i = 0U; i < AUDIO_EVENT_COUNT; i++)
+    ::fprintf(stderr, ", %s %u (%u samples)", EVENT_NAMES[i], getEvents(AUDIO_EVENT(i)), getSamples(AUDIO_EVENT(i)));
+
+  ::fprintf(stderr, "\n");
+}
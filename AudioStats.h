@@ -0,0 +1,88 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(AUDIOSTATS_H)
+#define  AUDIOSTATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+enum AUDIO_EVENT {
+  AUDIO_RX_OVERFLOW,      // The receive ring was full, samples from the sound card were dropped
+  AUDIO_TX_OVERFLOW,      // The transmit ring was full, modulated samples were dropped
+  AUDIO_TX_UNDERRUN,      // The transmit ring ran dry while transmitting
+  AUDIO_CAPTURE_XRUN,     // The sound card, or the hub, lost captured samples
+  AUDIO_PLAYBACK_XRUN,    // The sound card ran out of samples to play
+  AUDIO_EVENT_COUNT
+};
+
+struct AudioEvent {
+  AUDIO_EVENT event;
+  uint64_t    time;       // Milliseconds since the epoch
+};
+
+// The occupancy of the sample rings and the times they, or the sound card, lost samples.
+// Any thread may add to it.
+class CAudioStats {
+public:
+  CAudioStats(uint16_t rxLength, uint16_t txLength);
+
+  static const unsigned int RECENT_EVENTS = 8U;
+
+  void addEvent(AUDIO_EVENT event, uint32_t samples);
+
+  void setRXLevel(uint16_t level);
+  void setTXLevel(uint16_t level);
+
+  uint16_t getRXLevel() const;
+  uint16_t getTXLevel() const;
+  uint16_t getRXHighWater() const;
+  uint16_t getTXHighWater() const;
+  uint16_t getRXLength() const;
+  uint16_t getTXLength() const;
+
+  uint32_t getEvents(AUDIO_EVENT event) const;
+  uint32_t getSamples(AUDIO_EVENT event) const;
+
+  // The most recent events, newest first, returns how many there are
+  unsigned int getRecent(AudioEvent* events) const;
+
+  static const char* getName(AUDIO_EVENT event);
+
+  static uint64_t getTime();
+
+  // Logs a summary once a minute, when something has changed since the last one
+  void log(const std::string& name);
+
+private:
+  uint16_t              m_rxLength;
+  uint16_t              m_txLength;
+  std::atomic<uint16_t> m_rxLevel;
+  std::atomic<uint16_t> m_txLevel;
+  std::atomic<uint16_t> m_rxHighWater;
+  std::atomic<uint16_t> m_txHighWater;
+  std::atomic<uint32_t> m_events[AUDIO_EVENT_COUNT];
+  std::atomic<uint32_t> m_samples[AUDIO_EVENT_COUNT];
+  std::atomic<uint64_t> m_recent[RECENT_EVENTS];     // The time and the event
+  std::atomic<uint32_t> m_recentHead;
+  uint64_t              m_logTime;
+  uint32_t              m_logged;                    // The events and high water marks last logged
+};
+
+#endif
@@ -18,11 +18,89 @@
 
 #include "Biquad.h"
 
+#include <cstddef>
+
+#if defined(FIXED_POINT)
+// The coefficients are held in Q31, so they must all be less than one
+CBiquad::CBiquad(uint32_t numStages, const float* pCoeffs) :
+m_numStages(numStages),
+m_pCoeffs(NULL),
+m_pState(NULL)
+{
+  m_pCoeffs = new q31_t[5U * numStages];
+  for (uint32_t i = 0U; i < (5U * numStages); i++)
+    m_pCoeffs[i] = floatToQ31(pCoeffs[i]);
+
+  m_pState = new q31_t[4U * numStages]();
+}
+
+void CBiquad::process(const float* pSrc, float* pDst, uint32_t blockSize)
+{
+  const float *pIn = pSrc;                   /*  source pointer            */
+  float *pOut = pDst;                        /*  destination pointer       */
+  q31_t *pState = m_pState;                  /*  pState pointer            */
+  const q31_t *pCoeffs = m_pCoeffs;          /*  coefficient pointer       */
+  q63_t acc;                                 /*  Simulates the accumulator */
+  q31_t b0, b1, b2, a1, a2;                  /*  Filter coefficients       */
+  q31_t Xn1, Xn2, Yn1, Yn2;                  /*  Filter pState variables   */
+  q31_t Xn;                                  /*  temporary input           */
+  uint32_t sample, stage = m_numStages;      /*  loop counters             */
+
+  do
+  {
+    b0 = *pCoeffs++;
+    b1 = *pCoeffs++;
+    b2 = *pCoeffs++;
+    a1 = *pCoeffs++;
+    a2 = *pCoeffs++;
+
+    Xn1 = pState[0];
+    Xn2 = pState[1];
+    Yn1 = pState[2];
+    Yn2 = pState[3];
+
+    sample = blockSize;
+
+    while (sample > 0U)
+    {
+      /* Read the input as Q15 and widen it to Q31, the pole is too close to one for Q15 */
+      Xn = q31_t(floatToQ15(*pIn++)) << 16;
+
+      /* Q31 * Q31 gives Q62 */
+      acc = (q63_t(b0) * Xn) + (q63_t(b1) * Xn1) + (q63_t(b2) * Xn2) + (q63_t(a1) * Yn1) + (q63_t(a2) * Yn2);
+
+      q31_t out = clipQ31(acc >> 31);
+
+      *pOut++ = q31ToFloat(out);
+
+      Xn2 = Xn1;
+      Xn1 = Xn;
+      Yn2 = Yn1;
+      Yn1 = out;
+
+      sample--;
+    }
+
+    *pState++ = Xn1;
+    *pState++ = Xn2;
+    *pState++ = Yn1;
+    *pState++ = Yn2;
+
+    /*  Subsequent stages occur in-place in the output buffer */
+    pIn = pDst;
+
+    pOut = pDst;
+
+    stage--;
+
+  } while (stage > 0U);
+}
+#else
 CBiquad::CBiquad(uint32_t numStages, const float* pCoeffs) :
 m_numStages(numStages),
 m_pCoeffs(pCoeffs)
 {
-  m_pState = new float[4U * numStages];
+  m_pState = new float[4U * numStages]();
 }
 
 void CBiquad::process(const float* pSrc, float* pDst, uint32_t blockSize)
@@ -103,3 +181,4 @@ void CBiquad::process(const float* pSrc, float* pDst, uint32_t blockSize)
   } while (stage > 0U);
 }
 
+#endif
@@ -19,6 +19,8 @@
 #if !defined(BIQUAD_H)
 #define  BIQUAD_H
 
+#include "FixedPoint.h"
+
 #include <cstdint>
 
 class CBiquad {
@@ -29,8 +31,13 @@ public:
 
 private:
   uint16_t     m_numStages;
+#if defined(FIXED_POINT)
+  q31_t*       m_pCoeffs;
+  q31_t*       m_pState;
+#else
   const float* m_pCoeffs;
   float*       m_pState;
+#endif
 };
 
 #endif
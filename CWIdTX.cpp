@@ -85,7 +85,8 @@ const uint8_t BIT_MASK_TABLE[] = {0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x02
 #define WRITE_BIT1(p,i,b) p[(i)>>3] = (b) ? (p[(i)>>3] | BIT_MASK_TABLE[(i)&7]) : (p[(i)>>3] & ~BIT_MASK_TABLE[(i)&7])
 #define READ_BIT1(p,i)    (p[(i)>>3] & BIT_MASK_TABLE[(i)&7])
 
-CCWIdTX::CCWIdTX() :
+CCWIdTX::CCWIdTX(CModem& modem) :
+m_modem(modem),
 m_poBuffer(),
 m_poLen(0U),
 m_poPtr(0U),
@@ -98,14 +99,14 @@ void CCWIdTX::process()
   if (m_poLen == 0U)
     return;
 
-  uint16_t space = io.getSpace();
+  uint16_t space = m_modem.io.getSpace();
     
   while (space > CYCLE_LENGTH) {
     bool b = READ_BIT1(m_poBuffer, m_poPtr);
     if (b)
-      io.write(STATE_CWID, TONE, CYCLE_LENGTH);
+      m_modem.io.write(STATE_CWID, TONE, CYCLE_LENGTH);
     else
-      io.write(STATE_CWID, SILENCE, CYCLE_LENGTH);
+      m_modem.io.write(STATE_CWID, SILENCE, CYCLE_LENGTH);
 
     space -= CYCLE_LENGTH;
 
@@ -20,9 +20,11 @@
 #if !defined(CWIDTX_H)
 #define  CWIDTX_H
 
+class CModem;
+
 class CCWIdTX {
 public:
-  CCWIdTX();
+  CCWIdTX(CModem& modem);
 
   void process();
 
@@ -31,6 +33,7 @@ public:
   void reset();
 
 private:
+  CModem&  m_modem;
   uint8_t  m_poBuffer[1000U];
   uint16_t m_poLen;
   uint16_t m_poPtr;
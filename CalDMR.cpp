@@ -47,7 +47,8 @@ const uint8_t SYNCEMB_DMO1K[6][7] = {
          {0x01U, 0x50U, 0xA1U, 0x71U, 0xD1U, 0x70U, 0x70U},   // EMB + Embedded LC4 (audio seq 4)
          {0x01U, 0x10U, 0x00U, 0x00U, 0x00U, 0x0EU, 0x20U}};  // EMB                (audio seq 5)
 
-CCalDMR::CCalDMR() :
+CCalDMR::CCalDMR(CModem& modem) :
+m_modem(modem),
 m_transmit(false),
 m_state(DMRCAL1K_IDLE),
 m_dmr1k(),
@@ -58,14 +59,14 @@ m_audioSeq(0)
 
 void CCalDMR::process()
 {
-  switch (m_modemState) {
+  switch (m_modem.modemState) {
     case STATE_DMRCAL:
     case STATE_LFCAL:
       if (m_transmit) {
-        dmrDMOTX.setCal(true);
-        dmrDMOTX.process();
+        m_modem.dmrDMOTX.setCal(true);
+        m_modem.dmrDMOTX.process();
       } else {
-        dmrDMOTX.setCal(false);
+        m_modem.dmrDMOTX.setCal(false);
       }
       break;
     case STATE_DMRDMO1K:
@@ -89,20 +90,20 @@ void CCalDMR::createDataDMO1k(uint8_t n)
 
 void CCalDMR::dmrdmo1k()
 {
-  dmrDMOTX.process();
+  m_modem.dmrDMOTX.process();
 
-  uint16_t space = dmrDMOTX.getSpace();
+  uint16_t space = m_modem.dmrDMOTX.getSpace();
   if (space < 1U)
     return;
 
   switch (m_state) {
     case DMRCAL1K_VH:
-      dmrDMOTX.writeData(VH_DMO1K, DMR_FRAME_LENGTH_BYTES + 1U);
+      m_modem.dmrDMOTX.writeData(VH_DMO1K, DMR_FRAME_LENGTH_BYTES + 1U);
       m_state = DMRCAL1K_VOICE;
       break;
     case DMRCAL1K_VOICE:
       createDataDMO1k(m_audioSeq);
-      dmrDMOTX.writeData(m_dmr1k, DMR_FRAME_LENGTH_BYTES + 1U);
+      m_modem.dmrDMOTX.writeData(m_dmr1k, DMR_FRAME_LENGTH_BYTES + 1U);
       if(m_audioSeq == 5U) {
         m_audioSeq = 0U;
         if(!m_transmit)
@@ -111,7 +112,7 @@ void CCalDMR::dmrdmo1k()
         m_audioSeq++;
       break;
     case DMRCAL1K_VT:
-      dmrDMOTX.writeData(VT_DMO1K, DMR_FRAME_LENGTH_BYTES + 1U);
+      m_modem.dmrDMOTX.writeData(VT_DMO1K, DMR_FRAME_LENGTH_BYTES + 1U);
       m_state = DMRCAL1K_IDLE;
       break;
     default:
@@ -128,7 +129,7 @@ uint8_t CCalDMR::write(const uint8_t* data, uint8_t length)
 
   m_transmit = data[0U] == 1U;
 
-  if (m_transmit && m_state == DMRCAL1K_IDLE && m_modemState == STATE_DMRDMO1K)
+  if (m_transmit && m_state == DMRCAL1K_IDLE && m_modem.modemState == STATE_DMRDMO1K)
     m_state = DMRCAL1K_VH;
 
   return 0U;
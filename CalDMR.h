@@ -29,9 +29,11 @@ enum DMRCAL1K {
   DMRCAL1K_VT
 };
 
+class CModem;
+
 class CCalDMR {
 public:
-  CCalDMR();
+  CCalDMR(CModem& modem);
 
   void process();
   void dmrdmo1k();
@@ -41,6 +43,7 @@ public:
   uint8_t write(const uint8_t* data, uint8_t length);
 
 private:
+  CModem&   m_modem;
   bool      m_transmit;
   DMRCAL1K  m_state;
   uint8_t   m_dmr1k[DMR_FRAME_LENGTH_BYTES + 1U];
@@ -23,7 +23,7 @@
 const unsigned int BUFFER_LENGTH = 200U;
 
 const uint32_t PLLMAX = 0x10000U;
-const uint32_t PLLINC = PLLMAX / DSTAR_RADIO_SYMBOL_LENGTH;
+const uint32_t PLLINC = PLLMAX / DSTAR_RX_SYMBOL_LENGTH;
 const uint32_t INC    = PLLINC / 32U;
 
 // D-Star bit order version of 0x55 0x2D 0x16
@@ -32,7 +32,8 @@ const uint32_t DATA_SYNC_DATA2 = 0x00554B97U;
 const uint32_t DATA_SYNC_MASK  = 0x00FFFFFFU;
 const uint8_t  DATA_SYNC_ERRS  = 2U;
 
-CCalDStarRX::CCalDStarRX() :
+CCalDStarRX::CCalDStarRX(CModem& modem) :
+m_modem(modem),
 m_pll(0U),
 m_prev(false),
 m_patternBuffer(0x00U),
@@ -98,7 +99,7 @@ void CCalDStarRX::process(float value)
       buffer[3U] = (intMin >> 8) & 0xFFU;
       buffer[4U] = (intMin >> 0) & 0xFFU;
 
-      serial.writeCalData(buffer, 5U);
+      m_modem.serial.writeCalData(buffer, 5U);
     }
   }
 
@@ -126,7 +127,7 @@ void CCalDStarRX::process(float value)
       buffer[3U] = (intMin >> 8) & 0xFFU;
       buffer[4U] = (intMin >> 0) & 0xFFU;
 
-      serial.writeCalData(buffer, 5U);
+      m_modem.serial.writeCalData(buffer, 5U);
     }
   }
 }
@@ -21,13 +21,16 @@
 
 #include "DStarDefines.h"
 
+class CModem;
+
 class CCalDStarRX {
 public:
-  CCalDStarRX();
+  CCalDStarRX(CModem& modem);
 
   void samples(const float* samples, uint8_t length);
 
 private:
+  CModem&  m_modem;
   uint32_t m_pll;
   bool     m_prev;
   uint32_t m_patternBuffer;
@@ -27,7 +27,8 @@ const uint8_t HEADER[] = {0x00U, 0x00U, 0x00U, 'D', 'I', 'R', 'E', 'C', 'T', ' '
 
 const uint8_t SLOW_DATA_TEXT[] = {'M', 'M', 'D', 'V', 'M', ' ', 'M', 'o', 'd', 'e', 'm', ' ', 'T', 'e', 's', 't', ' ', ' ', ' ', ' '};
 
-CCalDStarTX::CCalDStarTX() :
+CCalDStarTX::CCalDStarTX(CModem& modem) :
+m_modem(modem),
 m_transmit(false),
 m_count(0U)
 {
@@ -35,12 +36,12 @@ m_count(0U)
 
 void CCalDStarTX::process()
 {
-  dstarTX.process();
+  m_modem.dstarTX.process();
 
   if (!m_transmit)
     return;
 
-  uint16_t space = dstarTX.getSpace();
+  uint16_t space = m_modem.dstarTX.getSpace();
   if (space < 5U)
     return;
 
@@ -156,7 +157,7 @@ void CCalDStarTX::process()
     buffer[11U] = DSTAR_SCRAMBLER_BYTES[2U] ^ 'f';
   }
 
-  dstarTX.writeData(buffer, DSTAR_DATA_LENGTH_BYTES);
+  m_modem.dstarTX.writeData(buffer, DSTAR_DATA_LENGTH_BYTES);
 
   m_count = (m_count + 1U) % (30U * 21U);
 }
@@ -170,9 +171,9 @@ uint8_t CCalDStarTX::write(const uint8_t* data, uint8_t length)
 
   if (transmit && !m_transmit) {
     m_count = 0U;
-    dstarTX.writeHeader(HEADER, DSTAR_HEADER_LENGTH_BYTES);
+    m_modem.dstarTX.writeHeader(HEADER, DSTAR_HEADER_LENGTH_BYTES);
   } else if (!transmit && m_transmit) {
-    dstarTX.writeEOT();
+    m_modem.dstarTX.writeEOT();
   }
 
   m_transmit = transmit;
@@ -21,15 +21,18 @@
 
 #include "DStarDefines.h"
 
+class CModem;
+
 class CCalDStarTX {
 public:
-  CCalDStarTX();
+  CCalDStarTX(CModem& modem);
 
   uint8_t write(const uint8_t* data, uint8_t length);
 
   void process();
 
 private:
+  CModem&   m_modem;
   bool      m_transmit;
   uint16_t  m_count;
 };
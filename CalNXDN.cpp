@@ -50,7 +50,8 @@ const uint8_t NXDN_CAL1K[4][49] = {
                              0xCEU, 0xA2U, 0xFCU, 0x01U, 0x8CU, 0xECU, 0xDAU, 0x0AU, 0xA0U,
                              0xEEU, 0x8AU, 0x7EU, 0x2BU, 0x26U, 0xCCU, 0xF8U, 0x8AU, 0x08U}};
 
-CCalNXDN::CCalNXDN() :
+CCalNXDN::CCalNXDN(CModem& modem) :
+m_modem(modem),
 m_transmit(false),
 m_state(NXDNCAL1K_IDLE),
 m_audioSeq(0U)
@@ -59,15 +60,15 @@ m_audioSeq(0U)
 
 void CCalNXDN::process()
 {
-  nxdnTX.process();
+  m_modem.nxdnTX.process();
 
-  uint16_t space = nxdnTX.getSpace();
+  uint16_t space = m_modem.nxdnTX.getSpace();
   if (space < 1U)
     return;
 
   switch (m_state) {
     case NXDNCAL1K_TX:
-      nxdnTX.writeData(NXDN_CAL1K[m_audioSeq], NXDN_FRAME_LENGTH_BYTES + 1U);
+      m_modem.nxdnTX.writeData(NXDN_CAL1K[m_audioSeq], NXDN_FRAME_LENGTH_BYTES + 1U);
       m_audioSeq = (m_audioSeq + 1U) % 4U;
       if(!m_transmit)
         m_state = NXDNCAL1K_IDLE;
@@ -25,15 +25,18 @@ enum NXDNCAL1K {
   NXDNCAL1K_TX
 };
 
+class CModem;
+
 class CCalNXDN {
 public:
-  CCalNXDN();
+  CCalNXDN(CModem& modem);
 
   void process();
 
   uint8_t write(const uint8_t* data, uint8_t length);
 
 private:
+  CModem&   m_modem;
   bool      m_transmit;
   NXDNCAL1K m_state;
   uint8_t   m_audioSeq;
@@ -50,7 +50,8 @@ unsigned char LDU2_1K[] = {0x00,
                            0x33, 0xC0, 0xBE, 0x1B, 0x91, 0x84, 0x4F, 0xF0, 0x58, 0x29, 0x62, 0x76, 0x0E, 0x40, 0x00, 0x00, 0x00, 0x0C,
                            0x89, 0x28, 0x49, 0x0D, 0x43, 0x3C, 0x0B, 0xE1, 0xB8, 0x46, 0x11, 0x3F, 0xC1, 0x62, 0x96, 0x27, 0x60, 0xEC};
 
-CCalP25::CCalP25() :
+CCalP25::CCalP25(CModem& modem) :
+m_modem(modem),
 m_transmit(false),
 m_state(P25CAL1K_IDLE)
 {
@@ -58,19 +59,19 @@ m_state(P25CAL1K_IDLE)
 
 void CCalP25::process()
 {
-  p25TX.process();
+  m_modem.p25TX.process();
 
-  uint16_t space = p25TX.getSpace();
+  uint16_t space = m_modem.p25TX.getSpace();
   if (space < 1U)
     return;
 
   switch (m_state) {
     case P25CAL1K_LDU1:
-      p25TX.writeData(LDU1_1K, P25_LDU_FRAME_LENGTH_BYTES + 1U);
+      m_modem.p25TX.writeData(LDU1_1K, P25_LDU_FRAME_LENGTH_BYTES + 1U);
       m_state = P25CAL1K_LDU2;
       break;
     case P25CAL1K_LDU2:
-      p25TX.writeData(LDU2_1K, P25_LDU_FRAME_LENGTH_BYTES + 1U);
+      m_modem.p25TX.writeData(LDU2_1K, P25_LDU_FRAME_LENGTH_BYTES + 1U);
       if(!m_transmit)
         m_state = P25CAL1K_IDLE;
       else
@@ -28,15 +28,18 @@ enum P25CAL1K {
   P25CAL1K_LDU2
 };
 
+class CModem;
+
 class CCalP25 {
 public:
-  CCalP25();
+  CCalP25(CModem& modem);
 
   void process();
 
   uint8_t write(const uint8_t* data, uint8_t length);
 
 private:
+  CModem&   m_modem;
   bool      m_transmit;
   P25CAL1K  m_state;
 };
@@ -20,7 +20,8 @@
 #include "CalPOCSAG.h"
 
 
-CCalPOCSAG::CCalPOCSAG() :
+CCalPOCSAG::CCalPOCSAG(CModem& modem) :
+m_modem(modem),
 m_state(POCSAGCAL_IDLE)
 {
 }
@@ -30,11 +31,11 @@ void CCalPOCSAG::process()
   if (m_state == POCSAGCAL_IDLE)
     return;
 
-  uint16_t space = io.getSpace();
+  uint16_t space = m_modem.io.getSpace();
   if (space <= 165U)
     return;
 
-  pocsagTX.writeByte(0xAAU);
+  m_modem.pocsagTX.writeByte(0xAAU);
 }
 
 uint8_t CCalPOCSAG::write(const uint8_t* data, uint8_t length)
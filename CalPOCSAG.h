@@ -24,15 +24,18 @@ enum POCSAGCAL {
   POCSAGCAL_TX
 };
 
+class CModem;
+
 class CCalPOCSAG {
 public:
-  CCalPOCSAG();
+  CCalPOCSAG(CModem& modem);
 
   void process();
 
   uint8_t write(const uint8_t* data, uint8_t length);
 
 private:
+  CModem&   m_modem;
   POCSAGCAL m_state;
 };
 
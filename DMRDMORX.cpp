@@ -38,7 +38,8 @@ const uint8_t CONTROL_NONE  = 0x00U;
 const uint8_t CONTROL_VOICE = 0x20U;
 const uint8_t CONTROL_DATA  = 0x40U;
 
-CDMRDMORX::CDMRDMORX() :
+CDMRDMORX::CDMRDMORX(CModem& modem) :
+m_modem(modem),
 m_bitBuffer(),
 m_buffer(),
 m_bitPtr(0U),
@@ -47,15 +48,16 @@ m_syncPtr(0U),
 m_startPtr(0U),
 m_endPtr(NOENDPTR),
 m_maxCorr(0.0F),
-m_centre(),
-m_threshold(),
-m_averagePtr(0U),
+m_levels(4U),
 m_control(CONTROL_NONE),
 m_syncCount(0U),
 m_colorCode(0U),
 m_state(DMORXS_NONE),
 m_n(0U),
 m_type(0U)
+#if defined(RX_24KHZ)
+,m_fraction(0.0F)
+#endif
 {
 }
 
@@ -68,6 +70,9 @@ void CDMRDMORX::reset()
   m_state     = DMORXS_NONE;
   m_startPtr  = 0U;
   m_endPtr    = NOENDPTR;
+#if defined(RX_24KHZ)
+  m_fraction  = 0.0F;
+#endif
 }
 
 void CDMRDMORX::samples(const float* samples, uint8_t length)
@@ -77,12 +82,12 @@ void CDMRDMORX::samples(const float* samples, uint8_t length)
   for (uint8_t i = 0U; i < length; i++)
     dcd = processSample(samples[i]);
 
-  io.setDecode(dcd);
+  m_modem.io.setDecode(dcd);
 }
 
 bool CDMRDMORX::processSample(float sample)
 {
-  m_buffer[m_dataPtr] = sample;
+  m_buffer[m_dataPtr] = toBuffer(sample);
 
   m_bitBuffer[m_bitPtr] <<= 1;
   if (sample < 0.0F)
@@ -109,14 +114,19 @@ bool CDMRDMORX::processSample(float sample)
   }
 
   if (m_dataPtr == m_endPtr) {
+#if defined(RX_24KHZ)
+    if (m_control != CONTROL_NONE)
+      findFraction();
+#endif
+
     // Find the average centre and threshold values
-    float centre    = (m_centre[0U]    + m_centre[1U]    + m_centre[2U]    + m_centre[3U])    / 4.0F;
-    float threshold = (m_threshold[0U] + m_threshold[1U] + m_threshold[2U] + m_threshold[3U]) / 4.0F;
+    float centre, threshold;
+    m_levels.getLevels(centre, threshold);
 
     uint8_t frame[DMR_FRAME_LENGTH_BYTES + 3U];
     frame[0U] = m_control;
 
-    uint16_t ptr = m_endPtr + DMO_BUFFER_LENGTH_SAMPLES - DMR_FRAME_LENGTH_SAMPLES + DMR_RADIO_SYMBOL_LENGTH + 1U;
+    uint16_t ptr = m_endPtr + DMO_BUFFER_LENGTH_SAMPLES - DMR_FRAME_LENGTH_SAMPLES + DMR_RX_SYMBOL_LENGTH - RX_SLICE_DELAY;
     if (ptr >= DMO_BUFFER_LENGTH_SAMPLES)
       ptr -= DMO_BUFFER_LENGTH_SAMPLES;
 
@@ -188,7 +198,7 @@ bool CDMRDMORX::processSample(float sample)
       if (m_state != DMORXS_NONE) {
         m_syncCount++;
         if (m_syncCount >= MAX_SYNC_LOST_FRAMES) {
-          serial.writeDMRLost(true);
+          m_modem.serial.writeDMRLost(true);
           reset();
         }
       }
@@ -201,7 +211,7 @@ bool CDMRDMORX::processSample(float sample)
           frame[0U] = ++m_n;
         }
 
-        serial.writeDMRData(true, frame, DMR_FRAME_LENGTH_BYTES + 1U);
+        m_modem.serial.writeDMRData(true, frame, DMR_FRAME_LENGTH_BYTES + 1U);
       } else if (m_state == DMORXS_DATA) {
         if (m_type != 0x00U) {
           frame[0U] = CONTROL_DATA | m_type;
@@ -220,7 +230,7 @@ bool CDMRDMORX::processSample(float sample)
     m_dataPtr = 0U;
 
   m_bitPtr++;
-  if (m_bitPtr >= DMR_RADIO_SYMBOL_LENGTH)
+  if (m_bitPtr >= DMR_RX_SYMBOL_LENGTH)
     m_bitPtr = 0U;
 
   return m_state != DMORXS_NONE;
@@ -235,7 +245,7 @@ void CDMRDMORX::correlateSync(bool first)
   bool voice = (errs >= (DMR_SYNC_LENGTH_SYMBOLS - MAX_SYNC_SYMBOLS_ERRS));
 
   if (data || voice) {
-    uint16_t ptr = m_dataPtr + DMO_BUFFER_LENGTH_SAMPLES - DMR_SYNC_LENGTH_SAMPLES + DMR_RADIO_SYMBOL_LENGTH;
+    uint16_t ptr = m_dataPtr + DMO_BUFFER_LENGTH_SAMPLES - DMR_SYNC_LENGTH_SAMPLES + DMR_RX_SYMBOL_LENGTH;
     if (ptr >= DMO_BUFFER_LENGTH_SAMPLES)
       ptr -= DMO_BUFFER_LENGTH_SAMPLES;
 
@@ -244,7 +254,7 @@ void CDMRDMORX::correlateSync(bool first)
     float max = -1.0F;
 
     for (uint8_t i = 0U; i < DMR_SYNC_LENGTH_SYMBOLS; i++) {
-      float val = m_buffer[ptr];
+      float val = fromBuffer(m_buffer[ptr]);
 
       if (val > max)
         max = val;
@@ -272,7 +282,7 @@ void CDMRDMORX::correlateSync(bool first)
         break;
       }
 
-      ptr += DMR_RADIO_SYMBOL_LENGTH;
+      ptr += DMR_RX_SYMBOL_LENGTH;
       if (ptr >= DMO_BUFFER_LENGTH_SAMPLES)
         ptr -= DMO_BUFFER_LENGTH_SAMPLES;
     }
@@ -283,7 +293,7 @@ void CDMRDMORX::correlateSync(bool first)
       float threshold = (max - centre) * SCALING_FACTOR;
 
       uint8_t sync[DMR_SYNC_BYTES_LENGTH];
-      uint16_t ptr = m_dataPtr + DMO_BUFFER_LENGTH_SAMPLES - DMR_SYNC_LENGTH_SAMPLES + DMR_RADIO_SYMBOL_LENGTH;
+      uint16_t ptr = m_dataPtr + DMO_BUFFER_LENGTH_SAMPLES - DMR_SYNC_LENGTH_SAMPLES + DMR_RX_SYMBOL_LENGTH;
       if (ptr >= DMO_BUFFER_LENGTH_SAMPLES)
         ptr -= DMO_BUFFER_LENGTH_SAMPLES;
 
@@ -295,18 +305,12 @@ void CDMRDMORX::correlateSync(bool first)
           errs += countBits8((sync[i] & DMR_SYNC_BYTES_MASK[i]) ^ DMR_MS_DATA_SYNC_BYTES[i]);
  
         if (errs <= MAX_SYNC_BYTES_ERRS) {
-          if (first) {
-            m_threshold[0U] = m_threshold[1U] = m_threshold[2U] = m_threshold[3U] = threshold;
-            m_centre[0U]    = m_centre[1U]    = m_centre[2U]    = m_centre[3U]    = centre;
-            m_averagePtr    = 0U;
-          } else {
-            m_threshold[m_averagePtr] = threshold;
-            m_centre[m_averagePtr]    = centre;
-
-            m_averagePtr++;
-            if (m_averagePtr >= 4U)
-              m_averagePtr = 0U;
-          }
+#if !defined(RX_24KHZ)
+          if (first)
+            m_levels.reset();
+
+          m_levels.add(centre, threshold);
+#endif
 
           m_maxCorr  = corr;
           m_control  = CONTROL_DATA;
@@ -316,7 +320,7 @@ void CDMRDMORX::correlateSync(bool first)
           if (m_startPtr >= DMO_BUFFER_LENGTH_SAMPLES)
             m_startPtr -= DMO_BUFFER_LENGTH_SAMPLES;
 
-          m_endPtr = m_dataPtr + DMR_SLOT_TYPE_LENGTH_SAMPLES / 2U + DMR_INFO_LENGTH_SAMPLES / 2U - 1U;
+          m_endPtr = m_dataPtr + DMR_SLOT_TYPE_LENGTH_SAMPLES / 2U + DMR_INFO_LENGTH_SAMPLES / 2U + RX_SLICE_DELAY;
           if (m_endPtr >= DMO_BUFFER_LENGTH_SAMPLES)
             m_endPtr -= DMO_BUFFER_LENGTH_SAMPLES;
         }
@@ -326,18 +330,12 @@ void CDMRDMORX::correlateSync(bool first)
           errs += countBits8((sync[i] & DMR_SYNC_BYTES_MASK[i]) ^ DMR_MS_VOICE_SYNC_BYTES[i]);
 
         if (errs <= MAX_SYNC_BYTES_ERRS) {
-          if (first) {
-            m_threshold[0U] = m_threshold[1U] = m_threshold[2U] = m_threshold[3U] = threshold;
-            m_centre[0U]    = m_centre[1U]    = m_centre[2U]    = m_centre[3U]    = centre;
-            m_averagePtr    = 0U;
-          } else {
-            m_threshold[m_averagePtr] = threshold;
-            m_centre[m_averagePtr]    = centre;
-
-            m_averagePtr++;
-            if (m_averagePtr >= 4U)
-              m_averagePtr = 0U;
-          }
+#if !defined(RX_24KHZ)
+          if (first)
+            m_levels.reset();
+
+          m_levels.add(centre, threshold);
+#endif
 
           m_maxCorr  = corr;
           m_control  = CONTROL_VOICE;
@@ -347,7 +345,7 @@ void CDMRDMORX::correlateSync(bool first)
           if (m_startPtr >= DMO_BUFFER_LENGTH_SAMPLES)
             m_startPtr -= DMO_BUFFER_LENGTH_SAMPLES;
 
-          m_endPtr   = m_dataPtr + DMR_SLOT_TYPE_LENGTH_SAMPLES / 2U + DMR_INFO_LENGTH_SAMPLES / 2U - 1U;
+          m_endPtr   = m_dataPtr + DMR_SLOT_TYPE_LENGTH_SAMPLES / 2U + DMR_INFO_LENGTH_SAMPLES / 2U + RX_SLICE_DELAY;
           if (m_endPtr >= DMO_BUFFER_LENGTH_SAMPLES)
             m_endPtr -= DMO_BUFFER_LENGTH_SAMPLES;
         }
@@ -359,7 +357,11 @@ void CDMRDMORX::correlateSync(bool first)
 void CDMRDMORX::samplesToBits(uint16_t start, uint8_t count, uint8_t* buffer, uint16_t offset, float centre, float threshold)
 {
   for (uint8_t i = 0U; i < count; i++) {
-    float sample = m_buffer[start] - centre;
+#if defined(RX_24KHZ)
+    float sample = fromBuffer(m_buffer, DMO_BUFFER_LENGTH_SAMPLES, start, m_fraction) - centre;
+#else
+    float sample = fromBuffer(m_buffer[start]) - centre;
+#endif
 
     if (sample < -threshold) {
       WRITE_BIT1(buffer, offset, false);
@@ -383,12 +385,76 @@ void CDMRDMORX::samplesToBits(uint16_t start, uint8_t count, uint8_t* buffer, ui
       offset++;
     }
 
-    start += DMR_RADIO_SYMBOL_LENGTH;
+    start += DMR_RX_SYMBOL_LENGTH;
     if (start >= DMO_BUFFER_LENGTH_SAMPLES)
       start -= DMO_BUFFER_LENGTH_SAMPLES;
   }
 }
 
+#if defined(RX_24KHZ)
+float CDMRDMORX::correlate(uint16_t ptr, const int8_t* values) const
+{
+  // The sync ends at ptr
+  ptr += DMO_BUFFER_LENGTH_SAMPLES - DMR_SYNC_LENGTH_SAMPLES + DMR_RX_SYMBOL_LENGTH;
+  if (ptr >= DMO_BUFFER_LENGTH_SAMPLES)
+    ptr -= DMO_BUFFER_LENGTH_SAMPLES;
+
+  float corr = 0.0F;
+
+  for (uint8_t i = 0U; i < DMR_SYNC_LENGTH_SYMBOLS; i++) {
+    corr -= float(values[i]) * fromBuffer(m_buffer[ptr]);
+
+    ptr += DMR_RX_SYMBOL_LENGTH;
+    if (ptr >= DMO_BUFFER_LENGTH_SAMPLES)
+      ptr -= DMO_BUFFER_LENGTH_SAMPLES;
+  }
+
+  return corr;
+}
+
+void CDMRDMORX::findFraction()
+{
+  // At five samples per symbol the nearest sample can be a tenth of a symbol from the centre
+  const int8_t* values = (m_control == CONTROL_DATA) ? DMR_MS_DATA_SYNC_SYMBOLS_VALUES : DMR_MS_VOICE_SYNC_SYMBOLS_VALUES;
+
+  uint16_t early = (m_syncPtr == 0U) ? (DMO_BUFFER_LENGTH_SAMPLES - 1U) : (m_syncPtr - 1U);
+
+  uint16_t late = m_syncPtr + 1U;
+  if (late >= DMO_BUFFER_LENGTH_SAMPLES)
+    late = 0U;
+
+  m_fraction = getPeakFraction(correlate(early, values), correlate(m_syncPtr, values), correlate(late, values));
+
+  // The levels are taken there too, the samples either side of the peak spread further
+  uint16_t ptr = m_syncPtr + DMO_BUFFER_LENGTH_SAMPLES - DMR_SYNC_LENGTH_SAMPLES + DMR_RX_SYMBOL_LENGTH;
+  if (ptr >= DMO_BUFFER_LENGTH_SAMPLES)
+    ptr -= DMO_BUFFER_LENGTH_SAMPLES;
+
+  float min =  1.0F;
+  float max = -1.0F;
+
+  for (uint8_t i = 0U; i < DMR_SYNC_LENGTH_SYMBOLS; i++) {
+    float val = fromBuffer(m_buffer, DMO_BUFFER_LENGTH_SAMPLES, ptr, m_fraction);
+
+    if (val > max)
+      max = val;
+    if (val < min)
+      min = val;
+
+    ptr += DMR_RX_SYMBOL_LENGTH;
+    if (ptr >= DMO_BUFFER_LENGTH_SAMPLES)
+      ptr -= DMO_BUFFER_LENGTH_SAMPLES;
+  }
+
+  float centre = (max + min) / 2.0F;
+
+  if (m_state == DMORXS_NONE)
+    m_levels.reset();
+
+  m_levels.add(centre, (max - centre) * SCALING_FACTOR);
+}
+#endif
+
 void CDMRDMORX::setColorCode(uint8_t colorCode)
 {
   m_colorCode = colorCode;
@@ -396,5 +462,5 @@ void CDMRDMORX::setColorCode(uint8_t colorCode)
 
 void CDMRDMORX::writeData(uint8_t* frame)
 {
-  serial.writeDMRData(true, frame, DMR_FRAME_LENGTH_BYTES + 1U);
+  m_modem.serial.writeDMRData(true, frame, DMR_FRAME_LENGTH_BYTES + 1U);
 }
@@ -20,8 +20,10 @@
 #define  DMRDMORX_H
 
 #include "DMRDefines.h"
+#include "SampleBuffer.h"
+#include "LevelTracker.h"
 
-const uint16_t DMO_BUFFER_LENGTH_SAMPLES = 1440U;   // 60ms at 24 kHz
+const uint16_t DMO_BUFFER_LENGTH_SAMPLES = DMR_FRAME_LENGTH_SAMPLES + DMR_CACH_LENGTH_SAMPLES;   // 30ms
 
 enum DMORX_STATE {
   DMORXS_NONE,
@@ -29,9 +31,11 @@ enum DMORX_STATE {
   DMORXS_DATA
 };
 
+class CModem;
+
 class CDMRDMORX {
 public:
-  CDMRDMORX();
+  CDMRDMORX(CModem& modem);
 
   void samples(const float* samples, uint8_t length);
 
@@ -40,26 +44,33 @@ public:
   void reset();
 
 private:
-  uint32_t    m_bitBuffer[DMR_RADIO_SYMBOL_LENGTH];
-  float       m_buffer[DMO_BUFFER_LENGTH_SAMPLES];
+  CModem&     m_modem;
+  uint32_t    m_bitBuffer[DMR_RX_SYMBOL_LENGTH];
+  buffer_t    m_buffer[DMO_BUFFER_LENGTH_SAMPLES];
   uint16_t    m_bitPtr;
   uint16_t    m_dataPtr;
   uint16_t    m_syncPtr;
   uint16_t    m_startPtr;
   uint16_t    m_endPtr;
   float       m_maxCorr;
-  float       m_centre[4U];
-  float       m_threshold[4U];
-  uint8_t     m_averagePtr;
+  CLevelTracker m_levels;
   uint8_t     m_control;
   uint8_t     m_syncCount;
   uint8_t     m_colorCode;
   DMORX_STATE m_state;
   uint8_t     m_n;
   uint8_t     m_type;
+#if defined(RX_24KHZ)
+  // How far between samples the last sync peaked, the symbols and levels are read there
+  float       m_fraction;
+#endif
   
   bool processSample(float sample);
   void correlateSync(bool first);
+#if defined(RX_24KHZ)
+  float correlate(uint16_t ptr, const int8_t* values) const;
+  void  findFraction();
+#endif
   void samplesToBits(uint16_t start, uint8_t count, uint8_t* buffer, uint16_t offset, float centre, float threshold);
   void writeData(uint8_t* frame);
 };
@@ -22,19 +22,18 @@
 #include "DMRSlotType.h"
 
 // Generated using rcosdesign(0.2, 8, 10, 'sqrt') in MATLAB
-static float RRC_0_2_FILTER[] = {0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,
-								 0.0000000F,  0.0259407F,  0.0180670F,  0.0066836F, -0.0071413F, -0.0219733F, -0.0359813F, -0.0472427F,
-								-0.0539872F, -0.0547807F, -0.0487381F, -0.0357677F, -0.0166021F,  0.0072329F,  0.0333262F,  0.0588092F,
-								 0.0804773F,  0.0952177F,  0.1002838F,  0.0937834F,  0.0748924F,  0.0441603F,  0.0035401F, -0.0436720F,
-								-0.0928678F, -0.1386761F, -0.1751457F, -0.1966002F, -0.1978515F, -0.1750236F, -0.1257668F, -0.0498367F,
-								 0.0509354F,  0.1724601F,  0.3087863F,  0.4523453F,  0.5946226F,  0.7266457F,  0.8398694F,  0.9267555F,
-								 0.9813532F,  1.0000000F,  0.9813532F,  0.9267555F,  0.8398694F,  0.7266457F,  0.5946226F,  0.4523453F,
-								 0.3087863F,  0.1724601F,  0.0509354F, -0.0498367F, -0.1257668F, -0.1750236F, -0.1978515F, -0.1966002F,
-							    -0.1751457F, -0.1386761F, -0.0928678F, -0.0436720F,  0.0035401F,  0.0441603F,  0.0748924F,  0.0937834F,
-								 0.1002838F,  0.0952177F,  0.0804773F,  0.0588092F,  0.0333262F,  0.0072329F, -0.0166021F, -0.0357677F,
-								-0.0487381F, -0.0547807F, -0.0539872F, -0.0472427F, -0.0359813F, -0.0219733F, -0.0071413F,  0.0066836F,
-								 0.0180670F,  0.0259407F}; // numTaps = 90, L = 10
-const uint16_t RRC_0_2_FILTER_PHASE_LEN = 9U; // phaseLength = numTaps/L
+const float CDMRDMOTX::RRC_0_2_FILTER[] = {0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,
+								           0.0000000F,  0.0259407F,  0.0180670F,  0.0066836F, -0.0071413F, -0.0219733F, -0.0359813F, -0.0472427F,
+								          -0.0539872F, -0.0547807F, -0.0487381F, -0.0357677F, -0.0166021F,  0.0072329F,  0.0333262F,  0.0588092F,
+								           0.0804773F,  0.0952177F,  0.1002838F,  0.0937834F,  0.0748924F,  0.0441603F,  0.0035401F, -0.0436720F,
+								          -0.0928678F, -0.1386761F, -0.1751457F, -0.1966002F, -0.1978515F, -0.1750236F, -0.1257668F, -0.0498367F,
+								           0.0509354F,  0.1724601F,  0.3087863F,  0.4523453F,  0.5946226F,  0.7266457F,  0.8398694F,  0.9267555F,
+								           0.9813532F,  1.0000000F,  0.9813532F,  0.9267555F,  0.8398694F,  0.7266457F,  0.5946226F,  0.4523453F,
+								           0.3087863F,  0.1724601F,  0.0509354F, -0.0498367F, -0.1257668F, -0.1750236F, -0.1978515F, -0.1966002F,
+							              -0.1751457F, -0.1386761F, -0.0928678F, -0.0436720F,  0.0035401F,  0.0441603F,  0.0748924F,  0.0937834F,
+								           0.1002838F,  0.0952177F,  0.0804773F,  0.0588092F,  0.0333262F,  0.0072329F, -0.0166021F, -0.0357677F,
+								          -0.0487381F, -0.0547807F, -0.0539872F, -0.0472427F, -0.0359813F, -0.0219733F, -0.0071413F,  0.0066836F,
+								           0.0180670F,  0.0259407F}; // numTaps = 90, L = 10
 
 const float DMR_LEVELA =  0.545;
 const float DMR_LEVELB =  0.182;
@@ -55,9 +54,10 @@ const uint8_t PR_FILL[] =
 
 const uint8_t DMR_SYNC = 0x5FU;
 
-CDMRDMOTX::CDMRDMOTX() :
+CDMRDMOTX::CDMRDMOTX(CModem& modem) :
+m_modem(modem),
 m_fifo(),
-m_modFilter(DMR_RADIO_SYMBOL_LENGTH, RRC_0_2_FILTER_PHASE_LEN, RRC_0_2_FILTER, 4U),
+m_modFilter(),
 m_poBuffer(),
 m_poLen(0U),
 m_poPtr(0U),
@@ -72,7 +72,7 @@ void CDMRDMOTX::process()
     if (m_cal) {
       createCal();
     } else if (m_fifo.getData() > 0U) {
-      if (!m_tx) {
+      if (!m_modem.tx) {
         for (uint16_t i = 0U; i < m_txDelay; i++)
           m_poBuffer[i] = DMR_SYNC;
 
@@ -92,7 +92,7 @@ void CDMRDMOTX::process()
   }
 
   if (m_poLen > 0U) {
-    uint16_t space = io.getSpace();
+    uint16_t space = m_modem.io.getSpace();
     
     while (space > (4U * DMR_RADIO_SYMBOL_LENGTH)) {
       uint8_t c = m_poBuffer[m_poPtr++];
@@ -151,7 +151,7 @@ void CDMRDMOTX::writeByte(uint8_t c)
 
   m_modFilter.process(inBuffer, outBuffer, 4U);
 
-  io.write(STATE_DMR, outBuffer, DMR_RADIO_SYMBOL_LENGTH * 4U);
+  m_modem.io.write(STATE_DMR, outBuffer, DMR_RADIO_SYMBOL_LENGTH * 4U);
 }
 
 uint8_t CDMRDMOTX::getSpace() const
@@ -175,7 +175,7 @@ void CDMRDMOTX::setTXDelay(uint8_t delay)
 void CDMRDMOTX::createCal()
 {
   // 1.2 kHz sine wave generation
-  if (m_modemState == STATE_DMRCAL) {
+  if (m_modem.modemState == STATE_DMRCAL) {
     for (unsigned int i = 0U; i < DMR_FRAME_LENGTH_BYTES; i++) {
       m_poBuffer[i]   = 0x5FU;              // +3, +3, -3, -3 pattern for deviation cal.
     }
@@ -184,7 +184,7 @@ void CDMRDMOTX::createCal()
   }
 
   // 80 Hz square wave generation
-  if (m_modemState == STATE_LFCAL) {
+  if (m_modem.modemState == STATE_LFCAL) {
     for (unsigned int i = 0U; i < 7U; i++) {
       m_poBuffer[i]   = 0x55U;              // +3, +3, ... pattern
     }
@@ -19,28 +19,31 @@
 #if !defined(DSTARDEFINES_H)
 #define  DSTARDEFINES_H
 
+#include "RXRate.h"
+
 const unsigned int DSTAR_RADIO_SYMBOL_LENGTH = 10U;      // At 48 kHz sample rate
+const unsigned int DSTAR_RX_SYMBOL_LENGTH    = DSTAR_RADIO_SYMBOL_LENGTH / RX_DECIMATION;
 
 const unsigned int DSTAR_HEADER_LENGTH_BYTES   = 41U;
 
 const unsigned int DSTAR_FEC_SECTION_LENGTH_BYTES   = 83U;
 const unsigned int DSTAR_FEC_SECTION_LENGTH_SYMBOLS = 660U;
-const unsigned int DSTAR_FEC_SECTION_LENGTH_SAMPLES = DSTAR_FEC_SECTION_LENGTH_SYMBOLS * DSTAR_RADIO_SYMBOL_LENGTH;
+const unsigned int DSTAR_FEC_SECTION_LENGTH_SAMPLES = DSTAR_FEC_SECTION_LENGTH_SYMBOLS * DSTAR_RX_SYMBOL_LENGTH;
 
 const unsigned int DSTAR_DATA_LENGTH_BYTES   = 12U;
 const unsigned int DSTAR_DATA_LENGTH_SYMBOLS = DSTAR_DATA_LENGTH_BYTES * 8U;
-const unsigned int DSTAR_DATA_LENGTH_SAMPLES = DSTAR_DATA_LENGTH_SYMBOLS * DSTAR_RADIO_SYMBOL_LENGTH;
+const unsigned int DSTAR_DATA_LENGTH_SAMPLES = DSTAR_DATA_LENGTH_SYMBOLS * DSTAR_RX_SYMBOL_LENGTH;
 
 const unsigned int DSTAR_END_SYNC_LENGTH_BYTES = 6U;
 const unsigned int DSTAR_END_SYNC_LENGTH_BITS  = DSTAR_END_SYNC_LENGTH_BYTES * 8U;
 
 const unsigned int DSTAR_FRAME_SYNC_LENGTH_BYTES   = 3U;
 const unsigned int DSTAR_FRAME_SYNC_LENGTH_SYMBOLS = DSTAR_FRAME_SYNC_LENGTH_BYTES * 8U;
-const unsigned int DSTAR_FRAME_SYNC_LENGTH_SAMPLES = DSTAR_FRAME_SYNC_LENGTH_SYMBOLS * DSTAR_RADIO_SYMBOL_LENGTH;
+const unsigned int DSTAR_FRAME_SYNC_LENGTH_SAMPLES = DSTAR_FRAME_SYNC_LENGTH_SYMBOLS * DSTAR_RX_SYMBOL_LENGTH;
 
 const unsigned int DSTAR_DATA_SYNC_LENGTH_BYTES   = 3U;
 const unsigned int DSTAR_DATA_SYNC_LENGTH_SYMBOLS = DSTAR_DATA_SYNC_LENGTH_BYTES * 8U;
-const unsigned int DSTAR_DATA_SYNC_LENGTH_SAMPLES = DSTAR_DATA_SYNC_LENGTH_SYMBOLS * DSTAR_RADIO_SYMBOL_LENGTH;
+const unsigned int DSTAR_DATA_SYNC_LENGTH_SAMPLES = DSTAR_DATA_SYNC_LENGTH_SYMBOLS * DSTAR_RX_SYMBOL_LENGTH;
 
 const uint8_t DSTAR_DATA_SYNC_BYTES[] = {0x9E, 0x8D, 0x32, 0x88, 0x26, 0x1A, 0x3F, 0x61, 0xE8, 0x55, 0x2D, 0x16};
 
@@ -232,7 +232,8 @@ const uint16_t CCITT_TABLE[] = {
 
 const uint16_t NOENDPTR = 9999U;
 
-CDStarRX::CDStarRX() :
+CDStarRX::CDStarRX(CModem& modem) :
+m_modem(modem),
 m_rxState(DSRXS_NONE),
 m_bitBuffer(),
 m_headerBuffer(),
@@ -283,7 +284,7 @@ void CDStarRX::samples(const float* samples, uint8_t length)
     if (sample < 0.0F)
       m_bitBuffer[m_bitPtr] |= 0x01U;
 
-    m_dataBuffer[m_dataPtr] = sample;
+    m_dataBuffer[m_dataPtr] = toBuffer(sample);
 
     switch (m_rxState) {
       case DSRXS_HEADER:
@@ -302,7 +303,7 @@ void CDStarRX::samples(const float* samples, uint8_t length)
       m_dataPtr = 0U;
 
     m_bitPtr++;
-    if (m_bitPtr >= DSTAR_RADIO_SYMBOL_LENGTH)
+    if (m_bitPtr >= DSTAR_RX_SYMBOL_LENGTH)
       m_bitPtr = 0U;
   }
 }
@@ -314,7 +315,7 @@ void CDStarRX::processNone(float sample)
   if (ret) {
     m_countdown = 5U;
 	
-    m_headerBuffer[m_headerPtr] = sample;
+    m_headerBuffer[m_headerPtr] = toBuffer(sample);
     m_headerPtr++;
 
     m_rxState = DSRXS_HEADER;
@@ -327,8 +328,8 @@ void CDStarRX::processNone(float sample)
   if (ret) {
     DEBUG1("DStarRX: found data sync in None");
 
-    io.setDecode(true);
-    io.setADCDetection(true);
+    m_modem.io.setDecode(true);
+    m_modem.io.setADCDetection(true);
 
     m_rxState = DSRXS_DATA;
   }
@@ -341,13 +342,13 @@ void CDStarRX::processHeader(float sample)
     m_countdown--;
   }
 
-  m_headerBuffer[m_headerPtr] = sample;
+  m_headerBuffer[m_headerPtr] = toBuffer(sample);
   m_headerPtr++;
 
   // A full FEC header
-  if (m_headerPtr == (DSTAR_FEC_SECTION_LENGTH_SAMPLES + DSTAR_RADIO_SYMBOL_LENGTH)) {
+  if (m_headerPtr == (DSTAR_FEC_SECTION_LENGTH_SAMPLES + DSTAR_RX_SYMBOL_LENGTH)) {
     uint8_t buffer[DSTAR_FEC_SECTION_LENGTH_BYTES];
-    samplesToBits(m_headerBuffer, DSTAR_RADIO_SYMBOL_LENGTH, DSTAR_FEC_SECTION_LENGTH_SYMBOLS, buffer, DSTAR_FEC_SECTION_LENGTH_SAMPLES);
+    samplesToBits(m_headerBuffer, DSTAR_RX_SYMBOL_LENGTH, DSTAR_FEC_SECTION_LENGTH_SYMBOLS, buffer, DSTAR_FEC_SECTION_LENGTH_SAMPLES);
 
     // Process the scrambling, interleaving and FEC, then return true if the chcksum was correct
     uint8_t header[DSTAR_HEADER_LENGTH_BYTES];
@@ -358,22 +359,34 @@ void CDStarRX::processHeader(float sample)
       m_maxFrameCorr = 0.0F;
       m_maxDataCorr  = 0.0F;
     } else {
-      io.setDecode(true);
-      io.setADCDetection(true);
+      m_modem.io.setDecode(true);
+      m_modem.io.setADCDetection(true);
 
       writeHeader(header);
     }
   }
 
   // Ready to start the first data section
-  if (m_headerPtr == (DSTAR_FEC_SECTION_LENGTH_SAMPLES + 2U * DSTAR_RADIO_SYMBOL_LENGTH)) {
+  if (m_headerPtr == (DSTAR_FEC_SECTION_LENGTH_SAMPLES + 2U * DSTAR_RX_SYMBOL_LENGTH)) {
     m_frameCount = 0U;
-    m_dataPtr    = 0U;
 
-    m_startPtr   = 476U;
-    m_syncPtr    = 471U;
-    m_maxSyncPtr = 472U;
-    m_minSyncPtr = 470U;
+    // The first data frame began a symbol before the end of the header, so it is
+    // sliced once its last symbol is in, as if its data sync had been found there
+    m_syncPtr    = m_dataPtr + DSTAR_DATA_LENGTH_SAMPLES - 2U * DSTAR_RX_SYMBOL_LENGTH - 1U;
+    if (m_syncPtr >= DSTAR_DATA_LENGTH_SAMPLES)
+      m_syncPtr -= DSTAR_DATA_LENGTH_SAMPLES;
+
+    m_startPtr   = m_syncPtr + DSTAR_RX_SYMBOL_LENGTH;
+    if (m_startPtr >= DSTAR_DATA_LENGTH_SAMPLES)
+      m_startPtr -= DSTAR_DATA_LENGTH_SAMPLES;
+
+    m_maxSyncPtr = m_syncPtr + 1U;
+    if (m_maxSyncPtr >= DSTAR_DATA_LENGTH_SAMPLES)
+      m_maxSyncPtr -= DSTAR_DATA_LENGTH_SAMPLES;
+
+    m_minSyncPtr = m_syncPtr + DSTAR_DATA_LENGTH_SAMPLES - 1U;
+    if (m_minSyncPtr >= DSTAR_DATA_LENGTH_SAMPLES)
+      m_minSyncPtr -= DSTAR_DATA_LENGTH_SAMPLES;
 
     DEBUG5("DStarRX: calc start/sync/max/min", m_startPtr, m_syncPtr, m_maxSyncPtr, m_minSyncPtr);
 
@@ -387,10 +400,10 @@ void CDStarRX::processData()
   if (countBits32((m_bitBuffer[m_bitPtr] & DSTAR_END_SYNC_MASK) ^ DSTAR_END_SYNC_DATA) <= END_SYNC_ERRS) {
     DEBUG1("DStarRX: Found end sync in Data");
 
-    io.setDecode(false);
-    io.setADCDetection(false);
+    m_modem.io.setDecode(false);
+    m_modem.io.setADCDetection(false);
 
-    serial.writeDStarEOT();
+    m_modem.serial.writeDStarEOT();
 
     m_maxFrameCorr = 0.0F;
     m_maxDataCorr  = 0.0F;
@@ -412,10 +425,10 @@ void CDStarRX::processData()
   if (m_frameCount >= MAX_FRAMES) {
     DEBUG1("DStarRX: data sync timed out, lost lock");
 
-    io.setDecode(false);
-    io.setADCDetection(false);
+    m_modem.io.setDecode(false);
+    m_modem.io.setADCDetection(false);
 
-    serial.writeDStarLost();
+    m_modem.serial.writeDStarLost();
 
     m_maxFrameCorr = 0.0F;
     m_maxDataCorr  = 0.0F;
@@ -439,7 +452,7 @@ void CDStarRX::processData()
 
       writeData(buffer);
     } else {
-      serial.writeDStarData(buffer, DSTAR_DATA_LENGTH_BYTES);
+      m_modem.serial.writeDStarData(buffer, DSTAR_DATA_LENGTH_BYTES);
     }
 
     m_frameCount++;
@@ -451,32 +464,32 @@ void CDStarRX::processData()
 
 void CDStarRX::writeHeader(unsigned char* header)
 {
-  serial.writeDStarHeader(header, DSTAR_HEADER_LENGTH_BYTES + 0U);
+  m_modem.serial.writeDStarHeader(header, DSTAR_HEADER_LENGTH_BYTES + 0U);
 }
 
 void CDStarRX::writeData(unsigned char* data)
 {
-  serial.writeDStarData(data, DSTAR_DATA_LENGTH_BYTES + 0U);
+  m_modem.serial.writeDStarData(data, DSTAR_DATA_LENGTH_BYTES + 0U);
 }
 
 bool CDStarRX::correlateFrameSync()
 {
   if (countBits32((m_bitBuffer[m_bitPtr] & DSTAR_FRAME_SYNC_MASK) ^ DSTAR_FRAME_SYNC_DATA) <= FRAME_SYNC_ERRS) {
-    uint16_t ptr = m_dataPtr + DSTAR_DATA_LENGTH_SAMPLES - DSTAR_FRAME_SYNC_LENGTH_SAMPLES + DSTAR_RADIO_SYMBOL_LENGTH;
+    uint16_t ptr = m_dataPtr + DSTAR_DATA_LENGTH_SAMPLES - DSTAR_FRAME_SYNC_LENGTH_SAMPLES + DSTAR_RX_SYMBOL_LENGTH;
     if (ptr >= DSTAR_DATA_LENGTH_SAMPLES)
       ptr -= DSTAR_DATA_LENGTH_SAMPLES;
 
     float corr = 0.0F;
 
     for (uint8_t i = 0U; i < DSTAR_FRAME_SYNC_LENGTH_SYMBOLS; i++) {
-      float val = m_dataBuffer[ptr];
+      float val = fromBuffer(m_dataBuffer[ptr]);
 
       if (DSTAR_FRAME_SYNC_SYMBOLS[i])
         corr -= val;
       else
         corr += val;
 
-      ptr += DSTAR_RADIO_SYMBOL_LENGTH;
+      ptr += DSTAR_RX_SYMBOL_LENGTH;
       if (ptr >= DSTAR_DATA_LENGTH_SAMPLES)
         ptr -= DSTAR_DATA_LENGTH_SAMPLES;
     }
@@ -498,21 +511,21 @@ bool CDStarRX::correlateDataSync()
     maxErrs = DATA_SYNC_ERRS;
 
   if (countBits32((m_bitBuffer[m_bitPtr] & DSTAR_DATA_SYNC_MASK) ^ DSTAR_DATA_SYNC_DATA) <= maxErrs) {
-    uint16_t ptr = m_dataPtr + DSTAR_DATA_LENGTH_SAMPLES - DSTAR_DATA_SYNC_LENGTH_SAMPLES + DSTAR_RADIO_SYMBOL_LENGTH;
+    uint16_t ptr = m_dataPtr + DSTAR_DATA_LENGTH_SAMPLES - DSTAR_DATA_SYNC_LENGTH_SAMPLES + DSTAR_RX_SYMBOL_LENGTH;
     if (ptr >= DSTAR_DATA_LENGTH_SAMPLES)
       ptr -= DSTAR_DATA_LENGTH_SAMPLES;
 
     float corr = 0.0F;
 
     for (uint8_t i = 0U; i < DSTAR_DATA_SYNC_LENGTH_SYMBOLS; i++) {
-      float val = m_dataBuffer[ptr];
+      float val = fromBuffer(m_dataBuffer[ptr]);
 
       if (DSTAR_DATA_SYNC_SYMBOLS[i])
         corr -= val;
       else
         corr += val;
 
-      ptr += DSTAR_RADIO_SYMBOL_LENGTH;
+      ptr += DSTAR_RX_SYMBOL_LENGTH;
       if (ptr >= DSTAR_DATA_LENGTH_SAMPLES)
         ptr -= DSTAR_DATA_LENGTH_SAMPLES;
     }
@@ -523,7 +536,7 @@ bool CDStarRX::correlateDataSync()
 
       m_syncPtr    = m_dataPtr;
 
-      m_startPtr   = m_dataPtr + DSTAR_RADIO_SYMBOL_LENGTH;
+      m_startPtr   = m_dataPtr + DSTAR_RX_SYMBOL_LENGTH;
       if (m_startPtr >= DSTAR_DATA_LENGTH_SAMPLES)
         m_startPtr -= DSTAR_DATA_LENGTH_SAMPLES;
 
@@ -542,17 +555,17 @@ bool CDStarRX::correlateDataSync()
   return false;
 }
 
-void CDStarRX::samplesToBits(const float* inBuffer, uint16_t start, uint16_t count, uint8_t* outBuffer, uint16_t limit)
+void CDStarRX::samplesToBits(const buffer_t* inBuffer, uint16_t start, uint16_t count, uint8_t* outBuffer, uint16_t limit)
 {
   for (uint16_t i = 0U; i < count; i++) {
-    float sample = inBuffer[start];
+    float sample = fromBuffer(inBuffer[start]);
 
     if (sample < 0.0F)
       WRITE_BIT2(outBuffer, i, true);
     else
       WRITE_BIT2(outBuffer, i, false);
 
-    start += DSTAR_RADIO_SYMBOL_LENGTH;
+    start += DSTAR_RX_SYMBOL_LENGTH;
     if (start >= limit)
       start -= limit;
   }
@@ -20,6 +20,7 @@
 #define  DSTARRX_H
 
 #include "DStarDefines.h"
+#include "SampleBuffer.h"
 
 enum DSRX_STATE {
   DSRXS_NONE,
@@ -27,19 +28,22 @@ enum DSRX_STATE {
   DSRXS_DATA
 };
 
+class CModem;
+
 class CDStarRX {
 public:
-  CDStarRX();
+  CDStarRX(CModem& modem);
 
   void samples(const float* samples, uint8_t length);
 
   void reset();
 
 private:
+  CModem&      m_modem;
   DSRX_STATE   m_rxState;
-  uint32_t     m_bitBuffer[DSTAR_RADIO_SYMBOL_LENGTH];
-  float        m_headerBuffer[DSTAR_FEC_SECTION_LENGTH_SAMPLES + 2U * DSTAR_RADIO_SYMBOL_LENGTH];
-  float        m_dataBuffer[DSTAR_DATA_LENGTH_SAMPLES];
+  uint32_t     m_bitBuffer[DSTAR_RX_SYMBOL_LENGTH];
+  buffer_t     m_headerBuffer[DSTAR_FEC_SECTION_LENGTH_SAMPLES + 2U * DSTAR_RX_SYMBOL_LENGTH];
+  buffer_t     m_dataBuffer[DSTAR_DATA_LENGTH_SAMPLES];
   uint16_t     m_bitPtr;
   uint16_t     m_headerPtr;
   uint16_t     m_dataPtr;
@@ -64,7 +68,7 @@ private:
   void    processData();
   bool    correlateFrameSync();
   bool    correlateDataSync();
-  void    samplesToBits(const float* inBuffer, uint16_t start, uint16_t count, uint8_t* outBuffer, uint16_t limit);
+  void    samplesToBits(const buffer_t* inBuffer, uint16_t start, uint16_t count, uint8_t* outBuffer, uint16_t limit);
   void    writeHeader(unsigned char* header);
   void    writeData(unsigned char* data);
   bool    rxHeader(uint8_t* in, uint8_t* out);
@@ -27,11 +27,10 @@ const uint8_t BIT_SYNC = 0xAAU;
 const uint8_t FRAME_SYNC[] = {0xEAU, 0xA6U, 0x00U};
 
 // Generated using gaussfir(0.35, 1, 10) in MATLAB
-static float GAUSSIAN_0_35_FILTER[] = {0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F,
-									   0.0000000F, 0.0305490F, 0.0592669F, 0.1072420F, 0.1809748F, 0.2848293F, 0.4180731F, 0.5722526F,
-									   0.7305521F, 0.8697470F, 0.9657277F, 1.0000000F, 0.9657277F, 0.8697470F, 0.7305521F, 0.5722526F,
-									   0.4180731F, 0.2848293F, 0.1809748F, 0.1072420F, 0.0592669F, 0.0305490F}; // numTaps = 30, L = 10
-const uint16_t GAUSSIAN_0_35_FILTER_PHASE_LEN = 3U; // phaseLength = numTaps/L
+const float CDStarTX::GAUSSIAN_0_35_FILTER[] = {0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F,
+									            0.0000000F, 0.0305490F, 0.0592669F, 0.1072420F, 0.1809748F, 0.2848293F, 0.4180731F, 0.5722526F,
+									            0.7305521F, 0.8697470F, 0.9657277F, 1.0000000F, 0.9657277F, 0.8697470F, 0.7305521F, 0.5722526F,
+									            0.4180731F, 0.2848293F, 0.1809748F, 0.1072420F, 0.0592669F, 0.0305490F}; // numTaps = 30, L = 10
 
 const float DSTAR_LEVEL0 = -0.336;
 const float DSTAR_LEVEL1 =  0.336;
@@ -189,9 +188,10 @@ const uint8_t DSTAR_HEADER = 0x00U;
 const uint8_t DSTAR_DATA   = 0x01U;
 const uint8_t DSTAR_EOT    = 0x02U;
 
-CDStarTX::CDStarTX() :
+CDStarTX::CDStarTX(CModem& modem) :
+m_modem(modem),
 m_buffer(),
-m_filter(DSTAR_RADIO_SYMBOL_LENGTH, GAUSSIAN_0_35_FILTER_PHASE_LEN, GAUSSIAN_0_35_FILTER, 8U),
+m_filter(),
 m_poBuffer(),
 m_poLen(0U),
 m_poPtr(0U),
@@ -207,16 +207,18 @@ void CDStarTX::process()
   uint8_t type = m_buffer.peek();
 
   if (type == DSTAR_HEADER && m_poLen == 0U) {
-    if (!m_tx) {
+    if (!m_modem.tx) {
       for (uint16_t i = 0U; i < m_txDelay; i++)
         m_poBuffer[m_poLen++] = BIT_SYNC;
     } else {
       // Pop the type byte off
       m_buffer.get();
 
-      uint8_t header[DSTAR_HEADER_LENGTH_BYTES];
+      // The convolutional encoder reads one byte past the header to flush itself
+      uint8_t header[DSTAR_HEADER_LENGTH_BYTES + 1U];
       for (uint8_t i = 0U; i < DSTAR_HEADER_LENGTH_BYTES; i++)
         header[i] = m_buffer.get();
+      header[DSTAR_HEADER_LENGTH_BYTES] = 0x00U;
 
       uint8_t buffer[86U];
       txHeader(header, buffer + 2U);
@@ -255,7 +257,7 @@ void CDStarTX::process()
   }
 
   if (m_poLen > 0U) {
-    uint16_t space = io.getSpace();
+    uint16_t space = m_modem.io.getSpace();
 
     while (space > (8U * DSTAR_RADIO_SYMBOL_LENGTH)) {
       uint8_t c = m_poBuffer[m_poPtr++];
@@ -422,7 +424,7 @@ void CDStarTX::writeByte(uint8_t c)
 
   m_filter.process(inBuffer, outBuffer, 8U);
 
-  io.write(STATE_DSTAR, outBuffer, DSTAR_RADIO_SYMBOL_LENGTH * 8U);
+  m_modem.io.write(STATE_DSTAR, outBuffer, DSTAR_RADIO_SYMBOL_LENGTH * 8U);
 }
 
 void CDStarTX::setTXDelay(uint8_t delay)
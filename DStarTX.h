@@ -20,11 +20,14 @@
 #define  DSTARTX_H
 
 #include "FIRInterpolator.h"
+#include "DStarDefines.h"
 #include "SerialRB.h"
 
+class CModem;
+
 class CDStarTX {
 public:
-  CDStarTX();
+  CDStarTX(CModem& modem);
 
   uint8_t writeHeader(const uint8_t* header, uint8_t length);
   uint8_t writeData(const uint8_t* data, uint8_t length);
@@ -37,8 +40,14 @@ public:
   uint8_t getSpace() const;
 
 private:
+  // The modulation filter, defined in DStarTX.cpp
+  static const uint16_t GAUSSIAN_0_35_FILTER_PHASE_LEN = 3U; // phaseLength = numTaps/L
+
+  static const float GAUSSIAN_0_35_FILTER[];
+
+  CModem&          m_modem;
   CSerialRB        m_buffer;
-  CFIRInterpolator m_filter;
+  CStaticFIRInterpolator<DSTAR_RADIO_SYMBOL_LENGTH, GAUSSIAN_0_35_FILTER_PHASE_LEN, GAUSSIAN_0_35_FILTER, 8U> m_filter;
   uint8_t          m_poBuffer[600U];
   uint16_t         m_poLen;
   uint16_t         m_poPtr;
@@ -21,11 +21,25 @@
 
 #include "Globals.h"
 
-#define  DEBUG1(a)          serial.writeDebug((a))
-#define  DEBUG2(a,b)        serial.writeDebug((a),(b))
-#define  DEBUG3(a,b,c)      serial.writeDebug((a),(b),(c))
-#define  DEBUG4(a,b,c,d)    serial.writeDebug((a),(b),(c),(d))
-#define  DEBUG5(a,b,c,d,e)  serial.writeDebug((a),(b),(c),(d),(e))
+#if !defined(DEBUG_LEVEL)
+#define  DEBUG_LEVEL 1
+#endif
+
+// Only for use inside the classes owned by a CModem. The messages are queued and sent
+// by the CDebugWriter thread, build with -DDEBUG_LEVEL=0 to leave them out altogether.
+#if DEBUG_LEVEL > 0
+#define  DEBUG1(a)          m_modem.debug.add((a))
+#define  DEBUG2(a,b)        m_modem.debug.add((a),(b))
+#define  DEBUG3(a,b,c)      m_modem.debug.add((a),(b),(c))
+#define  DEBUG4(a,b,c,d)    m_modem.debug.add((a),(b),(c),(d))
+#define  DEBUG5(a,b,c,d,e)  m_modem.debug.add((a),(b),(c),(d),(e))
+#else
+#define  DEBUG1(a)          do { } while (0)
+#define  DEBUG2(a,b)        do { } while (0)
+#define  DEBUG3(a,b,c)      do { } while (0)
+#define  DEBUG4(a,b,c,d)    do { } while (0)
+#define  DEBUG5(a,b,c,d,e)  do { } while (0)
+#endif
 
 #endif
 
@@ -0,0 +1,183 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "DebugLog.h"
+
+#include <sys/time.h>
+
+#include <ctime>
+
+CDebugLog::CDebugLog() :
+m_slots(),
+m_head(),
+m_tail(0U),
+m_enabled(),
+m_dropped(),
+m_file(NULL)
+{
+  for (uint32_t i = 0U; i < DEBUG_LOG_LENGTH; i++)
+    m_slots[i].seq.store(i, std::memory_order_relaxed);
+
+  m_head.store(0U, std::memory_order_relaxed);
+  m_enabled.store(true, std::memory_order_relaxed);
+  m_dropped.store(0U, std::memory_order_relaxed);
+}
+
+CDebugLog::~CDebugLog()
+{
+  if (m_file != NULL)
+    ::fclose(m_file);
+}
+
+void CDebugLog::setEnabled(bool enabled)
+{
+  m_enabled.store(enabled || m_file != NULL, std::memory_order_relaxed);
+}
+
+bool CDebugLog::setFile(const std::string& fileName)
+{
+  m_file = ::fopen(fileName.c_str(), "a");
+  if (m_file == NULL)
+    return false;
+
+  m_enabled.store(true, std::memory_order_relaxed);
+
+  return true;
+}
+
+bool CDebugLog::hasFile() const
+{
+  return m_file != NULL;
+}
+
+void CDebugLog::add(const char* text)
+{
+  put(text, 0U, 0, 0, 0, 0);
+}
+
+void CDebugLog::add(const char* text, int16_t n1)
+{
+  put(text, 1U, n1, 0, 0, 0);
+}
+
+void CDebugLog::add(const char* text, int16_t n1, int16_t n2)
+{
+  put(text, 2U, n1, n2, 0, 0);
+}
+
+void CDebugLog::add(const char* text, int16_t n1, int16_t n2, int16_t n3)
+{
+  put(text, 3U, n1, n2, n3, 0);
+}
+
+void CDebugLog::add(const char* text, int16_t n1, int16_t n2, int16_t n3, int16_t n4)
+{
+  put(text, 4U, n1, n2, n3, n4);
+}
+
+void CDebugLog::put(const char* text, uint8_t count, int16_t n1, int16_t n2, int16_t n3, int16_t n4)
+{
+  if (!m_enabled.load(std::memory_order_relaxed))
+    return;
+
+  // Claim the slot at the head, unless the reader has yet to empty it
+  uint32_t pos = m_head.load(std::memory_order_relaxed);
+  Slot* slot;
+  for (;;) {
+    slot = &m_slots[pos % DEBUG_LOG_LENGTH];
+
+    int32_t diff = int32_t(slot->seq.load(std::memory_order_acquire) - pos);
+    if (diff == 0) {
+      if (m_head.compare_exchange_weak(pos, pos + 1U, std::memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      m_dropped.fetch_add(1U, std::memory_order_relaxed);
+      return;
+    } else {
+      pos = m_head.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->event.text  = text;
+  slot->event.count = count;
+  slot->event.n[0U] = n1;
+  slot->event.n[1U] = n2;
+  slot->event.n[2U] = n3;
+  slot->event.n[3U] = n4;
+
+  slot->seq.store(pos + 1U, std::memory_order_release);
+}
+
+bool CDebugLog::get(DebugEvent& event)
+{
+  Slot& slot = m_slots[m_tail % DEBUG_LOG_LENGTH];
+
+  if (slot.seq.load(std::memory_order_acquire) != m_tail + 1U)
+    return false;
+
+  event = slot.event;
+
+  slot.seq.store(m_tail + DEBUG_LOG_LENGTH, std::memory_order_release);
+  m_tail++;
+
+  return true;
+}
+
+uint32_t CDebugLog::getDropped()
+{
+  return m_dropped.exchange(0U, std::memory_order_relaxed);
+}
+
+void CDebugLog::writeFile()
+{
+  if (m_file == NULL)
+    return;
+
+  DebugEvent event;
+  char stamp[40U];
+  bool written = false;
+
+  while (get(event)) {
+    // The messages of one pass share a time stamp
+    if (!written) {
+      struct timeval now;
+      ::gettimeofday(&now, NULL);
+
+      struct tm tm;
+      ::localtime_r(&now.tv_sec, &tm);
+
+      size_t n = ::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+      ::snprintf(stamp + n, sizeof(stamp) - n, ".%03ld", long(now.tv_usec / 1000));
+      written = true;
+    }
+
+    ::fprintf(m_file, "%s %s", stamp, event.text);
+    for (uint8_t i = 0U; i < event.count; i++)
+      ::fprintf(m_file, " %d", event.n[i]);
+    ::fputc('\n', m_file);
+  }
+
+  uint32_t dropped = getDropped();
+  if (dropped > 0U) {
+    ::fprintf(m_file, "%u debug messages dropped\n", dropped);
+    written = true;
+  }
+
+  if (written)
+    ::fflush(m_file);
+}
@@ -0,0 +1,81 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(DEBUGLOG_H)
+#define  DEBUGLOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// One DEBUGn call, the text is the string literal itself and is never copied
+struct DebugEvent {
+  const char* text;
+  uint8_t     count;
+  int16_t     n[4U];
+};
+
+// The debug messages of one modem. Any thread may add to it without a lock or a
+// system call, and the CDebugWriter thread takes them out for the host or a log file.
+// Messages added while it is full are dropped and counted.
+class CDebugLog {
+public:
+  CDebugLog();
+  ~CDebugLog();
+
+  // The host turns the messages on and off, a log file keeps them on
+  void setEnabled(bool enabled);
+  bool setFile(const std::string& fileName);
+  bool hasFile() const;
+
+  void add(const char* text);
+  void add(const char* text, int16_t n1);
+  void add(const char* text, int16_t n1, int16_t n2);
+  void add(const char* text, int16_t n1, int16_t n2, int16_t n3);
+  void add(const char* text, int16_t n1, int16_t n2, int16_t n3, int16_t n4);
+
+  // Only one thread may take messages out
+  bool get(DebugEvent& event);
+
+  // The messages dropped since the last call
+  uint32_t getDropped();
+
+  // Takes out all of the messages and writes them to the log file
+  void writeFile();
+
+private:
+  static const uint32_t DEBUG_LOG_LENGTH = 256U;
+
+  // The sequence is the position once the slot is free, and the position plus one once it is full
+  struct Slot {
+    std::atomic<uint32_t> seq;
+    DebugEvent            event;
+  };
+
+  Slot                  m_slots[DEBUG_LOG_LENGTH];
+  std::atomic<uint32_t> m_head;
+  uint32_t              m_tail;
+  std::atomic<bool>     m_enabled;
+  std::atomic<uint32_t> m_dropped;
+  FILE*                 m_file;
+
+  void put(const char* text, uint8_t count, int16_t n1, int16_t n2, int16_t n3, int16_t n4);
+};
+
+#endif
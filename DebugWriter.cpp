@@ -0,0 +1,67 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "DebugWriter.h"
+#include "Globals.h"
+
+// How often the logs are emptied, well inside the time it takes to fill one
+const unsigned int DRAIN_INTERVAL = 10U;
+
+CDebugWriter::CDebugWriter() :
+CThread(),
+m_modems(),
+m_stop()
+{
+  m_stop.store(false, std::memory_order_relaxed);
+}
+
+CDebugWriter::~CDebugWriter()
+{
+}
+
+void CDebugWriter::addModem(CModem* modem)
+{
+  m_modems.push_back(modem);
+}
+
+void CDebugWriter::stop()
+{
+  m_stop.store(true, std::memory_order_release);
+}
+
+void CDebugWriter::entry()
+{
+  while (!m_stop.load(std::memory_order_acquire)) {
+    drain();
+    CThread::sleep(DRAIN_INTERVAL);
+  }
+
+  drain();
+}
+
+void CDebugWriter::drain()
+{
+  for (unsigned int i = 0U; i < m_modems.size(); i++) {
+    CModem* modem = m_modems[i];
+
+    if (modem->debug.hasFile())
+      modem->debug.writeFile();
+    else
+      modem->serial.writeDebugLog();
+  }
+}
@@ -0,0 +1,51 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(DEBUGWRITER_H)
+#define  DEBUGWRITER_H
+
+#include "Thread.h"
+
+#include <atomic>
+#include <vector>
+
+class CModem;
+
+// Takes the queued debug messages of every modem and sends them to the host,
+// or writes them to the modem's log file, on its own thread so that neither
+// the formatting nor the writes hold up the modems.
+class CDebugWriter : public CThread {
+public:
+  CDebugWriter();
+  virtual ~CDebugWriter();
+
+  void addModem(CModem* modem);
+
+  // Writes what is left and ends the thread, wait() for it afterwards
+  void stop();
+
+  virtual void entry();
+
+private:
+  std::vector<CModem*> m_modems;
+  std::atomic<bool>    m_stop;
+
+  void drain();
+};
+
+#endif
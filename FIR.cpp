@@ -18,11 +18,85 @@
 
 #include "FIR.h"
 
+#include <cstddef>
+
+#if defined(FIXED_POINT)
+CFIR::CFIR(uint16_t numTaps, const float* pCoeffs, uint32_t blockSize) :
+m_numTaps(numTaps),
+m_pCoeffs(NULL),
+m_pState(NULL)
+{
+  m_pCoeffs = new q15_t[numTaps];
+  for (uint16_t i = 0U; i < numTaps; i++)
+    m_pCoeffs[i] = floatToQ15(pCoeffs[i]);
+
+  m_pState = new q15_t[numTaps + blockSize - 1U]();
+}
+
+void CFIR::process(const float* pSrc, float* pDst, uint32_t blockSize)
+{
+   q15_t *pState = m_pState;                  /* State pointer */
+   const q15_t *pCoeffs = m_pCoeffs;          /* Coefficient pointer */
+   q15_t *pStateCurnt;                        /* Points to the current sample of the state */
+   q15_t *px;                                 /* Temporary pointers for state and coefficient buffers */
+   const q15_t *pb;                           /* Temporary pointers for state and coefficient buffers */
+   uint32_t numTaps = m_numTaps;              /* Number of filter coefficients in the filter */
+   uint32_t i, tapCnt, blkCnt;                /* Loop counters */
+
+   /* A 64-bit accumulator as in arm_fir_q15, the 162 tap NXDN filter can overflow 32 bits */
+   q63_t acc;
+
+   pStateCurnt = &(m_pState[(numTaps - 1U)]);
+
+   blkCnt = blockSize;
+
+   while (blkCnt > 0U)
+   {
+      /* Copy one sample at a time into state buffer, saturated to Q15 */
+      *pStateCurnt++ = floatToQ15(*pSrc++);
+
+      acc = 0;
+
+      px = pState;
+
+      pb = pCoeffs;
+
+      i = numTaps;
+
+      /* Perform the multiply-accumulates, Q15 * Q15 gives Q30 */
+      do
+      {
+         acc += q31_t(*px++) * *pb++;
+         i--;
+
+      } while (i > 0U);
+
+      /* Back to Q15, kept in 32 bits so that gains above one are not clipped */
+      *pDst++ = q15ToFloat(clipQ31(acc >> 15));
+
+      pState = pState + 1;
+
+      blkCnt--;
+   }
+
+   /* Copy the last numTaps - 1 samples to the start of the state buffer */
+   pStateCurnt = m_pState;
+
+   tapCnt = numTaps - 1U;
+
+   while (tapCnt > 0U)
+   {
+      *pStateCurnt++ = *pState++;
+
+      tapCnt--;
+   }
+}
+#else
 CFIR::CFIR(uint16_t numTaps, const float* pCoeffs, uint32_t blockSize) :
 m_numTaps(numTaps),
 m_pCoeffs(pCoeffs)
 {
-  m_pState = new float[numTaps + blockSize - 1U];
+  m_pState = new float[numTaps + blockSize - 1U]();
 }
 
 void CFIR::process(const float* pSrc, float* pDst, uint32_t blockSize)
@@ -98,3 +172,4 @@ void CFIR::process(const float* pSrc, float* pDst, uint32_t blockSize)
    }
 }
 
+#endif
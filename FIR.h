@@ -19,6 +19,8 @@
 #if !defined(FIR_H)
 #define  FIR_H
 
+#include "FixedPoint.h"
+
 #include <cstdint>
 
 class CFIR {
@@ -29,9 +31,79 @@ public:
 
 private:
   uint16_t     m_numTaps;
+#if defined(FIXED_POINT)
+  q15_t*       m_pCoeffs;
+  q15_t*       m_pState;
+#else
   const float* m_pCoeffs;
   float*       m_pState;
+#endif
+};
+
+// The taps Tap to NumTaps - 1 of a compile time filter, unrolled and with the zero taps dropped
+template <uint16_t Tap, uint16_t NumTaps, const float* Coeffs, uint16_t Stride = 1U, uint16_t Offset = 0U>
+struct CFIRTaps {
+  static inline float mac(float acc, const float* pState)
+  {
+    // Same order as the loop in CFIR, so the results are identical
+    if (Coeffs[Offset + Tap * Stride] != 0.0F)
+      acc += pState[Tap] * Coeffs[Offset + Tap * Stride];
+
+    return CFIRTaps<Tap + 1U, NumTaps, Coeffs, Stride, Offset>::mac(acc, pState);
+  }
 };
 
+template <uint16_t NumTaps, const float* Coeffs, uint16_t Stride, uint16_t Offset>
+struct CFIRTaps<NumTaps, NumTaps, Coeffs, Stride, Offset> {
+  static inline float mac(float acc, const float*)
+  {
+    return acc;
+  }
+};
+
+#if defined(FIXED_POINT)
+// The fixed point filters convert their coefficients at run time
+template <uint16_t NumTaps, const float* Coeffs, uint32_t BlockSize>
+class CStaticFIR : public CFIR {
+public:
+  CStaticFIR() :
+  CFIR(NumTaps, Coeffs, BlockSize)
+  {
+  }
+};
+#else
+// A CFIR whose length and coefficients are known at compile time
+template <uint16_t NumTaps, const float* Coeffs, uint32_t BlockSize>
+class CStaticFIR {
+public:
+  CStaticFIR() :
+  m_state()
+  {
+  }
+
+  void process(const float* pSrc, float* pDst, uint32_t blockSize)
+  {
+    float* pState = m_state;
+
+    float* pStateCurnt = m_state + (NumTaps - 1U);
+
+    for (uint32_t i = 0U; i < blockSize; i++) {
+      *pStateCurnt++ = *pSrc++;
+
+      *pDst++ = CFIRTaps<0U, NumTaps, Coeffs>::mac(0.0F, pState);
+
+      pState++;
+    }
+
+    // Keep the last NumTaps - 1 samples for the next block
+    for (uint16_t i = 0U; i < (NumTaps - 1U); i++)
+      m_state[i] = pState[i];
+  }
+
+private:
+  float m_state[NumTaps + BlockSize - 1U];
+};
+#endif
+
 #endif
 
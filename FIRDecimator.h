@@ -0,0 +1,63 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(FIRDECIMATOR_H)
+#define  FIRDECIMATOR_H
+
+#include "FIR.h"
+
+#include <cstdint>
+
+// A decimate by M filter, only every Mth output is calculated and the zero taps of a half band
+// design are dropped, which makes it the polyphase form without splitting the table by hand
+template <uint8_t M, uint16_t NumTaps, const float* Coeffs, uint32_t BlockSize>
+class CStaticFIRDecimator {
+public:
+  CStaticFIRDecimator() :
+  m_state()
+  {
+  }
+
+  // Takes blockSize * M input samples and produces blockSize outputs
+  void process(const float* pSrc, float* pDst, uint32_t blockSize)
+  {
+    float* pState = m_state + (M - 1U);
+
+    float* pStateCurnt = m_state + (NumTaps - 1U);
+
+    for (uint32_t i = 0U; i < blockSize; i++) {
+      for (uint8_t j = 0U; j < M; j++)
+        *pStateCurnt++ = *pSrc++;
+
+      *pDst++ = CFIRTaps<0U, NumTaps, Coeffs>::mac(0.0F, pState);
+
+      pState += M;
+    }
+
+    // Keep the last NumTaps - 1 samples for the next block
+    pState = m_state + blockSize * M;
+    for (uint16_t i = 0U; i < (NumTaps - 1U); i++)
+      m_state[i] = pState[i];
+  }
+
+private:
+  float m_state[NumTaps + BlockSize * M - 1U];
+};
+
+#endif
+
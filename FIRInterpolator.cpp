@@ -18,12 +18,95 @@
 
 #include "FIRInterpolator.h"
 
+#include <cstddef>
+
+#if defined(FIXED_POINT)
+CFIRInterpolator::CFIRInterpolator(uint8_t L, uint16_t phaseLength, const float* pCoeffs, uint32_t blockSize) :
+m_L(L),
+m_phaseLength(phaseLength),
+m_pCoeffs(NULL),
+m_pState(NULL)
+{
+  m_pCoeffs = new q15_t[L * phaseLength];
+  for (uint16_t i = 0U; i < (L * phaseLength); i++)
+    m_pCoeffs[i] = floatToQ15(pCoeffs[i]);
+
+  m_pState = new q15_t[L * phaseLength + blockSize - 1U]();
+}
+
+void CFIRInterpolator::process(const float* pSrc, float* pDst, uint32_t blockSize)
+{
+  q15_t *pState = m_pState;                 /* State pointer */
+  const q15_t *pCoeffs = m_pCoeffs;         /* Coefficient pointer */
+  q15_t *pStateCurnt;                       /* Points to the current sample of the state */
+  q15_t *ptr1;                              /* Temporary pointers for state and coefficient buffers */
+  const q15_t *ptr2;                        /* Temporary pointers for state and coefficient buffers */
+
+  q63_t sum;                                /* Accumulator */
+  uint32_t i, blkCnt;                       /* Loop counters */
+  uint16_t phaseLen = m_phaseLength, tapCnt;    /* Length of each polyphase filter component */
+
+  pStateCurnt = m_pState + (phaseLen - 1U);
+
+  blkCnt = blockSize;
+
+  while (blkCnt > 0U)
+  {
+    /* Copy new input sample into the state buffer, saturated to Q15 */
+    *pStateCurnt++ = floatToQ15(*pSrc++);
+
+    i = m_L;
+
+    while (i > 0U)
+    {
+      sum = 0;
+
+      ptr1 = pState;
+
+      ptr2 = pCoeffs + (i - 1U);
+
+      tapCnt = phaseLen;
+
+      while (tapCnt > 0U)
+      {
+        /* Perform the multiply-accumulate, Q15 * Q15 gives Q30 */
+        sum += q31_t(*ptr1++) * *ptr2;
+
+        ptr2 += m_L;
+
+        tapCnt--;
+      }
+
+      /* Back to Q15, kept in 32 bits so that gains above one are not clipped */
+      *pDst++ = q15ToFloat(clipQ31(sum >> 15));
+
+      i--;
+    }
+
+    pState = pState + 1;
+
+    blkCnt--;
+  }
+
+  /* Copy the last phaseLen - 1 samples to the start of the state buffer */
+  pStateCurnt = m_pState;
+
+  tapCnt = phaseLen - 1U;
+
+  while (tapCnt > 0U)
+  {
+    *pStateCurnt++ = *pState++;
+
+    tapCnt--;
+  }
+}
+#else
 CFIRInterpolator::CFIRInterpolator(uint8_t L, uint16_t phaseLength, const float* pCoeffs, uint32_t blockSize) :
 m_L(L),
 m_phaseLength(phaseLength),
 m_pCoeffs(pCoeffs)
 {
-  m_pState = new float[L * phaseLength + blockSize - 1U];
+  m_pState = new float[L * phaseLength + blockSize - 1U]();
 }
 
 void CFIRInterpolator::process(const float* pSrc, float* pDst, uint32_t blockSize)
@@ -115,3 +198,4 @@ void CFIRInterpolator::process(const float* pSrc, float* pDst, uint32_t blockSiz
   }
 }
 
+#endif
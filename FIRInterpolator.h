@@ -19,6 +19,9 @@
 #if !defined(FIRINTERPOLATOR_H)
 #define  FIRINTERPOLATOR_H
 
+#include "FixedPoint.h"
+#include "FIR.h"
+
 #include <cstdint>
 
 class CFIRInterpolator {
@@ -30,9 +33,78 @@ public:
 private:
   uint8_t      m_L;
   uint16_t     m_phaseLength;
+#if defined(FIXED_POINT)
+  q15_t*       m_pCoeffs;
+  q15_t*       m_pState;
+#else
   const float* m_pCoeffs;
   float*       m_pState;
+#endif
+};
+
+// The polyphase outputs for the phases Phase down to zero, in the order CFIRInterpolator produces them
+template <uint8_t Phase, uint8_t L, uint16_t PhaseLength, const float* Coeffs>
+struct CFIRPhases {
+  static inline void process(const float* pState, float* pDst)
+  {
+    *pDst = CFIRTaps<0U, PhaseLength, Coeffs, L, Phase>::mac(0.0F, pState);
+
+    CFIRPhases<Phase - 1U, L, PhaseLength, Coeffs>::process(pState, pDst + 1U);
+  }
 };
 
+template <uint8_t L, uint16_t PhaseLength, const float* Coeffs>
+struct CFIRPhases<0U, L, PhaseLength, Coeffs> {
+  static inline void process(const float* pState, float* pDst)
+  {
+    *pDst = CFIRTaps<0U, PhaseLength, Coeffs, L, 0U>::mac(0.0F, pState);
+  }
+};
+
+#if defined(FIXED_POINT)
+// The fixed point filters convert their coefficients at run time
+template <uint8_t L, uint16_t PhaseLength, const float* Coeffs, uint32_t BlockSize>
+class CStaticFIRInterpolator : public CFIRInterpolator {
+public:
+  CStaticFIRInterpolator() :
+  CFIRInterpolator(L, PhaseLength, Coeffs, BlockSize)
+  {
+  }
+};
+#else
+// A CFIRInterpolator whose factor, length and coefficients are known at compile time
+template <uint8_t L, uint16_t PhaseLength, const float* Coeffs, uint32_t BlockSize>
+class CStaticFIRInterpolator {
+public:
+  CStaticFIRInterpolator() :
+  m_state()
+  {
+  }
+
+  void process(const float* pSrc, float* pDst, uint32_t blockSize)
+  {
+    float* pState = m_state;
+
+    float* pStateCurnt = m_state + (PhaseLength - 1U);
+
+    for (uint32_t i = 0U; i < blockSize; i++) {
+      *pStateCurnt++ = *pSrc++;
+
+      CFIRPhases<L - 1U, L, PhaseLength, Coeffs>::process(pState, pDst);
+      pDst += L;
+
+      pState++;
+    }
+
+    // Keep the last PhaseLength - 1 samples for the next block
+    for (uint16_t i = 0U; i < (PhaseLength - 1U); i++)
+      m_state[i] = pState[i];
+  }
+
+private:
+  float m_state[PhaseLength + BlockSize - 1U];
+};
+#endif
+
 #endif
 
@@ -0,0 +1,218 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "FanoutRB.h"
+
+#include <cassert>
+#include <cstddef>
+
+// A sleeping reader is woken once this many blocks are waiting for it, rather than for each one
+const uint32_t FANOUT_WAKE_BLOCKS = 32U;
+
+CFanoutRB::CFanoutRB(uint16_t length, uint8_t readers) :
+m_length(length),
+m_readers(readers),
+m_blocks(NULL),
+m_head(0U),
+m_writerWaiting(false),
+m_stopped(false),
+m_overflow(false),
+m_mutex(),
+m_readerCond(),
+m_writerCond()
+{
+  assert(readers <= FANOUT_MAX_READERS);
+  assert((length & (length - 1U)) == 0U);
+  assert(length > FANOUT_WAKE_BLOCKS);
+
+  m_blocks = new RXBlock[length];
+
+  for (uint8_t i = 0U; i < FANOUT_MAX_READERS; i++) {
+    m_tails[i] = 0U;
+    m_readerWaiting[i] = false;
+  }
+}
+
+CFanoutRB::~CFanoutRB()
+{
+  delete[] m_blocks;
+}
+
+bool CFanoutRB::put(const float* samples, const float* dcSamples, uint8_t modes, uint64_t captured)
+{
+  if (!hasSpace()) {
+    m_overflow = true;
+    return false;
+  }
+
+  uint32_t head = m_head.load(std::memory_order_relaxed);
+
+  RXBlock& block = m_blocks[head % m_length];
+  for (uint16_t i = 0U; i < FANOUT_BLOCK_SIZE; i++) {
+    block.samples[i]   = samples[i];
+    block.dcSamples[i] = dcSamples[i];
+  }
+  block.modes    = modes;
+  block.captured = captured;
+
+  m_head.store(head + 1U, std::memory_order_release);
+
+  notify(false);
+
+  return true;
+}
+
+bool CFanoutRB::waitForSpace()
+{
+  // The readers may be asleep on a part batch
+  notify(true);
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  m_writerWaiting.store(true, std::memory_order_seq_cst);
+
+  while (!m_stopped.load(std::memory_order_relaxed) && !hasSpace())
+    m_writerCond.wait(lock);
+
+  m_writerWaiting.store(false, std::memory_order_relaxed);
+
+  return !m_stopped.load(std::memory_order_relaxed);
+}
+
+void CFanoutRB::notify(bool force)
+{
+  // Pairs with the waiting flag a reader sets before it looks at the head
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  uint32_t head = m_head.load(std::memory_order_relaxed);
+
+  bool wake = false;
+  for (uint8_t i = 0U; i < m_readers; i++) {
+    if (!m_readerWaiting[i].load(std::memory_order_relaxed))
+      continue;
+
+    uint32_t waiting = head - m_tails[i].load(std::memory_order_relaxed);
+    if (waiting >= FANOUT_WAKE_BLOCKS || (force && waiting > 0U))
+      wake = true;
+  }
+
+  if (wake) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_readerCond.notify_all();
+  }
+}
+
+bool CFanoutRB::peek(uint8_t reader, RXBlock& block) const
+{
+  uint32_t tail = m_tails[reader].load(std::memory_order_relaxed);
+  if (tail == m_head.load(std::memory_order_acquire))
+    return false;
+
+  block = m_blocks[tail % m_length];
+
+  return true;
+}
+
+void CFanoutRB::advance(uint8_t reader)
+{
+  uint32_t tail = m_tails[reader].load(std::memory_order_relaxed);
+
+  m_tails[reader].store(tail + 1U, std::memory_order_release);
+
+  // Pairs with the waiting flag the writer sets before it looks at the tails
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if (m_writerWaiting.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_writerCond.notify_one();
+  }
+}
+
+bool CFanoutRB::wait(uint8_t reader)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  m_readerWaiting[reader].store(true, std::memory_order_seq_cst);
+
+  while (!m_stopped.load(std::memory_order_relaxed) && m_tails[reader].load(std::memory_order_relaxed) == m_head.load(std::memory_order_seq_cst))
+    m_readerCond.wait(lock);
+
+  m_readerWaiting[reader].store(false, std::memory_order_relaxed);
+
+  return !m_stopped.load(std::memory_order_relaxed);
+}
+
+void CFanoutRB::stop()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  m_stopped.store(true, std::memory_order_relaxed);
+
+  m_readerCond.notify_all();
+  m_writerCond.notify_all();
+}
+
+bool CFanoutRB::isEmpty() const
+{
+  uint32_t head = m_head.load(std::memory_order_acquire);
+
+  for (uint8_t i = 0U; i < m_readers; i++) {
+    if (m_tails[i].load(std::memory_order_acquire) != head)
+      return false;
+  }
+
+  return true;
+}
+
+bool CFanoutRB::waitForEmpty()
+{
+  notify(true);
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  m_writerWaiting.store(true, std::memory_order_seq_cst);
+
+  while (!m_stopped.load(std::memory_order_relaxed) && !isEmpty())
+    m_writerCond.wait(lock);
+
+  m_writerWaiting.store(false, std::memory_order_relaxed);
+
+  return !m_stopped.load(std::memory_order_relaxed);
+}
+
+bool CFanoutRB::hasOverflowed()
+{
+  bool overflow = m_overflow;
+
+  m_overflow = false;
+
+  return overflow;
+}
+
+bool CFanoutRB::hasSpace() const
+{
+  uint32_t head = m_head.load(std::memory_order_relaxed);
+
+  // The slowest reader decides how much space there is
+  for (uint8_t i = 0U; i < m_readers; i++) {
+    if ((head - m_tails[i].load(std::memory_order_seq_cst)) >= m_length)
+      return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,89 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(FANOUTRB_H)
+#define  FANOUTRB_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+const uint16_t FANOUT_BLOCK_SIZE = 2U;      // Must match RX_BLOCK_SIZE
+const uint8_t  FANOUT_MAX_READERS = 4U;
+
+struct RXBlock {
+  float   samples[FANOUT_BLOCK_SIZE];
+  float   dcSamples[FANOUT_BLOCK_SIZE];
+  uint8_t modes;
+  uint64_t captured;    // When the last sample was captured, for the latency figures
+};
+
+// One writer and many readers, each reader sees every block in order.
+// The length must be a power of two. Blocks are passed without a lock, a
+// reader with nothing to do or a writer with no space sleeps on a condition.
+class CFanoutRB {
+public:
+  CFanoutRB(uint16_t length, uint8_t readers);
+  ~CFanoutRB();
+
+  bool put(const float* samples, const float* dcSamples, uint8_t modes, uint64_t captured);
+
+  // For the writer, returns once put() will succeed, or false once stopped
+  bool waitForSpace();
+
+  // For the writer, wakes the sleeping readers once they have a batch of blocks,
+  // or when forced, once they have any
+  void notify(bool force);
+
+  // The block stays owned by the reader until it calls advance()
+  bool peek(uint8_t reader, RXBlock& block) const;
+  void advance(uint8_t reader);
+
+  // For a reader, returns once there is a block for it, or false once stopped
+  bool wait(uint8_t reader);
+
+  // Wakes everything that is waiting, which then returns false
+  void stop();
+
+  // True when every reader has consumed everything
+  bool isEmpty() const;
+
+  // Returns once every reader has consumed everything, or false once stopped
+  bool waitForEmpty();
+
+  bool hasOverflowed();
+
+private:
+  uint16_t                m_length;
+  uint8_t                 m_readers;
+  RXBlock*                m_blocks;
+  std::atomic<uint32_t>   m_head;
+  std::atomic<uint32_t>   m_tails[FANOUT_MAX_READERS];
+  std::atomic<bool>       m_readerWaiting[FANOUT_MAX_READERS];
+  std::atomic<bool>       m_writerWaiting;
+  std::atomic<bool>       m_stopped;
+  bool                    m_overflow;
+  std::mutex              m_mutex;
+  std::condition_variable m_readerCond;
+  std::condition_variable m_writerCond;
+
+  bool hasSpace() const;
+};
+
+#endif
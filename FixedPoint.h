@@ -0,0 +1,73 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(FIXEDPOINT_H)
+#define  FIXEDPOINT_H
+
+#include <cstdint>
+
+// The fixed point types used by the filters when built with FIXED_POINT. Only the
+// filters are fixed point, the demodulators' levels and thresholds are still float.
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+
+inline q31_t clipQ31(q63_t value)
+{
+  value = value >  INT32_MAX ? q63_t(INT32_MAX) : value;
+  value = value <  INT32_MIN ? q63_t(INT32_MIN) : value;
+
+  return q31_t(value);
+}
+
+inline q15_t clipQ15(q31_t value)
+{
+  value = value >  INT16_MAX ? q31_t(INT16_MAX) : value;
+  value = value <  INT16_MIN ? q31_t(INT16_MIN) : value;
+
+  return q15_t(value);
+}
+
+// The offset makes the truncation round to nearest without a branch on the sign
+inline q15_t floatToQ15(float value)
+{
+  value = value >  1.0F ?  1.0F : value;
+  value = value < -1.0F ? -1.0F : value;
+
+  return clipQ15(q31_t(value * 32768.0F + 32768.5F) - 32768);
+}
+
+inline q31_t floatToQ31(float value)
+{
+  value = value >  1.0F ?  1.0F : value;
+  value = value < -1.0F ? -1.0F : value;
+
+  return clipQ31(q63_t(double(value) * 2147483648.0));
+}
+
+inline float q15ToFloat(q31_t value)
+{
+  return float(value) * (1.0F / 32768.0F);
+}
+
+inline float q31ToFloat(q31_t value)
+{
+  return float(value) * (1.0F / 2147483648.0F);
+}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "FrameRB.h"
+
+#include <cassert>
+#include <cstddef>
+
+CFrameRB::CFrameRB(uint16_t length) :
+m_length(length),
+m_buffer(NULL),
+m_head(0U),
+m_tail(0U),
+m_overflow(false)
+{
+  assert((length & (length - 1U)) == 0U);
+
+  m_buffer = new uint8_t[length];
+}
+
+CFrameRB::~CFrameRB()
+{
+  delete[] m_buffer;
+}
+
+bool CFrameRB::put(const uint8_t* data, uint16_t length)
+{
+  uint32_t head = m_head.load(std::memory_order_relaxed);
+  uint32_t tail = m_tail.load(std::memory_order_acquire);
+
+  if ((head - tail + length) > m_length) {
+    m_overflow = true;
+    return false;
+  }
+
+  for (uint16_t i = 0U; i < length; i++)
+    m_buffer[(head + i) % m_length] = data[i];
+
+  m_head.store(head + length, std::memory_order_release);
+
+  return true;
+}
+
+uint16_t CFrameRB::get(uint8_t* data, uint16_t length)
+{
+  uint32_t tail = m_tail.load(std::memory_order_relaxed);
+  uint32_t head = m_head.load(std::memory_order_acquire);
+
+  uint32_t n = head - tail;
+  if (n > length)
+    n = length;
+
+  for (uint32_t i = 0U; i < n; i++)
+    data[i] = m_buffer[(tail + i) % m_length];
+
+  m_tail.store(tail + n, std::memory_order_release);
+
+  return uint16_t(n);
+}
+
+bool CFrameRB::hasOverflowed()
+{
+  return m_overflow.exchange(false);
+}
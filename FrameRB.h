@@ -0,0 +1,48 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(FRAMERB_H)
+#define  FRAMERB_H
+
+#include <atomic>
+#include <cstdint>
+
+const uint16_t FRAME_RINGBUFFER_SIZE = 2048U;
+
+// One writer and one reader, the writer only publishes complete frames
+class CFrameRB {
+public:
+  CFrameRB(uint16_t length = FRAME_RINGBUFFER_SIZE);
+  ~CFrameRB();
+
+  bool put(const uint8_t* data, uint16_t length);
+
+  // Returns the number of bytes copied, zero when empty
+  uint16_t get(uint8_t* data, uint16_t length);
+
+  bool hasOverflowed();
+
+private:
+  uint16_t              m_length;
+  uint8_t*              m_buffer;
+  std::atomic<uint32_t> m_head;
+  std::atomic<uint32_t> m_tail;
+  std::atomic<bool>     m_overflow;
+};
+
+#endif
@@ -45,6 +45,15 @@ enum MMDVM_STATE {
   STATE_CALPOCSAG = 101
 };
 
+class CModem;
+
+// Samples per call into the receivers, at the receive rate
+const uint16_t RX_BLOCK_SIZE = 2U;
+
+const uint16_t TX_RINGBUFFER_SIZE = 500U;
+const uint16_t RX_RINGBUFFER_SIZE = 600U;
+
+#include "Modes.h"
 #include "SerialPort.h"
 #include "DMRDMORX.h"
 #include "DMRDMOTX.h"
@@ -67,53 +76,7 @@ enum MMDVM_STATE {
 #include "Debug.h"
 #include "IO.h"
 
-const uint16_t RX_BLOCK_SIZE = 2U;
-
-const uint16_t TX_RINGBUFFER_SIZE = 500U;
-const uint16_t RX_RINGBUFFER_SIZE = 600U;
-
-extern MMDVM_STATE m_modemState;
-
-extern bool m_dstarEnable;
-extern bool m_dmrEnable;
-extern bool m_ysfEnable;
-extern bool m_p25Enable;
-extern bool m_nxdnEnable;
-extern bool m_pocsagEnable;
-
-extern bool m_duplex;
-
-extern bool m_tx;
-extern bool m_dcd;
-
-extern CSerialPort serial;
-extern CIO io;
-
-extern CDStarRX dstarRX;
-extern CDStarTX dstarTX;
-
-extern CDMRDMORX dmrDMORX;
-extern CDMRDMOTX dmrDMOTX;
-
-extern CYSFRX ysfRX;
-extern CYSFTX ysfTX;
-
-extern CP25RX p25RX;
-extern CP25TX p25TX;
-
-extern CNXDNRX nxdnRX;
-extern CNXDNTX nxdnTX;
-
-extern CPOCSAGTX pocsagTX;
-
-extern CCalDStarRX calDStarRX;
-extern CCalDStarTX calDStarTX;
-extern CCalDMR     calDMR;
-extern CCalP25     calP25;
-extern CCalNXDN    calNXDN;
-extern CCalPOCSAG  calPOCSAG;
-
-extern CCWIdTX cwIdTX;
+#include "Modem.h"
 
 #endif
 
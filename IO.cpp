@@ -21,78 +21,203 @@
 #include "Globals.h"
 #include "IO.h"
 
+static_assert(FANOUT_BLOCK_SIZE == RX_BLOCK_SIZE, "The fan-out and receive block sizes differ");
+
+// About 40ms of receive audio
+const uint16_t FANOUT_LENGTH = 1024U;
+
+#if defined(RX_24KHZ)
+// Generated using [b, a] = butter(1, 0.001) in MATLAB
+static float DC_FILTER[] = {0.001568334F, 0.000000000F, 0.001568334F, 0.000000000F, 0.996863332F, 0.000000000F}; // {b0, 0, b1, b2, -a1, -a2}
+#else
 // Generated using [b, a] = butter(1, 0.0005) in MATLAB
 static float DC_FILTER[] = {0.000784782F, 0.000000000F, 0.000784782F, 0.000000000F, 0.998430436F, 0.000000000F}; // {b0, 0, b1, b2, -a1, -a2}
+#endif
 const uint32_t DC_FILTER_STAGES = 1U; // One Biquad stage
 
+#if defined(RX_24KHZ)
+// Half band, a 19 tap Kaiser windowed sinc with a beta of 7, more than 70 dB down above 18 kHz
+const float CIO::DECIMATION_FILTER[] = {0.0002098F,  0.0000000F, -0.0043181F,  0.0000000F,  0.0215588F,  0.0000000F, -0.0733301F,  0.0000000F,
+				        0.3058422F,  0.5000748F,  0.3058422F,  0.0000000F, -0.0733301F,  0.0000000F,  0.0215588F,  0.0000000F,
+				       -0.0043181F,  0.0000000F,  0.0002098F,  0.0000000F};
+
+// Every other tap of the 48 kHz filter, doubled to keep the same gain
+const float CIO::RRC_0_2_FILTER[] = {0.0173346F,  0.0044558F, -0.0146488F, -0.0315562F, -0.0365612F, -0.0238654F,  0.0048220F,  0.0392468F,
+				     0.0635396F,  0.0626240F,  0.0294808F, -0.0291146F, -0.0925322F, -0.1312296F, -0.1168248F, -0.0332652F,
+				     0.1151158F,  0.3018890F,  0.4850002F,  0.6185492F,  0.6674398F,  0.6185492F,  0.4850002F,  0.3018890F,
+				     0.1151158F, -0.0332652F, -0.1168248F, -0.1312296F, -0.0925322F, -0.0291146F,  0.0294808F,  0.0626240F,
+				     0.0635396F,  0.0392468F,  0.0048220F, -0.0238654F, -0.0365612F, -0.0315562F, -0.0146488F,  0.0044558F,
+				     0.0173346F,  0.0000000F};
+
+// Every other tap of the 48 kHz filter, doubled to keep the same gain
+const float CIO::NXDN_0_2_FILTER[] = {0.0122684F,  0.0085452F,  0.0031740F, -0.0033570F, -0.0103762F, -0.0169682F, -0.0222786F, -0.0254524F,
+				     -0.0258796F, -0.0230110F, -0.0169072F, -0.0078128F,  0.0034180F,  0.0157476F,  0.0277718F,  0.0379650F,
+				      0.0449232F,  0.0473036F,  0.0442518F,  0.0353404F,  0.0208746F,  0.0016480F, -0.0206306F, -0.0438246F,
+				     -0.0654316F, -0.0826442F, -0.0927762F, -0.0933866F, -0.0825830F, -0.0593280F, -0.0234992F,  0.0240486F,
+				      0.0813624F,  0.1457564F,  0.2135074F,  0.2806482F,  0.3429670F,  0.3963744F,  0.4373912F,  0.4631488F,
+				      0.4719382F,  0.4631488F,  0.4373912F,  0.3963744F,  0.3429670F,  0.2806482F,  0.2135074F,  0.1457564F,
+				      0.0813624F,  0.0240486F, -0.0234992F, -0.0593280F, -0.0825830F, -0.0933866F, -0.0927762F, -0.0826442F,
+				     -0.0654316F, -0.0438246F, -0.0206306F,  0.0016480F,  0.0208746F,  0.0353404F,  0.0442518F,  0.0473036F,
+				      0.0449232F,  0.0379650F,  0.0277718F,  0.0157476F,  0.0034180F, -0.0078128F, -0.0169072F, -0.0230110F,
+				     -0.0258796F, -0.0254524F, -0.0222786F, -0.0169682F, -0.0103762F, -0.0033570F,  0.0031740F,  0.0085452F,
+				      0.0122684F,  0.0000000F};
+
+// Least squares fit to the response of the 48 kHz filter, weighted to the NXDN passband
+const float CIO::NXDN_ISINC_FILTER[] = {0.1302451F, -0.0401231F, -0.2328054F, -0.2402884F, -0.1885924F,  0.1069074F,  0.2555949F,  0.6946200F,
+				        0.6946200F,  0.2555949F,  0.1069074F, -0.1885924F, -0.2402884F, -0.2328054F, -0.0401231F,  0.1302451F};
+
+#if !defined (DSTARBOXCAR)
+// Every other tap of the 48 kHz filter, doubled to keep the same gain
+const float CIO::GAUSSIAN_0_5_FILTER[] = {0.0002442F,  0.0031740F,  0.0231940F,  0.0963774F,  0.2264474F,  0.3010956F,  0.2264474F,  0.0963774F,
+					  0.0231940F,  0.0031740F,  0.0002442F,  0.0000000F};
+#endif
+// One symbol boxcar filter
+const float CIO::BOXCAR_FILTER[] = {0.3662222F,  0.3662222F,  0.3662222F,  0.3662222F,  0.3662222F,  0.0000000F};
+#else
 // Generated using rcosdesign(0.2, 8, 10, 'sqrt') in MATLAB
-static float RRC_0_2_FILTER[] = {0.0086673F,  0.0060427F,  0.0022279F, -0.0023804F, -0.0073244F, -0.0119938F, -0.0157781F, -0.0180059F,
-								-0.0182806F, -0.0162664F, -0.0119327F, -0.0055239F,  0.0024110F,  0.0111087F,  0.0196234F,  0.0268563F,
-								 0.0317698F,  0.0334788F,  0.0313120F,  0.0249947F,  0.0147404F,  0.0011902F, -0.0145573F, -0.0310068F,
-								-0.0462661F, -0.0584429F, -0.0656148F, -0.0660421F, -0.0584124F, -0.0419630F, -0.0166326F,  0.0169988F,
-								 0.0575579F,  0.1030305F,  0.1509445F,  0.1984313F,  0.2425001F,  0.2802820F,  0.3092746F,  0.3274941F,
-								 0.3337199F,  0.3274941F,  0.3092746F,  0.2802820F,  0.2425001F,  0.1984313F,  0.1509445F,  0.1030305F,
-								 0.0575579F,  0.0169988F, -0.0166326F, -0.0419630F, -0.0584124F, -0.0660421F, -0.0656148F, -0.0584429F,
-								-0.0462661F, -0.0310068F, -0.0145573F,  0.0011902F,  0.0147404F,  0.0249947F,  0.0313120F,  0.0334788F,
-								 0.0317698F,  0.0268563F,  0.0196234F,  0.0111087F,  0.0024110F, -0.0055239F, -0.0119327F, -0.0162664F,
-								-0.0182806F, -0.0180059F, -0.0157781F, -0.0119938F, -0.0073244F, -0.0023804F,  0.0022279F,  0.0060427F,
-								 0.0086673F,  0.0000000F};
-const uint16_t RRC_0_2_FILTER_LEN = 82U;
+const float CIO::RRC_0_2_FILTER[] = {0.0086673F,  0.0060427F,  0.0022279F, -0.0023804F, -0.0073244F, -0.0119938F, -0.0157781F, -0.0180059F,
+								    -0.0182806F, -0.0162664F, -0.0119327F, -0.0055239F,  0.0024110F,  0.0111087F,  0.0196234F,  0.0268563F,
+								     0.0317698F,  0.0334788F,  0.0313120F,  0.0249947F,  0.0147404F,  0.0011902F, -0.0145573F, -0.0310068F,
+								    -0.0462661F, -0.0584429F, -0.0656148F, -0.0660421F, -0.0584124F, -0.0419630F, -0.0166326F,  0.0169988F,
+								     0.0575579F,  0.1030305F,  0.1509445F,  0.1984313F,  0.2425001F,  0.2802820F,  0.3092746F,  0.3274941F,
+								     0.3337199F,  0.3274941F,  0.3092746F,  0.2802820F,  0.2425001F,  0.1984313F,  0.1509445F,  0.1030305F,
+								     0.0575579F,  0.0169988F, -0.0166326F, -0.0419630F, -0.0584124F, -0.0660421F, -0.0656148F, -0.0584429F,
+								    -0.0462661F, -0.0310068F, -0.0145573F,  0.0011902F,  0.0147404F,  0.0249947F,  0.0313120F,  0.0334788F,
+								     0.0317698F,  0.0268563F,  0.0196234F,  0.0111087F,  0.0024110F, -0.0055239F, -0.0119327F, -0.0162664F,
+								    -0.0182806F, -0.0180059F, -0.0157781F, -0.0119938F, -0.0073244F, -0.0023804F,  0.0022279F,  0.0060427F,
+								     0.0086673F,  0.0000000F};
 
 // Generated using rcosdesign(0.2, 8, 20, 'sqrt') in MATLAB
-static float NXDN_0_2_FILTER[] = {0.0061342F,  0.0053102F,  0.0042726F,  0.0030213F,  0.0015870F,  0.0000000F, -0.0016785F, -0.0034181F,
-								 -0.0051881F, -0.0068972F, -0.0084841F, -0.0099185F, -0.0111393F, -0.0121158F, -0.0127262F, -0.0130314F,
-								 -0.0129398F, -0.0124210F, -0.0115055F, -0.0101627F, -0.0084536F, -0.0063478F, -0.0039064F, -0.0012207F,
-								  0.0017090F,  0.0047609F,  0.0078738F,  0.0109256F,  0.0138859F,  0.0166021F,  0.0189825F,  0.0209662F,
-								  0.0224616F,  0.0233772F,  0.0236518F,  0.0232551F,  0.0221259F,  0.0202643F,  0.0176702F,  0.0143742F,
-								  0.0104373F,  0.0058901F,  0.0008240F, -0.0046083F, -0.0103153F, -0.0161138F, -0.0219123F, -0.0274972F,
-								 -0.0327158F, -0.0373852F, -0.0413221F, -0.0443739F, -0.0463881F, -0.0472121F, -0.0466933F, -0.0447401F,
-								 -0.0412915F, -0.0362865F, -0.0296640F, -0.0214850F, -0.0117496F, -0.0005493F,  0.0120243F,  0.0258187F,
-								  0.0406812F,  0.0564592F,  0.0728782F,  0.0897244F,  0.1067537F,  0.1236915F,  0.1403241F,  0.1563158F,
-								  0.1714835F,  0.1855220F,  0.1981872F,  0.2093265F,  0.2186956F,  0.2261422F,  0.2315744F,  0.2348704F,
-								  0.2359691F,  0.2348704F,  0.2315744F,  0.2261422F,  0.2186956F,  0.2093265F,  0.1981872F,  0.1855220F,
-								  0.1714835F,  0.1563158F,  0.1403241F,  0.1236915F,  0.1067537F,  0.0897244F,  0.0728782F,  0.0564592F,
-								  0.0406812F,  0.0258187F,  0.0120243F, -0.0005493F, -0.0117496F, -0.0214850F, -0.0296640F, -0.0362865F,
-								 -0.0412915F, -0.0447401F, -0.0466933F, -0.0472121F, -0.0463881F, -0.0443739F, -0.0413221F, -0.0373852F,
-								 -0.0327158F, -0.0274972F, -0.0219123F, -0.0161138F, -0.0103153F, -0.0046083F,  0.0008240F,  0.0058901F,
-								  0.0104373F,  0.0143742F,  0.0176702F,  0.0202643F,  0.0221259F,  0.0232551F,  0.0236518F,  0.0233772F,
-								  0.0224616F,  0.0209662F,  0.0189825F,  0.0166021F,  0.0138859F,  0.0109256F,  0.0078738F,  0.0047609F,
-								  0.0017090F, -0.0012207F, -0.0039064F, -0.0063478F, -0.0084536F, -0.0101627F, -0.0115055F, -0.0124210F,
-								 -0.0129398F, -0.0130314F, -0.0127262F, -0.0121158F, -0.0111393F, -0.0099185F, -0.0084841F, -0.0068972F,
-								 -0.0051881F, -0.0034181F, -0.0016785F,  0.0000000F,  0.0015870F,  0.0030213F,  0.0042726F,  0.0053102F,
-								  0.0061342F,  0.0000000F};
-const uint16_t NXDN_0_2_FILTER_LEN = 162U;
-
-static float NXDN_ISINC_FILTER[] = {0.2324290F, -0.0406812F, -0.0566424F, -0.0796838F, -0.1037324F, -0.1222572F, -0.1290933F, -0.1195715F,
-								   -0.0911893F, -0.0444960F,  0.0171209F,  0.0874966F,  0.1586962F,  0.2220527F,  0.2695395F,  0.2949614F,
-									0.2949614F,  0.2695395F,  0.2220527F,  0.1586962F,  0.0874966F,  0.0171209F, -0.0444960F, -0.0911893F,
-								   -0.1195715F, -0.1290933F, -0.1222572F, -0.1037324F, -0.0796838F, -0.0566424F, -0.0406812F,  0.2324290F};
-const uint16_t NXDN_ISINC_FILTER_LEN = 32U;
+const float CIO::NXDN_0_2_FILTER[] = {0.0061342F,  0.0053102F,  0.0042726F,  0.0030213F,  0.0015870F,  0.0000000F, -0.0016785F, -0.0034181F,
+								     -0.0051881F, -0.0068972F, -0.0084841F, -0.0099185F, -0.0111393F, -0.0121158F, -0.0127262F, -0.0130314F,
+								     -0.0129398F, -0.0124210F, -0.0115055F, -0.0101627F, -0.0084536F, -0.0063478F, -0.0039064F, -0.0012207F,
+								      0.0017090F,  0.0047609F,  0.0078738F,  0.0109256F,  0.0138859F,  0.0166021F,  0.0189825F,  0.0209662F,
+								      0.0224616F,  0.0233772F,  0.0236518F,  0.0232551F,  0.0221259F,  0.0202643F,  0.0176702F,  0.0143742F,
+								      0.0104373F,  0.0058901F,  0.0008240F, -0.0046083F, -0.0103153F, -0.0161138F, -0.0219123F, -0.0274972F,
+								     -0.0327158F, -0.0373852F, -0.0413221F, -0.0443739F, -0.0463881F, -0.0472121F, -0.0466933F, -0.0447401F,
+								     -0.0412915F, -0.0362865F, -0.0296640F, -0.0214850F, -0.0117496F, -0.0005493F,  0.0120243F,  0.0258187F,
+								      0.0406812F,  0.0564592F,  0.0728782F,  0.0897244F,  0.1067537F,  0.1236915F,  0.1403241F,  0.1563158F,
+								      0.1714835F,  0.1855220F,  0.1981872F,  0.2093265F,  0.2186956F,  0.2261422F,  0.2315744F,  0.2348704F,
+								      0.2359691F,  0.2348704F,  0.2315744F,  0.2261422F,  0.2186956F,  0.2093265F,  0.1981872F,  0.1855220F,
+								      0.1714835F,  0.1563158F,  0.1403241F,  0.1236915F,  0.1067537F,  0.0897244F,  0.0728782F,  0.0564592F,
+								      0.0406812F,  0.0258187F,  0.0120243F, -0.0005493F, -0.0117496F, -0.0214850F, -0.0296640F, -0.0362865F,
+								     -0.0412915F, -0.0447401F, -0.0466933F, -0.0472121F, -0.0463881F, -0.0443739F, -0.0413221F, -0.0373852F,
+								     -0.0327158F, -0.0274972F, -0.0219123F, -0.0161138F, -0.0103153F, -0.0046083F,  0.0008240F,  0.0058901F,
+								      0.0104373F,  0.0143742F,  0.0176702F,  0.0202643F,  0.0221259F,  0.0232551F,  0.0236518F,  0.0233772F,
+								      0.0224616F,  0.0209662F,  0.0189825F,  0.0166021F,  0.0138859F,  0.0109256F,  0.0078738F,  0.0047609F,
+								      0.0017090F, -0.0012207F, -0.0039064F, -0.0063478F, -0.0084536F, -0.0101627F, -0.0115055F, -0.0124210F,
+								     -0.0129398F, -0.0130314F, -0.0127262F, -0.0121158F, -0.0111393F, -0.0099185F, -0.0084841F, -0.0068972F,
+								     -0.0051881F, -0.0034181F, -0.0016785F,  0.0000000F,  0.0015870F,  0.0030213F,  0.0042726F,  0.0053102F,
+								      0.0061342F,  0.0000000F};
+
+const float CIO::NXDN_ISINC_FILTER[] = {0.2324290F, -0.0406812F, -0.0566424F, -0.0796838F, -0.1037324F, -0.1222572F, -0.1290933F, -0.1195715F,
+								       -0.0911893F, -0.0444960F,  0.0171209F,  0.0874966F,  0.1586962F,  0.2220527F,  0.2695395F,  0.2949614F,
+									    0.2949614F,  0.2695395F,  0.2220527F,  0.1586962F,  0.0874966F,  0.0171209F, -0.0444960F, -0.0911893F,
+								       -0.1195715F, -0.1290933F, -0.1222572F, -0.1037324F, -0.0796838F, -0.0566424F, -0.0406812F,  0.2324290F};
 
 #if !defined (DSTARBOXCAR)
 // Generated using gaussfir(0.5, 4, 10) in MATLAB
-static float GAUSSIAN_0_5_FILTER[] = {0.0000305F, 0.0001221F, 0.0004578F, 0.0015870F, 0.0046083F, 0.0115970F, 0.0253914F, 0.0481887F,
-									  0.0793176F, 0.1132237F, 0.1402020F, 0.1505478F, 0.1402020F, 0.1132237F, 0.0793176F, 0.0481887F,
-									  0.0253914F, 0.0115970F, 0.0046083F, 0.0015870F, 0.0004578F, 0.0001221F, 0.0000305F, 0.0000000F};
-const uint16_t GAUSSIAN_0_5_FILTER_LEN = 24U;
+const float CIO::GAUSSIAN_0_5_FILTER[] = {0.0000305F, 0.0001221F, 0.0004578F, 0.0015870F, 0.0046083F, 0.0115970F, 0.0253914F, 0.0481887F,
+									      0.0793176F, 0.1132237F, 0.1402020F, 0.1505478F, 0.1402020F, 0.1132237F, 0.0793176F, 0.0481887F,
+									      0.0253914F, 0.0115970F, 0.0046083F, 0.0015870F, 0.0004578F, 0.0001221F, 0.0000305F, 0.0000000F};
 #endif
 // One symbol boxcar filter
-static float BOXCAR_FILTER[] = {0.1831111F, 0.1831111F, 0.1831111F, 0.1831111F, 0.1831111F, 0.1831111F, 0.1831111F, 0.1831111F, 0.1831111F,
-								0.1831111F, 0.0000000F, 0.0000000F};
-const uint16_t BOXCAR_FILTER_LEN = 12U;
+const float CIO::BOXCAR_FILTER[] = {0.1831111F, 0.1831111F, 0.1831111F, 0.1831111F, 0.1831111F, 0.1831111F, 0.1831111F, 0.1831111F, 0.1831111F,
+								    0.1831111F, 0.0000000F, 0.0000000F};
+#endif
 
 const float DC_OFFSET = 0.0F;
 
-CIO::CIO() :
+// The sinks of modes left out of the build are never enabled, see CSerialPort::setConfig()
+static void dstarSamples(CModem& modem, const float* samples, uint8_t length)
+{
+#if defined(MODE_DSTAR)
+  modem.dstarRX.samples(samples, length);
+#endif
+}
+
+static void p25Samples(CModem& modem, const float* samples, uint8_t length)
+{
+#if defined(MODE_P25)
+  modem.p25RX.samples(samples, length);
+#endif
+}
+
+static void nxdnSamples(CModem& modem, const float* samples, uint8_t length)
+{
+#if defined(MODE_NXDN)
+  modem.nxdnRX.samples(samples, length);
+#endif
+}
+
+static void ysfSamples(CModem& modem, const float* samples, uint8_t length)
+{
+#if defined(MODE_YSF)
+  modem.ysfRX.samples(samples, length);
+#endif
+}
+
+static void dmrSamples(CModem& modem, const float* samples, uint8_t length)
+{
+#if defined(MODE_DMR)
+  modem.dmrDMORX.samples(samples, length);
+#endif
+}
+
+static void calDStarSamples(CModem& modem, const float* samples, uint8_t length)
+{
+#if defined(MODE_DSTAR)
+  modem.calDStarRX.samples(samples, length);
+#endif
+}
+
+// Adding a receiver only needs an entry here, in the order of RX_CHAIN
+const CIO::RXChainDef CIO::RX_CHAINS[RX_CHAIN_MAX] = {
+  {true,  &CIO::filterGaussian, STAGE_FIR_GAUSSIAN, {{STATE_DSTAR,    &CModem::dstarEnable, CLASS_DSTAR, &dstarSamples,    STAGE_RX_DSTAR},
+                                                     {STATE_IDLE,     NULL,                 0U,          NULL,             STAGE_COUNT}}},
+  {true,  &CIO::filterBoxcar,   STAGE_FIR_BOXCAR,   {{STATE_P25,      &CModem::p25Enable,   CLASS_4FSK,  &p25Samples,      STAGE_RX_P25},
+                                                     {STATE_IDLE,     NULL,                 0U,          NULL,             STAGE_COUNT}}},
+  {true,  &CIO::filterNXDN,     STAGE_FIR_NXDN,     {{STATE_NXDN,     &CModem::nxdnEnable,  CLASS_NXDN,  &nxdnSamples,     STAGE_RX_NXDN},
+                                                     {STATE_IDLE,     NULL,                 0U,          NULL,             STAGE_COUNT}}},
+  {false, &CIO::filterRRC,      STAGE_FIR_RRC,      {{STATE_YSF,      &CModem::ysfEnable,   CLASS_4FSK,  &ysfSamples,      STAGE_RX_YSF},
+                                                     {STATE_DMR,      &CModem::dmrEnable,   CLASS_4FSK,  &dmrSamples,      STAGE_RX_DMR}}},
+  {false, &CIO::filterGaussian, STAGE_FIR_GAUSSIAN, {{STATE_DSTARCAL, NULL,                 CLASS_DSTAR, &calDStarSamples, STAGE_RX_CAL},
+                                                     {STATE_IDLE,     NULL,                 0U,          NULL,             STAGE_COUNT}}}
+};
+
+CIO::CIO(CModem& modem) :
+m_modem(modem),
 m_started(false),
 m_rxBuffer(RX_RINGBUFFER_SIZE),
 m_txBuffer(TX_RINGBUFFER_SIZE),
+m_audioStats(RX_RINGBUFFER_SIZE, TX_RINGBUFFER_SIZE),
+#if defined(RX_24KHZ)
+m_decimator(),
+#endif
 m_dcFilter(DC_FILTER_STAGES, DC_FILTER),
-m_rrcFilter(RRC_0_2_FILTER_LEN, RRC_0_2_FILTER, RX_BLOCK_SIZE),
-m_gaussianFilter(GAUSSIAN_0_5_FILTER_LEN, GAUSSIAN_0_5_FILTER, RX_BLOCK_SIZE),
-m_boxcarFilter(BOXCAR_FILTER_LEN, BOXCAR_FILTER, RX_BLOCK_SIZE),
-m_nxdnFilter(NXDN_0_2_FILTER_LEN, NXDN_0_2_FILTER, RX_BLOCK_SIZE),
-m_nxdnISincFilter(NXDN_ISINC_FILTER_LEN, NXDN_ISINC_FILTER, RX_BLOCK_SIZE),
+#if defined(MODE_YSF) || defined(MODE_DMR)
+m_rrcFilter(),
+#endif
+#if defined(MODE_DSTAR)
+m_gaussianFilter(),
+#endif
+#if defined(MODE_P25)
+m_boxcarFilter(),
+#endif
+#if defined(MODE_NXDN)
+m_nxdnFilter(),
+m_nxdnISincFilter(),
+#endif
+m_gate(),
+m_classifier(),
+m_classify(false),
+m_idleModes(CLASS_ALL),
+m_chains(),
+m_chainCount(0U),
+m_chainSinks(),
+m_fanout(NULL),
+m_workers(),
+m_radioPort(RADIO_PORT_SINGLE),
 m_pttInvert(false),
 m_rxLevel(0.5F),
 m_cwIdTXLevel(0.5F),
@@ -111,10 +236,27 @@ m_adcOverflow(0U),
 m_dacOverflow(0U),
 m_watchdog(0U),
 m_lockout(false)
+#if defined(STAGE_STATS)
+,m_rxEpoch(),
+m_rxCaptured(0U),
+m_rxProcessed(0U),
+m_chainBlocks()
+#endif
 {
+#if defined(STAGE_STATS)
+  m_rxEpoch.store(0U, std::memory_order_relaxed);
+  for (uint8_t i = 0U; i < RX_CHAIN_MAX; i++)
+    m_chainBlocks[i].store(0U, std::memory_order_relaxed);
+#endif
+
   initInt();
 }
 
+CIO::~CIO()
+{
+  setParallel(false);
+}
+
 void CIO::start()
 {
   if (m_started)
@@ -127,14 +269,19 @@ void CIO::start()
   setMode();
 }
 
+bool CIO::isStarted() const
+{
+  return m_started;
+}
+
 void CIO::process()
 {
   m_ledCount++;
   if (m_started) {
     // Two seconds timeout
     if (m_watchdog >= 96000U) {
-      if (m_modemState == STATE_DSTAR || m_modemState == STATE_DMR || m_modemState == STATE_YSF || m_modemState == STATE_P25 || m_modemState == STATE_NXDN || m_modemState == STATE_POCSAG) {
-        m_modemState = STATE_IDLE;
+      if (m_modem.modemState == STATE_DSTAR || m_modem.modemState == STATE_DMR || m_modem.modemState == STATE_YSF || m_modem.modemState == STATE_P25 || m_modem.modemState == STATE_NXDN || m_modem.modemState == STATE_POCSAG) {
+        m_modem.modemState = STATE_IDLE;
         setMode();
       }
 
@@ -158,28 +305,50 @@ void CIO::process()
   m_lockout = getCOSInt();
 
   // Switch off the transmitter if needed
-  if (m_txBuffer.getData() == 0U && m_tx) {
-    m_tx = false;
+  if (m_txBuffer.getData() == 0U && m_modem.tx) {
+    m_modem.tx = false;
     setPTTInt(m_pttInvert ? true : false);
   }
 
-  if (m_rxBuffer.getData() >= RX_BLOCK_SIZE) {
-    float samples[RX_BLOCK_SIZE];
+  if (m_rxBuffer.getData() >= (RX_BLOCK_SIZE * RX_DECIMATION)) {
+    STATS_START(blockStart);
 
-    for (uint16_t i = 0U; i < RX_BLOCK_SIZE; i++) {
+    uint64_t captured = 0U;
+    float samples[RX_BLOCK_SIZE * RX_DECIMATION];
+
+    for (uint16_t i = 0U; i < (RX_BLOCK_SIZE * RX_DECIMATION); i++) {
       float sample;
       m_rxBuffer.get(sample);
 
       // Detect ADC overflow
-      if (m_detect && (sample == -1.0F || sample == 1.0F))
+      if (m_detect && (sample == -1.0F || sample == 1.0F)) {
         m_adcOverflow++;
+        m_modem.metrics.addADCOverflow();
+      }
 
       samples[i] = (sample - m_rxDCOffset) * m_rxLevel;
     }
 
+#if defined(STAGE_STATS)
+    // The frames written while this block is processed end with its last sample
+    m_rxProcessed += RX_BLOCK_SIZE * RX_DECIMATION;
+    captured = m_rxEpoch.load(std::memory_order_relaxed) + (m_rxProcessed * 62500U) / 3U;
+    CSerialPort::setCaptureTime(captured);
+
+    const bool sampled = ((m_rxProcessed / (RX_BLOCK_SIZE * RX_DECIMATION)) % STATS_SAMPLE_BLOCKS) == 0U;
+#endif
+
     if (m_lockout)
       return;
 
+#if defined(RX_24KHZ)
+    // Everything from here on runs at the lower rate
+    STATS_SAMPLE_START(decimatorStart, sampled);
+    m_decimator.process(samples, samples, RX_BLOCK_SIZE);
+    STATS_SAMPLE_STOP(m_modem.stats, decimatorStart, STAGE_DECIMATOR);
+#endif
+
+    STATS_SAMPLE_START(dcStart, sampled);
     float dcValues[RX_BLOCK_SIZE];
     m_dcFilter.process(samples, dcValues, RX_BLOCK_SIZE);
 
@@ -191,82 +360,207 @@ void CIO::process()
     float dcSamples[RX_BLOCK_SIZE];
     for (uint8_t i = 0U; i < RX_BLOCK_SIZE; i++)
       dcSamples[i] = samples[i] - offset;
-
-    if (m_modemState == STATE_IDLE) {
-      if (m_dstarEnable) {
-        float GMSKVals[RX_BLOCK_SIZE];
-        m_gaussianFilter.process(dcSamples, GMSKVals, RX_BLOCK_SIZE);
-        dstarRX.samples(GMSKVals, RX_BLOCK_SIZE);
+    STATS_SAMPLE_STOP(m_modem.stats, dcStart, STAGE_DC_FILTER);
+
+    if (m_modem.modemState == STATE_IDLE) {
+      STATS_SAMPLE_START(gateStart, sampled);
+      bool open = m_gate.process(samples, dcSamples, RX_BLOCK_SIZE);
+      STATS_SAMPLE_STOP(m_modem.stats, gateStart, STAGE_GATE);
+
+      if (open) {
+        if (m_classify) {
+          // A pause may be followed by a signal of another class
+          if (m_gate.isQuiet()) {
+            m_classifier.reset();
+            m_idleModes = CLASS_ALL;
+          } else {
+            m_idleModes = m_classifier.process(dcSamples, RX_BLOCK_SIZE);
+          }
+        }
+
+        processIdle(samples, dcSamples, captured);
+      } else if (m_gate.hasReplay()) {
+        // The gate has just opened, once the signal has been classified only the matching receivers are woken
+        if (m_classify)
+          m_classifier.reset();
+
+        // Catch up with the history first
+        while (m_gate.replay(samples, dcSamples, RX_BLOCK_SIZE)) {
+          if (m_classify)
+            m_idleModes = m_classifier.process(dcSamples, RX_BLOCK_SIZE);
+
+          processIdle(samples, dcSamples, captured);
+        }
+      } else {
+        // Every receiver listens for the next signal
+        m_idleModes = CLASS_ALL;
       }
 
-      if (m_p25Enable) {
-        float P25Vals[RX_BLOCK_SIZE];
-        m_boxcarFilter.process(dcSamples, P25Vals, RX_BLOCK_SIZE);
-        p25RX.samples(P25Vals, RX_BLOCK_SIZE);
-      }
+      // With no more to come for now, the workers take what they have rather than wait for a batch
+      if (m_fanout != NULL && (!m_gate.isOpen() || m_rxBuffer.getData() < (RX_BLOCK_SIZE * RX_DECIMATION)))
+        m_fanout->notify(true);
+    } else {
+      processChains(samples, dcSamples, CLASS_ALL);
+    }
 
-      if (m_nxdnEnable) {
-        float NXDNValsTmp[RX_BLOCK_SIZE];
-        m_nxdnFilter.process(dcSamples, NXDNValsTmp, RX_BLOCK_SIZE);
-        float NXDNVals[RX_BLOCK_SIZE];
-        m_nxdnISincFilter.process(NXDNValsTmp, NXDNVals, RX_BLOCK_SIZE);
+    STATS_STOP(m_modem.stats, blockStart, STAGE_RX_BLOCK);
+  }
+}
 
-        nxdnRX.samples(NXDNVals, RX_BLOCK_SIZE);
-      }
+void CIO::processIdle(const float* samples, const float* dcSamples, uint64_t captured)
+{
+  if (m_fanout != NULL) {
+    // The workers keep up easily, a full ring only happens if one is starved of CPU
+    while (!m_fanout->put(samples, dcSamples, m_idleModes, captured)) {
+      if (!m_fanout->waitForSpace())
+        return;
+    }
+    return;
+  }
 
-      if (m_dmrEnable || m_ysfEnable) {
-        float RRCVals[RX_BLOCK_SIZE];
-        m_rrcFilter.process(samples, RRCVals, RX_BLOCK_SIZE);
+  processChains(samples, dcSamples, m_idleModes);
+}
 
-        if (m_ysfEnable)
-          ysfRX.samples(RRCVals, RX_BLOCK_SIZE);
+void CIO::processChains(const float* samples, const float* dcSamples, uint8_t modes)
+{
+  for (uint8_t i = 0U; i < m_chainCount; i++)
+    processChain(RX_CHAIN(m_chains[i]), samples, dcSamples, modes);
+}
 
-        if (m_dmrEnable)
-          dmrDMORX.samples(RRCVals, RX_BLOCK_SIZE);
-      }
-    } else if (m_modemState == STATE_DSTAR) {
-      if (m_dstarEnable) {
-        float GMSKVals[RX_BLOCK_SIZE];
-        m_gaussianFilter.process(dcSamples, GMSKVals, RX_BLOCK_SIZE);
-        dstarRX.samples(GMSKVals, RX_BLOCK_SIZE);
-      }
-    } else if (m_modemState == STATE_DMR) {
-      if (m_dmrEnable) {
-        float DMRVals[RX_BLOCK_SIZE];
-        m_rrcFilter.process(samples, DMRVals, RX_BLOCK_SIZE);
+void CIO::processChain(RX_CHAIN chain, const float* samples, const float* dcSamples, uint8_t modes)
+{
+  const RXChainDef& def = RX_CHAINS[chain];
 
-        dmrDMORX.samples(DMRVals, RX_BLOCK_SIZE);
-      }
-    } else if (m_modemState == STATE_YSF) {
-      if (m_ysfEnable) {
-        float YSFVals[RX_BLOCK_SIZE];
-        m_rrcFilter.process(dcSamples, YSFVals, RX_BLOCK_SIZE);
-        ysfRX.samples(YSFVals, RX_BLOCK_SIZE);
-      }
-    } else if (m_modemState == STATE_P25) {
-      if (m_p25Enable) {
-        float P25Vals[RX_BLOCK_SIZE];
-        m_boxcarFilter.process(dcSamples, P25Vals, RX_BLOCK_SIZE);
-        p25RX.samples(P25Vals, RX_BLOCK_SIZE);
-      }
-    } else if (m_modemState == STATE_NXDN) {
-      if (m_nxdnEnable) {
-        float NXDNValsTmp[RX_BLOCK_SIZE];
-        m_nxdnFilter.process(dcSamples, NXDNValsTmp, RX_BLOCK_SIZE);
-        float NXDNVals[RX_BLOCK_SIZE];
-        m_nxdnISincFilter.process(NXDNValsTmp, NXDNVals, RX_BLOCK_SIZE);
-
-        nxdnRX.samples(NXDNVals, RX_BLOCK_SIZE);
-      }
-    } else if (m_modemState == STATE_DSTARCAL) {
-      float GMSKVals[RX_BLOCK_SIZE];
-      m_gaussianFilter.process(samples, GMSKVals, RX_BLOCK_SIZE);
+  // Only filter if a receiver on the chain is listening for this kind of signal
+  uint8_t sinks = 0U;
+  for (uint8_t i = 0U; i < RX_CHAIN_SINKS; i++) {
+    if ((m_chainSinks[chain] & (1U << i)) != 0U && (def.sinks[i].classes & modes) != 0U)
+      sinks |= 1U << i;
+  }
+
+  if (sinks == 0U)
+    return;
+
+#if defined(STAGE_STATS)
+  // A chain may be run by the main thread or by its worker
+  const bool sampled = (m_chainBlocks[chain].fetch_add(1U, std::memory_order_relaxed) % STATS_SAMPLE_BLOCKS) == 0U;
+#endif
+
+  STATS_SAMPLE_START(filterStart, sampled);
+  float values[RX_BLOCK_SIZE];
+  (this->*def.filter)(def.dcRemoved ? dcSamples : samples, values);
+  STATS_SAMPLE_STOP(m_modem.stats, filterStart, def.stage);
+
+  for (uint8_t i = 0U; i < RX_CHAIN_SINKS; i++) {
+    if ((sinks & (1U << i)) != 0U) {
+      STATS_SAMPLE_START(sinkStart, sampled);
+      def.sinks[i].samples(m_modem, values, RX_BLOCK_SIZE);
+      STATS_SAMPLE_STOP(m_modem.stats, sinkStart, def.sinks[i].stage);
+    }
+  }
+}
+
+void CIO::buildChains()
+{
+  m_chainCount = 0U;
+
+  for (uint8_t i = 0U; i < RX_CHAIN_MAX; i++) {
+    const RXChainDef& def = RX_CHAINS[i];
+
+    m_chainSinks[i] = 0U;
 
-      calDStarRX.samples(GMSKVals, RX_BLOCK_SIZE);
+    for (uint8_t j = 0U; j < RX_CHAIN_SINKS; j++) {
+      const RXSinkDef& sink = def.sinks[j];
+      if (sink.samples == NULL)
+        continue;
+
+      bool enabled = sink.enable == NULL || m_modem.*sink.enable;
+
+      if (m_modem.modemState == sink.mode && enabled)
+        m_chainSinks[i] |= 1U << j;
+      else if (m_modem.modemState == STATE_IDLE && sink.enable != NULL && enabled)
+        m_chainSinks[i] |= 1U << j;
     }
+
+    if (m_chainSinks[i] != 0U)
+      m_chains[m_chainCount++] = i;
   }
 }
 
+void CIO::filterGaussian(const float* input, float* output)
+{
+#if defined(MODE_DSTAR)
+  m_gaussianFilter.process(input, output, RX_BLOCK_SIZE);
+#endif
+}
+
+void CIO::filterBoxcar(const float* input, float* output)
+{
+#if defined(MODE_P25)
+  m_boxcarFilter.process(input, output, RX_BLOCK_SIZE);
+#endif
+}
+
+void CIO::filterNXDN(const float* input, float* output)
+{
+#if defined(MODE_NXDN)
+  float values[RX_BLOCK_SIZE];
+  m_nxdnFilter.process(input, values, RX_BLOCK_SIZE);
+  m_nxdnISincFilter.process(values, output, RX_BLOCK_SIZE);
+#endif
+}
+
+void CIO::filterRRC(const float* input, float* output)
+{
+#if defined(MODE_YSF) || defined(MODE_DMR)
+  m_rrcFilter.process(input, output, RX_BLOCK_SIZE);
+#endif
+}
+
+void CIO::setParallel(bool enabled)
+{
+  if (enabled && m_fanout == NULL) {
+    m_fanout = new CFanoutRB(FANOUT_LENGTH, RX_CHAIN_COUNT);
+
+    for (uint8_t i = 0U; i < RX_CHAIN_COUNT; i++) {
+      m_workers[i] = new CRXWorker(*this, *m_fanout, RX_CHAIN(i));
+      m_modem.serial.addOutbound(&m_workers[i]->getOutbound());
+      m_workers[i]->run();
+    }
+  } else if (!enabled && m_fanout != NULL) {
+    // The workers finish what they have been given before they are stopped
+    m_fanout->waitForEmpty();
+    m_fanout->stop();
+
+    for (uint8_t i = 0U; i < RX_CHAIN_COUNT; i++)
+      m_workers[i]->wait();
+
+    // The frames they queued go out before their queues are freed
+    m_modem.serial.clearOutbound();
+
+    for (uint8_t i = 0U; i < RX_CHAIN_COUNT; i++) {
+      delete m_workers[i];
+      m_workers[i] = NULL;
+    }
+
+    delete m_fanout;
+    m_fanout = NULL;
+  }
+}
+
+void CIO::setRadioPort(RADIO_PORT port)
+{
+  m_radioPort = port;
+}
+
+void CIO::flush()
+{
+  if (m_fanout == NULL)
+    return;
+
+  m_fanout->waitForEmpty();
+}
+
 void CIO::write(MMDVM_STATE mode, float* samples, uint16_t length)
 {
   if (!m_started)
@@ -276,45 +570,65 @@ void CIO::write(MMDVM_STATE mode, float* samples, uint16_t length)
     return;
 
   // Switch the transmitter on if needed
-  if (!m_tx) {
-    m_tx = true;
+  if (!m_modem.tx) {
+    m_modem.tx = true;
     setPTTInt(m_pttInvert ? false : true);
+    m_modem.metrics.addKeyUp();
   }
 
   float txLevel = 0.0F;
+  TX_MODE txMode = TX_MODE_OTHER;
   switch (mode) {
     case STATE_DSTAR:
       txLevel = m_dstarTXLevel;
+      txMode  = TX_MODE_DSTAR;
       break;
     case STATE_DMR:
       txLevel = m_dmrTXLevel;
+      txMode  = TX_MODE_DMR;
       break;
     case STATE_YSF:
       txLevel = m_ysfTXLevel;
+      txMode  = TX_MODE_YSF;
       break;
     case STATE_P25:
       txLevel = m_p25TXLevel;
+      txMode  = TX_MODE_P25;
       break;
     case STATE_NXDN:
       txLevel = m_nxdnTXLevel;
+      txMode  = TX_MODE_NXDN;
       break;
     case STATE_POCSAG:
       txLevel = m_pocsagTXLevel;
+      txMode  = TX_MODE_POCSAG;
       break;
     default:
       txLevel = m_cwIdTXLevel;
       break;
   }
 
+
+  uint32_t dropped = 0U;
   for (uint16_t i = 0U; i < length; i++) {
     float res = (samples[i] * txLevel) + m_txDCOffset;
 
     // Detect DAC overflow
-    if (res >= 1.0F || res <= -1.0F)
+    if (res >= 1.0F || res <= -1.0F) {
       m_dacOverflow++;
+      m_modem.metrics.addDACOverflow();
+    }
 
-    m_txBuffer.put(res);
+    if (!m_txBuffer.put(res))
+      dropped++;
   }
+
+  if (dropped > 0U)
+    m_audioStats.addEvent(AUDIO_TX_OVERFLOW, dropped);
+
+  m_modem.metrics.addTX(txMode, length - dropped);
+
+  m_audioStats.setTXLevel(m_txBuffer.getData());
 }
 
 uint16_t CIO::getSpace() const
@@ -324,10 +638,10 @@ uint16_t CIO::getSpace() const
 
 void CIO::setDecode(bool dcd)
 {
-  if (dcd != m_dcd)
+  if (dcd != m_modem.dcd)
     setCOSInt(dcd ? true : false);
 
-  m_dcd = dcd;
+  m_modem.dcd = dcd;
 }
 
 void CIO::setADCDetection(bool detect)
@@ -337,6 +651,31 @@ void CIO::setADCDetection(bool detect)
 
 void CIO::setMode()
 {
+  // Start listening afresh whenever the mode changes
+  m_gate.reset();
+  m_classifier.reset();
+
+  m_idleModes = CLASS_ALL;
+
+  buildChains();
+}
+
+void CIO::setGate(bool enabled)
+{
+  m_gate.setEnabled(enabled);
+}
+
+void CIO::setClassifier(bool enabled)
+{
+  m_classify  = enabled;
+  m_idleModes = CLASS_ALL;
+
+  m_classifier.reset();
+}
+
+const CActivityGate& CIO::getGate() const
+{
+  return m_gate;
 }
 
 void CIO::setParameters(bool rxInvert, bool txInvert, bool pttInvert, float rxLevel, float cwIdTXLevel, float dstarTXLevel, float dmrTXLevel, float ysfTXLevel, float p25TXLevel, float nxdnTXLevel, float pocsagTXLevel, float txDCOffset, float rxDCOffset)
@@ -404,13 +743,57 @@ bool CIO::hasLockout() const
 
 void CIO::readCallback(const float* input, unsigned int nSamples)
 {
-  for (unsigned int i = 0U; i < nSamples; i++)
-    m_rxBuffer.put(input[i]);
+  STATS_START(start);
+
+  uint32_t dropped = 0U;
+  for (unsigned int i = 0U; i < nSamples; i++) {
+    if (!m_rxBuffer.put(input[i]))
+      dropped++;
+  }
+
+  if (dropped > 0U)
+    m_audioStats.addEvent(AUDIO_RX_OVERFLOW, dropped);
+
+  m_audioStats.setRXLevel(m_rxBuffer.getData());
+
+#if defined(STAGE_STATS)
+  // The block has only just been captured, which dates every sample before it at 48kHz
+  m_rxCaptured += nSamples - dropped;
+  m_rxEpoch.store(start - (m_rxCaptured * 62500U) / 3U, std::memory_order_relaxed);
+#endif
+
+  STATS_STOP(m_modem.stats, start, STAGE_AUDIO_READ);
 }
 
 void CIO::writeCallback(float* output, int& nSamples)
 {
-  for (int i = 0U; i < nSamples; i++)
-    m_txBuffer.get(output[i]);
+  STATS_START(start);
+
+  uint32_t missing = 0U;
+  for (int i = 0U; i < nSamples; i++) {
+    if (!m_txBuffer.get(output[i]))
+      missing++;
+  }
+
+  // An empty ring only matters while transmitting
+  if (missing > 0U && m_modem.tx)
+    m_audioStats.addEvent(AUDIO_TX_UNDERRUN, missing);
+
+  STATS_STOP(m_modem.stats, start, STAGE_AUDIO_WRITE);
+}
+
+void CIO::xrunCallback(bool capture)
+{
+  m_audioStats.addEvent(capture ? AUDIO_CAPTURE_XRUN : AUDIO_PLAYBACK_XRUN, 0U);
+}
+
+const CAudioStats& CIO::getAudioStats() const
+{
+  return m_audioStats;
+}
+
+void CIO::logAudioStats(const std::string& name)
+{
+  m_audioStats.log(name);
 }
 
@@ -20,16 +20,34 @@
 #define  IO_H
 
 #include "AudioCallback.h"
+#include "AudioStats.h"
 #include "Globals.h"
 #include "SampleRB.h"
+#include "ActivityGate.h"
+#include "ModeClassifier.h"
+#include "RXWorker.h"
 #include "Biquad.h"
 #include "FIR.h"
+#include "FIRDecimator.h"
+#include "StageStats.h"
+#include "Modes.h"
+
+class CModem;
+
+// Which channel of the sound card a CIO uses, and so which radio port on a UDRC
+enum RADIO_PORT {
+  RADIO_PORT_SINGLE,    // The only modem on the sound card
+  RADIO_PORT_LEFT,
+  RADIO_PORT_RIGHT
+};
 
 class CIO : public IAudioCallback {
 public:
-  CIO();
+  CIO(CModem& modem);
+  ~CIO();
 
   void start();
+  bool isStarted() const;
 
   void process();
 
@@ -41,6 +59,18 @@ public:
   void setADCDetection(bool detect);
   void setMode();
 
+  void setGate(bool enabled);
+  void setClassifier(bool enabled);
+
+  // Runs the IDLE receive chains on worker threads, turning it off stops them.
+  // Only from the thread that calls process().
+  void setParallel(bool enabled);
+
+  void setRadioPort(RADIO_PORT port);
+  void processChain(RX_CHAIN chain, const float* samples, const float* dcSamples, uint8_t modes);
+  void flush();
+  const CActivityGate& getGate() const;
+
   void interrupt();
 
   void setParameters(bool rxInvert, bool txInvert, bool pttInvert, float rxLevel, float cwIdTXLevel, float dstarTXLevel, float dmrTXLevel, float ysfTXLevel, float p25TXLevel, float nxdnTXLevel, float pocsagTXLevel, float txDCOffset, float rxDCOffset);
@@ -55,22 +85,101 @@ public:
   void resetWatchdog();
   uint32_t getWatchdog();
 
+  const CAudioStats& getAudioStats() const;
+  void logAudioStats(const std::string& name);
+
   virtual void readCallback(const float* input, unsigned int nSamples);
   virtual void writeCallback(float* output, int& nSamples);
+  virtual void xrunCallback(bool capture);
 
 private:
+  // The offline benchmark times each stage of the receive chains on its own
+  friend class CBench;
+
+  static const uint8_t RX_CHAIN_SINKS = 2U;
+
+  // A receiver fed by a chain, it runs in its own mode and, if it has an enable, in IDLE
+  struct RXSinkDef {
+    MMDVM_STATE mode;
+    bool CModem::* enable;
+    uint8_t     classes;
+    void      (*samples)(CModem& modem, const float* samples, uint8_t length);
+    STATS_STAGE stage;
+  };
+
+  // A filter and the receivers that share its output
+  struct RXChainDef {
+    bool        dcRemoved;
+    void (CIO::*filter)(const float* input, float* output);
+    STATS_STAGE stage;
+    RXSinkDef   sinks[RX_CHAIN_SINKS];
+  };
+
+  // The receive chains, defined in IO.cpp
+  static const RXChainDef RX_CHAINS[RX_CHAIN_MAX];
+
+  // The receive filters, defined in IO.cpp
+#if defined(RX_24KHZ)
+  static const uint16_t DECIMATION_FILTER_LEN   = 20U;
+  static const uint16_t RRC_0_2_FILTER_LEN      = 42U;
+  static const uint16_t NXDN_0_2_FILTER_LEN     = 82U;
+  static const uint16_t NXDN_ISINC_FILTER_LEN   = 16U;
+  static const uint16_t GAUSSIAN_0_5_FILTER_LEN = 12U;
+  static const uint16_t BOXCAR_FILTER_LEN       = 6U;
+
+  static const float DECIMATION_FILTER[];
+#else
+  static const uint16_t RRC_0_2_FILTER_LEN      = 82U;
+  static const uint16_t NXDN_0_2_FILTER_LEN     = 162U;
+  static const uint16_t NXDN_ISINC_FILTER_LEN   = 32U;
+  static const uint16_t GAUSSIAN_0_5_FILTER_LEN = 24U;
+  static const uint16_t BOXCAR_FILTER_LEN       = 12U;
+#endif
+
+  static const float RRC_0_2_FILTER[];
+  static const float NXDN_0_2_FILTER[];
+  static const float NXDN_ISINC_FILTER[];
+  static const float GAUSSIAN_0_5_FILTER[];
+  static const float BOXCAR_FILTER[];
+
+  CModem&              m_modem;
   bool                 m_started;
   CSampleRB            m_rxBuffer;
   CSampleRB            m_txBuffer;
+  CAudioStats          m_audioStats;
 
+#if defined(RX_24KHZ)
+  CStaticFIRDecimator<RX_DECIMATION, DECIMATION_FILTER_LEN, DECIMATION_FILTER, RX_BLOCK_SIZE> m_decimator;
+#endif
   CBiquad              m_dcFilter;
 
-  CFIR                 m_rrcFilter;
-  CFIR                 m_gaussianFilter;
-  CFIR                 m_boxcarFilter;
-  CFIR                 m_nxdnFilter;
-  CFIR                 m_nxdnISincFilter;
+#if defined(MODE_YSF) || defined(MODE_DMR)
+  CStaticFIR<RRC_0_2_FILTER_LEN, RRC_0_2_FILTER, RX_BLOCK_SIZE>           m_rrcFilter;
+#endif
+#if defined(MODE_DSTAR)
+  CStaticFIR<GAUSSIAN_0_5_FILTER_LEN, GAUSSIAN_0_5_FILTER, RX_BLOCK_SIZE> m_gaussianFilter;
+#endif
+#if defined(MODE_P25)
+  CStaticFIR<BOXCAR_FILTER_LEN, BOXCAR_FILTER, RX_BLOCK_SIZE>             m_boxcarFilter;
+#endif
+#if defined(MODE_NXDN)
+  CStaticFIR<NXDN_0_2_FILTER_LEN, NXDN_0_2_FILTER, RX_BLOCK_SIZE>         m_nxdnFilter;
+  CStaticFIR<NXDN_ISINC_FILTER_LEN, NXDN_ISINC_FILTER, RX_BLOCK_SIZE>     m_nxdnISincFilter;
+#endif
+
+  CActivityGate        m_gate;
+  CModeClassifier      m_classifier;
+  bool                 m_classify;
+  uint8_t              m_idleModes;
+
+  uint8_t              m_chains[RX_CHAIN_MAX];
+  uint8_t              m_chainCount;
+  uint8_t              m_chainSinks[RX_CHAIN_MAX];
 
+  CFanoutRB*           m_fanout;
+  CRXWorker*           m_workers[RX_CHAIN_COUNT];
+
+  RADIO_PORT           m_radioPort;
   bool                 m_pttInvert;
   float                m_rxLevel;
   float                m_cwIdTXLevel;
@@ -96,6 +205,22 @@ private:
 
   bool                 m_lockout;
 
+#if defined(STAGE_STATS)
+  std::atomic<uint64_t> m_rxEpoch;        // When sample zero would have been captured, in ns
+  uint64_t             m_rxCaptured;      // Samples put in the receive ring
+  uint64_t             m_rxProcessed;     // Samples taken from it
+  std::atomic<uint32_t> m_chainBlocks[RX_CHAIN_MAX]; // Blocks filtered, to pick the timed ones
+#endif
+
+  void processIdle(const float* samples, const float* dcSamples, uint64_t captured);
+  void processChains(const float* samples, const float* dcSamples, uint8_t modes);
+  void buildChains();
+
+  void filterGaussian(const float* input, float* output);
+  void filterBoxcar(const float* input, float* output);
+  void filterNXDN(const float* input, float* output);
+  void filterRRC(const float* input, float* output);
+
   // Hardware specific routines
   void initInt();
   void startInt();
@@ -43,13 +43,12 @@ void CIO::initInt()
 
 void CIO::startInt()
 {
-  if (m_pttInvert) {
-    digitalWrite(DUPLEX_PTT_PIN,  LOW);
-    digitalWrite(SIMPLEX_PTT_PIN, LOW);
-  } else {
-    digitalWrite(DUPLEX_PTT_PIN,  HIGH);
-    digitalWrite(SIMPLEX_PTT_PIN, HIGH);
-  }
+  // With a modem on each port, each only drives its own PTT line
+  if (m_radioPort != RADIO_PORT_RIGHT)
+    digitalWrite(DUPLEX_PTT_PIN,  m_pttInvert ? LOW : HIGH);
+
+  if (m_radioPort != RADIO_PORT_LEFT)
+    digitalWrite(SIMPLEX_PTT_PIN, m_pttInvert ? LOW : HIGH);
 }
 
 bool CIO::getCOSInt()
@@ -64,17 +63,18 @@ void CIO::setLEDInt(bool on)
 
 void CIO::setPTTInt(bool on)
 {
-  if (m_pttInvert) {
-    if (m_duplex)
-      digitalWrite(DUPLEX_PTT_PIN, on ? HIGH : LOW);
-    else
-      digitalWrite(SIMPLEX_PTT_PIN, on ? HIGH : LOW);
-  } else {
-    if (m_duplex)
-      digitalWrite(DUPLEX_PTT_PIN, on ? LOW : HIGH);
-    else
-      digitalWrite(SIMPLEX_PTT_PIN, on ? LOW : HIGH);
-  }
+  int pin;
+  if (m_radioPort == RADIO_PORT_LEFT)
+    pin = DUPLEX_PTT_PIN;
+  else if (m_radioPort == RADIO_PORT_RIGHT)
+    pin = SIMPLEX_PTT_PIN;
+  else
+    pin = m_modem.duplex ? DUPLEX_PTT_PIN : SIMPLEX_PTT_PIN;
+
+  if (m_pttInvert)
+    digitalWrite(pin, on ? HIGH : LOW);
+  else
+    digitalWrite(pin, on ? LOW : HIGH);
 }
 
 void CIO::setCOSInt(bool on)
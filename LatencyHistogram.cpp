@@ -0,0 +1,103 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "LatencyHistogram.h"
+
+// The bucket of a value and the lowest value in a bucket
+static unsigned int getBucket(uint32_t us, unsigned int subBuckets)
+{
+  if (us < subBuckets)
+    return us;
+
+  unsigned int shift = 0U;
+  while ((us >> shift) >= 2U * subBuckets)
+    shift++;
+
+  return shift * subBuckets + (us >> shift);
+}
+
+static uint64_t getLowest(unsigned int bucket, unsigned int subBuckets)
+{
+  if (bucket < subBuckets)
+    return bucket;
+
+  unsigned int shift = bucket / subBuckets - 1U;
+
+  return uint64_t(bucket % subBuckets + subBuckets) << shift;
+}
+
+CLatencyHistogram::CLatencyHistogram() :
+m_buckets(),
+m_count(),
+m_max()
+{
+  for (unsigned int i = 0U; i < BUCKETS; i++)
+    m_buckets[i].store(0U, std::memory_order_relaxed);
+
+  m_count.store(0U, std::memory_order_relaxed);
+  m_max.store(0U, std::memory_order_relaxed);
+}
+
+void CLatencyHistogram::add(uint64_t ns)
+{
+  uint64_t us = ns / 1000U;
+  if (us > 0xFFFFFFFFU)
+    us = 0xFFFFFFFFU;
+
+  m_buckets[getBucket(uint32_t(us), SUB_BUCKETS)].fetch_add(1U, std::memory_order_relaxed);
+  m_count.fetch_add(1U, std::memory_order_relaxed);
+
+  uint32_t max = m_max.load(std::memory_order_relaxed);
+  while (us > max && !m_max.compare_exchange_weak(max, uint32_t(us), std::memory_order_relaxed))
+    ;
+}
+
+// The highest value in the bucket holding the percentile, but never more than the largest seen
+uint32_t CLatencyHistogram::getPercentile(unsigned int percent) const
+{
+  uint64_t count = m_count.load(std::memory_order_relaxed);
+  if (count == 0U)
+    return 0U;
+
+  uint64_t wanted = (count * percent + 99U) / 100U;
+  if (wanted == 0U)
+    wanted = 1U;
+
+  uint32_t max = getMax();
+
+  uint64_t total = 0U;
+  for (unsigned int i = 0U; i < BUCKETS; i++) {
+    total += m_buckets[i].load(std::memory_order_relaxed);
+    if (total >= wanted) {
+      uint64_t highest = getLowest(i + 1U, SUB_BUCKETS) - 1U;
+      return highest < max ? uint32_t(highest) : max;
+    }
+  }
+
+  return max;
+}
+
+uint32_t CLatencyHistogram::getMax() const
+{
+  return m_max.load(std::memory_order_relaxed);
+}
+
+uint64_t CLatencyHistogram::getCount() const
+{
+  return m_count.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,48 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(LATENCYHISTOGRAM_H)
+#define  LATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+// Log-linear buckets in microseconds, eight to each power of two so that any
+// percentile is within 12.5% of the true value. Any thread may add to it.
+class CLatencyHistogram {
+public:
+  CLatencyHistogram();
+
+  void add(uint64_t ns);
+
+  // In microseconds
+  uint32_t getPercentile(unsigned int percent) const;
+  uint32_t getMax() const;
+
+  uint64_t getCount() const;
+
+private:
+  static const unsigned int SUB_BUCKETS = 8U;
+  static const unsigned int BUCKETS     = 240U;   // Up to 2^32 us
+
+  std::atomic<uint32_t> m_buckets[BUCKETS];
+  std::atomic<uint64_t> m_count;
+  std::atomic<uint32_t> m_max;
+};
+
+#endif
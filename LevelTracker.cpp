@@ -0,0 +1,140 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "LevelTracker.h"
+
+#include <cstddef>
+
+const uint8_t NOPTR = 99U;
+
+CLevelTracker::CLevelTracker(uint8_t length) :
+m_length(length),
+m_centre(NULL),
+m_threshold(NULL),
+m_ptr(NOPTR),
+m_centreSum(0.0F),
+m_thresholdSum(0.0F),
+m_maxPos(-1.0F),
+m_minPos(1.0F),
+m_maxNeg(1.0F),
+m_minNeg(-1.0F),
+m_posThresh(0.0F),
+m_negThresh(0.0F)
+{
+  m_centre    = new float[length];
+  m_threshold = new float[length];
+}
+
+CLevelTracker::~CLevelTracker()
+{
+  delete[] m_centre;
+  delete[] m_threshold;
+}
+
+void CLevelTracker::reset()
+{
+  m_ptr = NOPTR;
+}
+
+bool CLevelTracker::isValid() const
+{
+  return m_ptr != NOPTR;
+}
+
+void CLevelTracker::resetFrame()
+{
+  m_maxPos = -1.0F;
+  m_minPos =  1.0F;
+  m_maxNeg =  1.0F;
+  m_minNeg = -1.0F;
+}
+
+void CLevelTracker::sample(float sample)
+{
+  if (sample > 0.0F) {
+    if (sample > m_maxPos)
+      m_maxPos = sample;
+    if (sample < m_minPos)
+      m_minPos = sample;
+  } else {
+    if (sample < m_maxNeg)
+      m_maxNeg = sample;
+    if (sample > m_minNeg)
+      m_minNeg = sample;
+  }
+}
+
+void CLevelTracker::update(float& centre, float& threshold)
+{
+  m_posThresh = (m_maxPos + m_minPos) / 2.0F;
+  m_negThresh = (m_maxNeg + m_minNeg) / 2.0F;
+
+  float frameCentre = (m_posThresh + m_negThresh) / 2.0F;
+
+  add(frameCentre, m_posThresh - frameCentre);
+
+  getLevels(centre, threshold);
+}
+
+void CLevelTracker::add(float centre, float threshold)
+{
+  if (m_ptr == NOPTR) {
+    for (uint8_t i = 0U; i < m_length; i++) {
+      m_centre[i]    = centre;
+      m_threshold[i] = threshold;
+    }
+
+    m_centreSum    = centre * float(m_length);
+    m_thresholdSum = threshold * float(m_length);
+
+    m_ptr = 0U;
+    return;
+  }
+
+  m_centreSum    += centre - m_centre[m_ptr];
+  m_thresholdSum += threshold - m_threshold[m_ptr];
+
+  m_centre[m_ptr]    = centre;
+  m_threshold[m_ptr] = threshold;
+
+  m_ptr++;
+  if (m_ptr >= m_length) {
+    m_ptr = 0U;
+
+    // Re-sum once per lap so that rounding errors cannot build up over a long transmission
+    m_centreSum    = 0.0F;
+    m_thresholdSum = 0.0F;
+
+    for (uint8_t i = 0U; i < m_length; i++) {
+      m_centreSum    += m_centre[i];
+      m_thresholdSum += m_threshold[i];
+    }
+  }
+}
+
+void CLevelTracker::getLevels(float& centre, float& threshold) const
+{
+  centre    = m_centreSum / float(m_length);
+  threshold = m_thresholdSum / float(m_length);
+}
+
+void CLevelTracker::getThresholds(float& pos, float& neg) const
+{
+  pos = m_posThresh;
+  neg = m_negThresh;
+}
@@ -0,0 +1,65 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(LEVELTRACKER_H)
+#define  LEVELTRACKER_H
+
+#include <cstdint>
+
+// Running 4FSK slicing levels, the extrema are gathered as the symbols are sliced
+class CLevelTracker {
+public:
+  CLevelTracker(uint8_t length);
+  ~CLevelTracker();
+
+  // Forget the history, the next levels will fill it
+  void reset();
+  bool isValid() const;
+
+  // Start gathering the extrema of a new frame
+  void resetFrame();
+
+  void sample(float sample);
+
+  // Adds the levels of the frame so far to the history and returns the averages
+  void update(float& centre, float& threshold);
+
+  // Adds levels found elsewhere, such as from a sync, to the history
+  void add(float centre, float threshold);
+
+  void getLevels(float& centre, float& threshold) const;
+
+  // The outer symbol thresholds of the last frame, for debugging
+  void getThresholds(float& pos, float& neg) const;
+
+private:
+  uint8_t m_length;
+  float*  m_centre;
+  float*  m_threshold;
+  uint8_t m_ptr;
+  float   m_centreSum;
+  float   m_thresholdSum;
+  float   m_maxPos;
+  float   m_minPos;
+  float   m_maxNeg;
+  float   m_minNeg;
+  float   m_posThresh;
+  float   m_negThresh;
+};
+
+#endif
@@ -19,98 +19,89 @@
  */
 
 #include "SoundCardReaderWriter.h"
+#include "SoundFileReaderWriter.h"
+#include "AudioHub.h"
+#include "DebugWriter.h"
+#include "MetricsServer.h"
+#include "StageTrace.h"
 #include "Globals.h"
 #include "Thread.h"
 
 #include <sys/types.h>
+#include <signal.h>
 #include <pwd.h>
+#include <unistd.h>
 
-// Global variables
-MMDVM_STATE m_modemState = STATE_IDLE;
+#include <vector>
 
-bool m_dstarEnable  = true;
-bool m_dmrEnable    = true;
-bool m_ysfEnable    = true;
-bool m_p25Enable    = true;
-bool m_nxdnEnable   = true;
-bool m_pocsagEnable = true;
+// The most recent timed calls kept for -trace, about 1.5MB
+const unsigned int TRACE_LENGTH = 65536U;
 
-bool m_duplex = true;
+static volatile sig_atomic_t s_traceDump = 0;
+static volatile sig_atomic_t s_exit = 0;
 
-bool m_tx  = false;
-bool m_dcd = false;
-
-CDStarRX   dstarRX;
-CDStarTX   dstarTX;
-
-CDMRDMORX  dmrDMORX;
-CDMRDMOTX  dmrDMOTX;
-
-CYSFRX     ysfRX;
-CYSFTX     ysfTX;
-
-CP25RX     p25RX;
-CP25TX     p25TX;
-
-CNXDNRX    nxdnRX;
-CNXDNTX    nxdnTX;
-
-CPOCSAGTX  pocsagTX;
-
-CCalDStarRX calDStarRX;
-CCalDStarTX calDStarTX;
-CCalDMR     calDMR;
-CCalP25     calP25;
-CCalNXDN    calNXDN;
-CCalPOCSAG  calPOCSAG;
-
-CCWIdTX cwIdTX;
-
-CSerialPort serial;
-CIO io;
-
-void loop()
+static void handleSignal(int signum)
 {
-  serial.process();
-
-  io.process();
-
-  // The following is for transmitting
-  if (m_dstarEnable && m_modemState == STATE_DSTAR)
-    dstarTX.process();
-
-  if (m_dmrEnable && m_modemState == STATE_DMR)
-    dmrDMOTX.process();
-
-  if (m_ysfEnable && m_modemState == STATE_YSF)
-    ysfTX.process();
-
-  if (m_p25Enable && m_modemState == STATE_P25)
-    p25TX.process();
-
-  if (m_nxdnEnable && m_modemState == STATE_NXDN)
-    nxdnTX.process();
+  if (signum == SIGUSR1)
+    s_traceDump = 1;
+  else
+    s_exit = 1;
+}
 
-  if (m_pocsagEnable && (m_modemState == STATE_POCSAG || pocsagTX.busy()))
-    pocsagTX.process();
+static void writeTrace(const CStageTrace& trace, const std::string& fileName)
+{
+  if (trace.writeFile(fileName))
+    ::fprintf(stderr, "Wrote the trace to %s\n", fileName.c_str());
+  else
+    ::fprintf(stderr, "Unable to write the trace to %s\n", fileName.c_str());
+}
 
-  if (m_modemState == STATE_DSTARCAL)
-    calDStarTX.process();
+// A "file:<input>[,<output wav>]" audio device, or NULL for anything else
+static CSoundFileReaderWriter* createFile(const std::string& audioDev)
+{
+  if (audioDev.compare(0U, 5U, "file:") != 0)
+    return NULL;
+
+  std::string::size_type pos = audioDev.find(',');
+  if (pos == std::string::npos)
+    return new CSoundFileReaderWriter(audioDev.substr(5U), "", 48000U, RX_BLOCK_SIZE * RX_DECIMATION);
+  else
+    return new CSoundFileReaderWriter(audioDev.substr(5U, pos - 5U), audioDev.substr(pos + 1U), 48000U, RX_BLOCK_SIZE * RX_DECIMATION);
+}
 
-  if (m_modemState == STATE_DMRCAL || m_modemState == STATE_LFCAL || m_modemState == STATE_DMRDMO1K)
-    calDMR.process();
+// A sound card, a file or "hub:<name>:<channel>", the right callback is only for a shared stereo device
+static bool openAudio(const std::string& audioDev, IAudioCallback* leftCallback, IAudioCallback* rightCallback)
+{
+  CSoundFileReaderWriter* file = createFile(audioDev);
+  if (file != NULL) {
+    if (rightCallback == NULL)
+      file->setCallback(leftCallback);
+    else
+      file->setCallback(leftCallback, rightCallback);
+
+    return file->open();
+  } else if (audioDev.compare(0U, 4U, "hub:") == 0) {
+    std::string::size_type pos = audioDev.rfind(':');
+    unsigned int channel = ::atoi(audioDev.c_str() + pos + 1U);
+    if (pos == 3U || channel >= HUB_CHANNELS) {
+      ::fprintf(stderr, "The audio hub is given as hub:<name>:<0|1>\n");
+      return false;
+    }
 
-  if (m_modemState == STATE_P25CAL1K)
-    calP25.process();
+    CAudioHubClient* client = new CAudioHubClient(audioDev.substr(4U, pos - 4U), channel);
+    client->setCallback(leftCallback);
 
-  if (m_modemState == STATE_NXDNCAL1K)
-    calNXDN.process();
+    return client->open();
+  } else {
+    CSoundCardReaderWriter* sound = new CSoundCardReaderWriter(audioDev, audioDev, 48000U, RX_BLOCK_SIZE * RX_DECIMATION);
 
-  if (m_modemState == STATE_CALPOCSAG)
-    calPOCSAG.process();
+    if (rightCallback == NULL)
+      sound->setCallback(leftCallback);
+    else
+      sound->setCallback(leftCallback, rightCallback);
 
-  if (m_modemState == STATE_IDLE)
-    cwIdTX.process();
+    return sound->open();
+  }
 }
 
 int main(int argc, char** argv)
@@ -120,15 +111,29 @@ int main(int argc, char** argv)
 
   std::string ptyPath("ttyMMDVM0");
   bool daemon = false;
+  bool gate = false;
+  bool classify = false;
+  bool parallel = false;
+  bool freeRun = false;
+  std::string hubName;
+  std::string statsFile;
+  std::string traceFile;
+  std::string metricsAddress;
+  std::string debugFile;
 
   if (::getuid() == 0)
     ptyPath = "/dev/ttyMMDVM0";
 
+  // Each -port and -audio pair is another modem
+  std::vector<std::string> ptyPaths;
+  std::vector<std::string> audioDevs;
+
   for (int i=1; i<argc; i++) {
     char* arg = argv[i];
     char* param = NULL;
 
-    if (arg[0] == '-' && arg[1] == 'd') {
+    // Only the whole word, so that -debuglog is not taken for it
+    if (::strcmp("-daemon", arg) == 0 || ::strcmp("-d", arg) == 0) {
       daemon = true;
     } else {
       if (arg[0] == '-' && i + 1 < argc)
@@ -136,30 +141,227 @@ int main(int argc, char** argv)
 
       if (::strcmp("-port", arg) == 0 && param != NULL) {
         i++;
-        ptyPath = param;
+        ptyPaths.push_back(param);
       } else if (::strcmp("-audio", arg) == 0 && param != NULL) {
         i++;
-        audioDev = param;
+        audioDevs.push_back(param);
+      } else if (::strcmp("-gate", arg) == 0) {
+        gate = true;
+      } else if (::strcmp("-classify", arg) == 0) {
+        gate = true;
+        classify = true;
+      } else if (::strcmp("-parallel", arg) == 0) {
+        parallel = true;
+      } else if (::strcmp("-hub", arg) == 0 && param != NULL) {
+        i++;
+        hubName = param;
+      } else if (::strcmp("-freerun", arg) == 0) {
+        freeRun = true;
+      } else if (::strcmp("-stats", arg) == 0 && param != NULL) {
+        i++;
+        statsFile = param;
+      } else if (::strcmp("-trace", arg) == 0 && param != NULL) {
+        i++;
+        traceFile = param;
+      } else if (::strcmp("-metrics", arg) == 0 && param != NULL) {
+        i++;
+        metricsAddress = param;
+      } else if (::strcmp("-debuglog", arg) == 0 && param != NULL) {
+        i++;
+        debugFile = param;
       } else {
-        ::fprintf(stderr, "MMDVM-UDRC modem\nUsage: MMDVM [-daemon] -port <vpty port> -audio <audiodev>\n\nUsing params: <vpty port> = %s | <audiodev> = %s \n", ptyPath.c_str(), audioDev.c_str());
+        ::fprintf(stderr, "MMDVM-UDRC modem\nUsage: MMDVM [-daemon] [-gate] [-classify] [-parallel] [-freerun] [-stats <file>] [-trace <file>] [-metrics <socket or port>] [-debuglog <file>] -port <vpty port> -audio <audiodev> [-port <vpty port> -audio <audiodev> ...]\n       MMDVM -hub <name> -audio <audiodev>\nTwo modems given the same stereo <audiodev> use one channel each\n<audiodev> may also be file:<wav, raw or f32 file>[,<output wav file>], or hub:<name>:<0|1> for a channel of a running hub\n-freerun replays the files as fast as possible once the host has configured the modems, then exits\n-stats writes the CPU used by each stage to <file> every second, <file>.<n> for each modem when there are several\n-trace keeps the most recent timed calls and writes them to <file> as a Chrome trace on SIGUSR1 and at exit\n-metrics serves Prometheus metrics on a Unix socket, or on a TCP port of 127.0.0.1 when given a number\n-debuglog appends the debug messages to <file> instead of sending them to the host, <file>.<n> for each modem when there are several\n\nUsing params: <vpty port> = %s | <audiodev> = %s \n", ptyPath.c_str(), audioDev.c_str());
       }
     }
   }
 
-  serial.setPtyPath(ptyPath);
-  bool ret = serial.open();
-  if (!ret) {
-    ::fprintf(stderr,"Unable to open serial port on vpty: %s\n",ptyPath.c_str());
+  if (ptyPaths.empty())
+    ptyPaths.push_back(ptyPath);
+  if (audioDevs.empty())
+    audioDevs.push_back(audioDev);
+
+  // The hub owns the sound card and shares each channel with modems in other processes
+  if (!hubName.empty()) {
+    CAudioHub hub(hubName, 48000U);
+    if (!hub.open())
+      return 1;
+
+    // The sound card or file is kept so that it can stop before the shared memory goes
+    CSoundFileReaderWriter* file  = createFile(audioDevs[0U]);
+    CSoundCardReaderWriter* sound = NULL;
+
+    bool ok;
+    if (file != NULL) {
+      file->setCallback(hub.getPort(0U), hub.getPort(1U));
+      ok = file->open();
+    } else {
+      sound = new CSoundCardReaderWriter(audioDevs[0U], audioDevs[0U], 48000U, RX_BLOCK_SIZE * RX_DECIMATION);
+      sound->setCallback(hub.getPort(0U), hub.getPort(1U));
+      ok = sound->open();
+    }
+
+    if (!ok) {
+      ::fprintf(stderr, "Unable to open audio device: %s\n", audioDevs[0U].c_str());
+      return 1;
+    }
+
+    ::signal(SIGINT,  handleSignal);
+    ::signal(SIGTERM, handleSignal);
+
+    while (s_exit == 0)
+      CThread::sleep(100U);
+
+    if (file != NULL) {
+      file->close();
+      delete file;
+    } else {
+      sound->close();
+      delete sound;
+    }
+
+    hub.close();
+
+    return 0;
+  }
+
+  if (ptyPaths.size() != audioDevs.size()) {
+    ::fprintf(stderr, "Each modem needs both a -port and an -audio\n");
     return 1;
   }
 
-  CSoundCardReaderWriter sound(audioDev, audioDev, 48000U, RX_BLOCK_SIZE);
-  sound.setCallback(&io);
+  unsigned int count = ptyPaths.size();
 
-  ret = sound.open();
-  if (!ret) {
-    ::fprintf(stderr, "Unable to open audio device: %s\n", audioDev.c_str());
-    return 1;
+#if !defined(STAGE_STATS)
+  if (!statsFile.empty())
+    ::fprintf(stderr, "This modem was built without STAGE_STATS, there are no stage timings for %s\n", statsFile.c_str());
+  if (!traceFile.empty())
+    ::fprintf(stderr, "This modem was built without STAGE_STATS, there is no trace for %s\n", traceFile.c_str());
+#endif
+
+  // All of the modems share the one trace, each as its own process in the timeline
+  CStageTrace* trace = NULL;
+  if (!traceFile.empty())
+    trace = new CStageTrace(TRACE_LENGTH);
+  long cpus = ::sysconf(_SC_NPROCESSORS_ONLN);
+
+  std::vector<CModem*> modems;
+
+  for (unsigned int i = 0U; i < count; i++) {
+    CModem* modem = new CModem;
+
+    modem->io.setGate(gate);
+    modem->io.setClassifier(classify);
+    modem->io.setParallel(parallel);
+
+    if (!statsFile.empty()) {
+      if (count > 1U)
+        modem->setStatsFile(statsFile + "." + std::to_string(i));
+      else
+        modem->setStatsFile(statsFile);
+    }
+
+    if (!debugFile.empty()) {
+      std::string fileName = count > 1U ? debugFile + "." + std::to_string(i) : debugFile;
+      if (!modem->setDebugFile(fileName)) {
+        ::fprintf(stderr, "Unable to open the debug log %s\n", fileName.c_str());
+        return 1;
+      }
+    }
+
+#if defined(STAGE_STATS)
+    if (trace != NULL)
+      modem->stats.setTrace(trace, i);
+#endif
+
+    // A single modem is left to the scheduler, more than one get a core each
+    if (count > 1U && cpus > 0L)
+      modem->setCPU(int(i % cpus));
+
+    if (!modem->open(ptyPaths[i]))
+      return 1;
+
+    modems.push_back(modem);
+  }
+
+  if (!metricsAddress.empty()) {
+    CMetricsServer* metrics = new CMetricsServer(metricsAddress);
+    for (unsigned int i = 0U; i < count; i++)
+      metrics->addModem(ptyPaths[i], &modems[i]->metrics);
+
+    if (!metrics->open())
+      return 1;
+  }
+
+  // The debug messages are sent, or written to the logs, away from the modems' threads
+  CDebugWriter* debug = new CDebugWriter;
+  for (unsigned int i = 0U; i < count; i++)
+    debug->addModem(modems[i]);
+
+  // An audio device given to two modems is opened once, the first modem gets the left channel
+  std::vector<bool> opened(count, false);
+
+  // When free running the files drive the modems, rather than the modems' own threads
+  std::vector<CSoundFileReaderWriter*> files;
+
+  for (unsigned int i = 0U; i < count; i++) {
+    if (opened[i])
+      continue;
+
+    // Every hub client has its own channel
+    unsigned int pair = i;
+    for (unsigned int j = i + 1U; j < count && audioDevs[i].compare(0U, 4U, "hub:") != 0; j++) {
+      if (audioDevs[j] != audioDevs[i])
+        continue;
+
+      if (pair != i) {
+        ::fprintf(stderr, "No more than two modems can share audio device: %s\n", audioDevs[i].c_str());
+        return 1;
+      }
+
+      pair = j;
+    }
+
+    IAudioCallback* rightCallback = NULL;
+    if (pair == i) {
+      // The hub channel also says which PTT to use
+      if (audioDevs[i].compare(0U, 4U, "hub:") == 0)
+        modems[i]->io.setRadioPort(audioDevs[i].compare(audioDevs[i].size() - 2U, 2U, ":1") == 0 ? RADIO_PORT_RIGHT : RADIO_PORT_LEFT);
+    } else {
+      modems[i]->io.setRadioPort(RADIO_PORT_LEFT);
+      modems[pair]->io.setRadioPort(RADIO_PORT_RIGHT);
+      rightCallback = &modems[pair]->io;
+      opened[pair] = true;
+    }
+
+    bool ok;
+    if (freeRun) {
+      CSoundFileReaderWriter* file = createFile(audioDevs[i]);
+      if (file == NULL) {
+        ::fprintf(stderr, "Only files can be free run, not %s\n", audioDevs[i].c_str());
+        return 1;
+      }
+
+      if (rightCallback == NULL) {
+        file->setCallback(&modems[i]->io);
+      } else {
+        file->setCallback(&modems[i]->io, rightCallback);
+        file->setFreeRun(modems[pair]);
+      }
+      file->setFreeRun(modems[i]);
+
+      files.push_back(file);
+
+      ok = file->open();
+    } else {
+      ok = openAudio(audioDevs[i], &modems[i]->io, rightCallback);
+    }
+
+    if (!ok) {
+      ::fprintf(stderr, "Unable to open audio device: %s\n", audioDevs[i].c_str());
+      return 1;
+    }
+
+    opened[i] = true;
   }
 
   if (daemon) {
@@ -218,11 +420,47 @@ int main(int argc, char** argv)
     }
   }
 
-  for (;;) {
-    loop();
-    CThread::sleep(5U);
+  debug->run();
+
+  if (freeRun) {
+    for (unsigned int i = 0U; i < files.size(); i++)
+      files[i]->wait();
+
+    if (trace != NULL)
+      writeTrace(*trace, traceFile);
+
+    debug->stop();
+    debug->wait();
+
+    return 0;
   }
 
+  for (unsigned int i = 0U; i < count; i++)
+    modems[i]->run();
+
+  // The trace is written from here, away from the modems' threads
+  if (trace != NULL) {
+    ::signal(SIGUSR1, handleSignal);
+    ::signal(SIGINT,  handleSignal);
+    ::signal(SIGTERM, handleSignal);
+
+    while (s_exit == 0) {
+      CThread::sleep(100U);
+
+      if (s_traceDump != 0) {
+        s_traceDump = 0;
+        writeTrace(*trace, traceFile);
+      }
+    }
+
+    writeTrace(*trace, traceFile);
+
+    return 0;
+  }
+
+  for (unsigned int i = 0U; i < count; i++)
+    modems[i]->wait();
+
   return 0;
 }
 
@@ -0,0 +1,387 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// The loopback bit error rate test. Each mode's modulator feeds its receiver
+// through a channel model, with noise, DC offset, level and deviation errors
+// and a clock offset, over a sweep of SNRs. The frames recovered, bit errors
+// and CPU time per point are written as JSON. Run it with "make ber".
+
+#include "SignalGenerator.h"
+#include "SerialPort.h"
+#include "Globals.h"
+#include "Utils.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+const unsigned int SAMPLE_RATE  = 48000U;
+const unsigned int BLOCK_LENGTH = RX_BLOCK_SIZE * RX_DECIMATION;
+
+const uint8_t FRAME_START = 0xE0U;
+
+// Silence before the signal, and after it so that the receivers notice the end
+const unsigned int LEAD_SAMPLES = SAMPLE_RATE / 10U;
+const unsigned int TAIL_SAMPLES = SAMPLE_RATE;
+
+// How far apart a received frame and the frame it is matched to can be
+const unsigned int MATCH_WINDOW = 50U;
+
+// The SNR over the whole 48 kHz bandwidth, in dB
+const float DEFAULT_SNRS[] = {40.0F, 30.0F, 25.0F, 20.0F, 17.0F, 14.0F, 12.0F, 10.0F, 8.0F, 6.0F};
+
+struct BERMode {
+  const char* name;
+  MMDVM_STATE state;
+  uint8_t     type;         // The host frame carrying the data
+  uint8_t     offset;       // Where the payload starts in it
+};
+
+static const BERMode BER_MODES[] = {
+#if defined(MODE_DSTAR)
+  {"dstar", STATE_DSTAR, 0x11U, 3U},
+#endif
+#if defined(MODE_DMR)
+  {"dmr",   STATE_DMR,   0x1AU, 4U},
+#endif
+#if defined(MODE_YSF)
+  {"ysf",   STATE_YSF,   0x20U, 4U},
+#endif
+#if defined(MODE_P25)
+  {"p25",   STATE_P25,   0x31U, 4U},
+#endif
+#if defined(MODE_NXDN)
+  {"nxdn",  STATE_NXDN,  0x40U, 4U},
+#endif
+  {NULL,    STATE_IDLE,  0x00U, 0U}
+};
+
+static uint64_t getCPUNanoseconds()
+{
+  struct timespec ts;
+  ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+  return uint64_t(ts.tv_sec) * 1000000000U + ts.tv_nsec;
+}
+
+class CBERTest {
+public:
+  CBERTest(unsigned int frames, float dcOffset, float levelDB, float clockPPM, float deviation);
+
+  bool open();
+
+  void run(const std::string& mode, const std::vector<float>& snrs);
+
+private:
+  unsigned int         m_frames;
+  float                m_dcOffset;
+  float                m_levelDB;
+  float                m_clockPPM;
+  float                m_deviation;
+  int                  m_pipe[2U];
+  bool                 m_first;
+  std::vector<uint8_t> m_pending;
+  std::vector<std::vector<uint8_t> > m_received;
+
+  void  runPoint(const BERMode& mode, const std::vector<float>& signal, float power, float snr, const std::vector<std::vector<uint8_t> >& sent);
+  void  channel(const std::vector<float>& input, float power, float snr, std::vector<float>& output) const;
+  void  drain();
+  float gaussian() const;
+};
+
+CBERTest::CBERTest(unsigned int frames, float dcOffset, float levelDB, float clockPPM, float deviation) :
+m_frames(frames),
+m_dcOffset(dcOffset),
+m_levelDB(levelDB),
+m_clockPPM(clockPPM),
+m_deviation(deviation),
+m_pipe(),
+m_first(true),
+m_pending(),
+m_received()
+{
+}
+
+bool CBERTest::open()
+{
+  if (::pipe(m_pipe) == -1) {
+    ::fprintf(stderr, "Unable to create the frame pipe\n");
+    return false;
+  }
+
+  ::fcntl(m_pipe[0U], F_SETFL, O_NONBLOCK);
+#if defined(F_SETPIPE_SZ)
+  ::fcntl(m_pipe[1U], F_SETPIPE_SZ, 1024 * 1024);
+#endif
+
+  return true;
+}
+
+void CBERTest::run(const std::string& mode, const std::vector<float>& snrs)
+{
+  ::printf("{\n  \"frames\": %u,\n  \"channel\": {\"dc_offset\": %.3f, \"level_db\": %.1f, \"clock_ppm\": %.1f, \"deviation_percent\": %.1f},\n  \"results\": [",
+    m_frames, m_dcOffset, m_levelDB, m_clockPPM, m_deviation);
+
+  for (unsigned int i = 0U; BER_MODES[i].name != NULL; i++) {
+    if (mode != "all" && mode != BER_MODES[i].name)
+      continue;
+
+    CSignalGenerator generator(BER_MODES[i].state);
+
+    std::vector<float> signal(LEAD_SAMPLES, 0.0F);
+    generator.generate(m_frames, 0xFFFFFFFFU, signal);
+
+    // The noise is set from the power of the signal alone
+    float power = 0.0F;
+    for (unsigned int j = LEAD_SAMPLES; j < signal.size(); j++)
+      power += signal[j] * signal[j];
+    power /= float(signal.size() - LEAD_SAMPLES);
+
+    signal.resize(signal.size() + TAIL_SAMPLES, 0.0F);
+
+    for (unsigned int j = 0U; j < snrs.size(); j++)
+      runPoint(BER_MODES[i], signal, power, snrs[j], generator.getFrames());
+  }
+
+  ::printf("\n  ]\n}\n");
+}
+
+void CBERTest::runPoint(const BERMode& mode, const std::vector<float>& signal, float power, float snr, const std::vector<std::vector<uint8_t> >& sent)
+{
+  std::vector<float> input;
+  channel(signal, power, snr, input);
+
+  CModem* modem = new CModem;
+
+  modem->dstarEnable  = mode.state == STATE_DSTAR;
+  modem->dmrEnable    = mode.state == STATE_DMR;
+  modem->ysfEnable    = mode.state == STATE_YSF;
+  modem->p25Enable    = mode.state == STATE_P25;
+  modem->nxdnEnable   = mode.state == STATE_NXDN;
+  modem->pocsagEnable = false;
+  modem->modemState   = mode.state;
+
+  // The frames go to a pipe instead of the host
+  modem->serial.m_fd = m_pipe[1U];
+
+  modem->io.start();
+  modem->io.setMode();
+
+  drain();
+  m_received.clear();
+
+  uint64_t start = getCPUNanoseconds();
+
+  unsigned int length = (input.size() / BLOCK_LENGTH) * BLOCK_LENGTH;
+  for (unsigned int i = 0U; i < length; i += BLOCK_LENGTH) {
+    modem->io.readCallback(&input[i], BLOCK_LENGTH);
+    modem->io.process();
+
+    if ((i % SAMPLE_RATE) == 0U)
+      drain();
+  }
+
+  uint64_t cpu = getCPUNanoseconds() - start;
+
+  drain();
+
+  delete modem;
+
+  // Match each received frame to the nearest sent frame ahead of the last match
+  unsigned int recovered = 0U;
+  unsigned int falses    = 0U;
+  uint64_t bits   = 0U;
+  uint64_t errors = 0U;
+
+  unsigned int next = 0U;
+  for (unsigned int i = 0U; i < m_received.size(); i++) {
+    const std::vector<uint8_t>& frame = m_received[i];
+
+    // Headers, lost reports and the debug output are not counted
+    if (frame[2U] != mode.type)
+      continue;
+
+    unsigned int bestErrors = 0xFFFFFFFFU;
+    unsigned int bestFrame  = next;
+    for (unsigned int j = next; j < sent.size() && j < (next + MATCH_WINDOW); j++) {
+      if (frame.size() < (mode.offset + sent[j].size()))
+        break;
+
+      unsigned int errs = 0U;
+      for (unsigned int k = 0U; k < sent[j].size(); k++)
+        errs += countBits8(frame[mode.offset + k] ^ sent[j][k]);
+
+      if (errs < bestErrors) {
+        bestErrors = errs;
+        bestFrame  = j;
+      }
+    }
+
+    // A frame with more than a quarter of its bits wrong is a false decode
+    if (bestErrors == 0xFFFFFFFFU || (bestErrors * 4U) > (sent[bestFrame].size() * 8U)) {
+      falses++;
+      continue;
+    }
+
+    recovered++;
+    bits   += sent[bestFrame].size() * 8U;
+    errors += bestErrors;
+    next    = bestFrame + 1U;
+  }
+
+  ::printf("%s\n    {\"mode\": \"%s\", \"snr_db\": %.1f, \"frames_sent\": %u, \"frames_recovered\": %u, \"false_frames\": %u, \"fer\": %.4f, \"bits\": %llu, \"bit_errors\": %llu, \"ber\": %.6f, \"cpu_ns_per_sample\": %.1f}",
+    m_first ? "" : ",", mode.name, snr, unsigned(sent.size()), recovered, falses,
+    sent.empty() ? 1.0 : 1.0 - double(recovered) / double(sent.size()),
+    (unsigned long long)bits, (unsigned long long)errors, bits == 0U ? 1.0 : double(errors) / double(bits),
+    double(cpu) / double(length));
+
+  m_first = false;
+}
+
+// The transmitter's deviation and clock errors, noise on the path, then the receiver's level and DC errors
+void CBERTest::channel(const std::vector<float>& input, float power, float snr, std::vector<float>& output) const
+{
+  ::srand(1U);
+
+  float deviation = 1.0F + m_deviation / 100.0F;
+  float noise     = ::sqrtf(power / ::powf(10.0F, snr / 10.0F));
+  float level     = ::powf(10.0F, m_levelDB / 20.0F);
+
+  // A positive offset is a transmitter clock that is fast, so fewer samples reach the receiver
+  double step  = 1.0 + double(m_clockPPM) * 1.0E-6;
+  double phase = 0.0;
+
+  output.clear();
+  output.reserve(input.size());
+
+  while (phase < double(input.size() - 1U)) {
+    unsigned int n = (unsigned int)phase;
+    float frac = float(phase - double(n));
+
+    float sample = (input[n] + frac * (input[n + 1U] - input[n])) * deviation;
+
+    sample += noise * gaussian();
+
+    output.push_back(sample * level + m_dcOffset);
+
+    phase += step;
+  }
+}
+
+// Counts the complete frames written to the host
+void CBERTest::drain()
+{
+  uint8_t buffer[4096U];
+  ssize_t n;
+  while ((n = ::read(m_pipe[0U], buffer, sizeof(buffer))) > 0)
+    m_pending.insert(m_pending.end(), buffer, buffer + n);
+
+  unsigned int ptr = 0U;
+
+  while ((m_pending.size() - ptr) >= 3U) {
+    if (m_pending[ptr] != FRAME_START) {
+      ptr++;
+      continue;
+    }
+
+    unsigned int length = m_pending[ptr + 1U];
+    if (length < 3U) {
+      ptr++;
+      continue;
+    }
+
+    if ((m_pending.size() - ptr) < length)
+      break;
+
+    m_received.push_back(std::vector<uint8_t>(m_pending.begin() + ptr, m_pending.begin() + ptr + length));
+    ptr += length;
+  }
+
+  m_pending.erase(m_pending.begin(), m_pending.begin() + ptr);
+}
+
+// Box-Muller, unit variance
+float CBERTest::gaussian() const
+{
+  float u1 = (float(::rand()) + 1.0F) / (float(RAND_MAX) + 2.0F);
+  float u2 = float(::rand()) / float(RAND_MAX);
+
+  return ::sqrtf(-2.0F * ::logf(u1)) * ::cosf(2.0F * float(M_PI) * u2);
+}
+
+int main(int argc, char** argv)
+{
+  std::string mode("all");
+  unsigned int frames = 100U;
+  float dcOffset  = 0.0F;
+  float levelDB   = 0.0F;
+  float clockPPM  = 0.0F;
+  float deviation = 0.0F;
+
+  std::vector<float> snrs;
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg   = argv[i];
+    const char* param = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+    if (param == NULL) {
+      ::fprintf(stderr, "Usage: MMDVMBER [-mode <dstar|dmr|ysf|p25|nxdn|all>] [-frames <n>] [-snr <dB>[,<dB>...]] [-dc <offset>] [-level <dB>] [-clock <ppm>] [-deviation <percent>]\n");
+      return 1;
+    }
+
+    if (::strcmp("-mode", arg) == 0) {
+      mode = param;
+    } else if (::strcmp("-frames", arg) == 0) {
+      frames = ::atoi(param);
+    } else if (::strcmp("-snr", arg) == 0) {
+      for (char* p = ::strtok(argv[i + 1], ","); p != NULL; p = ::strtok(NULL, ","))
+        snrs.push_back(float(::atof(p)));
+    } else if (::strcmp("-dc", arg) == 0) {
+      dcOffset = float(::atof(param));
+    } else if (::strcmp("-level", arg) == 0) {
+      levelDB = float(::atof(param));
+    } else if (::strcmp("-clock", arg) == 0) {
+      clockPPM = float(::atof(param));
+    } else if (::strcmp("-deviation", arg) == 0) {
+      deviation = float(::atof(param));
+    } else {
+      ::fprintf(stderr, "Unknown option %s\n", arg);
+      return 1;
+    }
+
+    i++;
+  }
+
+  if (snrs.empty())
+    snrs.assign(DEFAULT_SNRS, DEFAULT_SNRS + sizeof(DEFAULT_SNRS) / sizeof(float));
+
+  CBERTest test(frames, dcOffset, levelDB, clockPPM, deviation);
+  if (!test.open())
+    return 1;
+
+  test.run(mode, snrs);
+
+  return 0;
+}
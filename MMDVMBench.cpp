@@ -0,0 +1,387 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// The offline benchmark, it runs canonical signals for each mode through
+// the real filters and receivers and reports the cost of each stage as JSON.
+// Run it with "make bench", the argument is the number of seconds per case.
+
+#include "SignalGenerator.h"
+#include "SerialPort.h"
+#include "Globals.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+const unsigned int SAMPLE_RATE  = 48000U;
+const unsigned int BLOCK_LENGTH = RX_BLOCK_SIZE * RX_DECIMATION;
+
+const uint8_t FRAME_START = 0xE0U;
+
+// The 48 kHz input is drained from the frame pipe this often
+const unsigned int DRAIN_INTERVAL = 4800U;
+
+// In the order of RX_CHAIN
+static const char* CHAIN_NAMES[RX_CHAIN_MAX] = {"fir_gaussian", "fir_boxcar", "fir_nxdn", "fir_rrc", "fir_gaussian_cal"};
+
+static uint64_t getNanoseconds()
+{
+  struct timespec ts;
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return uint64_t(ts.tv_sec) * 1000000000U + ts.tv_nsec;
+}
+
+static const char* getStateName(MMDVM_STATE state)
+{
+  switch (state) {
+    case STATE_DSTAR:
+      return "dstar";
+    case STATE_DMR:
+      return "dmr";
+    case STATE_YSF:
+      return "ysf";
+    case STATE_P25:
+      return "p25";
+    case STATE_NXDN:
+      return "nxdn";
+    case STATE_DSTARCAL:
+      return "dstarcal";
+    default:
+      return "idle";
+  }
+}
+
+class CBench {
+public:
+  CBench(unsigned int seconds);
+
+  bool open();
+
+  void run();
+
+private:
+  unsigned int       m_length;
+  int                m_pipe[2U];
+  bool               m_firstCase;
+  bool               m_firstStage;
+  std::vector<float> m_signal;
+  std::vector<uint8_t> m_pending;
+
+  CModem*      createModem(MMDVM_STATE state);
+  unsigned int drain();
+
+  uint64_t     generate(MMDVM_STATE state);
+  void         generateNoise(float amplitude);
+
+  void         runCase(const char* name, MMDVM_STATE state, uint64_t txTime);
+  void         writeStage(const char* name, uint64_t time, unsigned int samples);
+};
+
+CBench::CBench(unsigned int seconds) :
+m_length(((seconds * SAMPLE_RATE) / BLOCK_LENGTH) * BLOCK_LENGTH),
+m_pipe(),
+m_firstCase(true),
+m_firstStage(true),
+m_signal(),
+m_pending()
+{
+}
+
+bool CBench::open()
+{
+  if (::pipe(m_pipe) == -1) {
+    ::fprintf(stderr, "Unable to create the frame pipe\n");
+    return false;
+  }
+
+  ::fcntl(m_pipe[0U], F_SETFL, O_NONBLOCK);
+#if defined(F_SETPIPE_SZ)
+  ::fcntl(m_pipe[1U], F_SETPIPE_SZ, 1024 * 1024);
+#endif
+
+  return true;
+}
+
+CModem* CBench::createModem(MMDVM_STATE state)
+{
+  CModem* modem = new CModem;
+
+  modem->dstarEnable  = HAS_DSTAR;
+  modem->dmrEnable    = HAS_DMR;
+  modem->ysfEnable    = HAS_YSF;
+  modem->p25Enable    = HAS_P25;
+  modem->nxdnEnable   = HAS_NXDN;
+  modem->pocsagEnable = false;
+  modem->modemState   = state;
+
+  // The frames go to a pipe instead of the host
+  modem->serial.m_fd = m_pipe[1U];
+
+  modem->io.start();
+  modem->io.setMode();
+
+  return modem;
+}
+
+// Counts the complete frames written to the host
+unsigned int CBench::drain()
+{
+  uint8_t buffer[4096U];
+  ssize_t n;
+  while ((n = ::read(m_pipe[0U], buffer, sizeof(buffer))) > 0)
+    m_pending.insert(m_pending.end(), buffer, buffer + n);
+
+  unsigned int count = 0U;
+  unsigned int ptr   = 0U;
+
+  while ((m_pending.size() - ptr) >= 3U) {
+    if (m_pending[ptr] != FRAME_START) {
+      ptr++;
+      continue;
+    }
+
+    unsigned int length = m_pending[ptr + 1U];
+    if (length < 3U) {
+      ptr++;
+      continue;
+    }
+
+    if ((m_pending.size() - ptr) < length)
+      break;
+
+    count++;
+    ptr += length;
+  }
+
+  m_pending.erase(m_pending.begin(), m_pending.begin() + ptr);
+
+  return count;
+}
+
+void CBench::run()
+{
+  ::printf("{\n  \"sample_rate\": %u,\n  \"rx_sample_rate\": %u,\n  \"block_length\": %u,\n  \"seconds\": %.1f,\n  \"cases\": [", SAMPLE_RATE, SAMPLE_RATE / RX_DECIMATION, BLOCK_LENGTH, double(m_length) / double(SAMPLE_RATE));
+
+  // Each mode's signal is made, and the modulator timed, before its receiver runs
+#if defined(MODE_DSTAR)
+  runCase("dstar", STATE_DSTAR, generate(STATE_DSTAR));
+#endif
+#if defined(MODE_DMR)
+  runCase("dmr", STATE_DMR, generate(STATE_DMR));
+#endif
+#if defined(MODE_YSF)
+  runCase("ysf", STATE_YSF, generate(STATE_YSF));
+#endif
+#if defined(MODE_P25)
+  runCase("p25", STATE_P25, generate(STATE_P25));
+#endif
+#if defined(MODE_NXDN)
+  runCase("nxdn", STATE_NXDN, generate(STATE_NXDN));
+#endif
+
+  // Every built in receiver listens in IDLE
+  generateNoise(0.0F);
+  runCase("idle_silence", STATE_IDLE, 0U);
+
+  generateNoise(0.5F);
+  runCase("idle_noise", STATE_IDLE, 0U);
+
+  ::printf("\n  ]\n}\n");
+}
+
+uint64_t CBench::generate(MMDVM_STATE state)
+{
+  CSignalGenerator generator(state);
+
+  m_signal.clear();
+
+  uint64_t time = generator.generate(0xFFFFFFFFU, m_length, m_signal);
+
+  m_signal.resize(m_length);
+
+  return time;
+}
+
+void CBench::generateNoise(float amplitude)
+{
+  ::srand(1U);
+
+  m_signal.resize(m_length);
+
+  for (unsigned int i = 0U; i < m_length; i++)
+    m_signal[i] = amplitude * ((float(::rand()) / float(RAND_MAX)) * 2.0F - 1.0F);
+}
+
+void CBench::runCase(const char* name, MMDVM_STATE state, uint64_t txTime)
+{
+  // The whole receive path, as the modem runs it
+  CModem* modem = createModem(state);
+
+  drain();
+
+  unsigned int frames = 0U;
+
+  uint64_t start = getNanoseconds();
+
+  for (unsigned int i = 0U; i < m_length; i += BLOCK_LENGTH) {
+    modem->io.readCallback(&m_signal[i], BLOCK_LENGTH);
+    modem->io.process();
+
+    if ((i % DRAIN_INTERVAL) == 0U)
+      frames += drain();
+  }
+
+  uint64_t total = getNanoseconds() - start;
+
+  frames += drain();
+
+  delete modem;
+
+  double seconds = double(total) / 1000000000.0;
+  double audio   = double(m_length) / double(SAMPLE_RATE);
+
+  ::printf("%s\n    {\n      \"case\": \"%s\",\n      \"samples\": %u,\n      \"frames\": %u,\n      \"samples_per_second\": %.0f,\n      \"realtime_factor\": %.1f,\n      \"ns_per_sample\": %.1f,\n      \"stages\": [",
+    m_firstCase ? "" : ",", name, m_length, frames, double(m_length) / seconds, audio / seconds, double(total) / double(m_length));
+
+  m_firstCase  = false;
+  m_firstStage = true;
+
+  // Each stage on its own, on a fresh modem so that every stage sees the same signal
+  modem = createModem(state);
+  CIO& io = modem->io;
+
+  std::vector<float> samples(m_length);
+  for (unsigned int i = 0U; i < m_length; i++)
+    samples[i] = (m_signal[i] - io.m_rxDCOffset) * io.m_rxLevel;
+
+  unsigned int length = m_length;
+
+#if defined(RX_24KHZ)
+  start = getNanoseconds();
+
+  for (unsigned int i = 0U; i < (m_length / BLOCK_LENGTH); i++)
+    io.m_decimator.process(&samples[i * BLOCK_LENGTH], &samples[i * RX_BLOCK_SIZE], RX_BLOCK_SIZE);
+
+  writeStage("decimator", getNanoseconds() - start, m_length);
+
+  length /= RX_DECIMATION;
+#endif
+
+  std::vector<float> dcSamples(length);
+
+  start = getNanoseconds();
+
+  for (unsigned int i = 0U; i < length; i += RX_BLOCK_SIZE) {
+    float dcValues[RX_BLOCK_SIZE];
+    io.m_dcFilter.process(&samples[i], dcValues, RX_BLOCK_SIZE);
+
+    float offset = 0.0F;
+    for (uint8_t j = 0U; j < RX_BLOCK_SIZE; j++)
+      offset += dcValues[j];
+    offset /= float(RX_BLOCK_SIZE);
+
+    for (uint8_t j = 0U; j < RX_BLOCK_SIZE; j++)
+      dcSamples[i + j] = samples[i + j] - offset;
+  }
+
+  writeStage("dc_biquad", getNanoseconds() - start, m_length);
+
+  std::vector<float> filtered(length);
+
+  for (uint8_t c = 0U; c < io.m_chainCount; c++) {
+    const CIO::RXChainDef& def = CIO::RX_CHAINS[io.m_chains[c]];
+    const float* input = def.dcRemoved ? &dcSamples[0U] : &samples[0U];
+
+    start = getNanoseconds();
+
+    for (unsigned int i = 0U; i < length; i += RX_BLOCK_SIZE)
+      (io.*def.filter)(input + i, &filtered[i]);
+
+    writeStage(CHAIN_NAMES[io.m_chains[c]], getNanoseconds() - start, m_length);
+
+    for (uint8_t j = 0U; j < CIO::RX_CHAIN_SINKS; j++) {
+      if ((io.m_chainSinks[io.m_chains[c]] & (1U << j)) == 0U)
+        continue;
+
+      start = getNanoseconds();
+
+      for (unsigned int i = 0U; i < length; i += RX_BLOCK_SIZE) {
+        def.sinks[j].samples(*modem, &filtered[i], RX_BLOCK_SIZE);
+
+        if ((i % DRAIN_INTERVAL) == 0U)
+          drain();
+      }
+
+      uint64_t time = getNanoseconds() - start;
+
+      char stage[20U];
+      ::sprintf(stage, "rx_%s", getStateName(def.sinks[j].mode));
+      writeStage(stage, time, m_length);
+
+      drain();
+    }
+  }
+
+  delete modem;
+
+  if (txTime > 0U) {
+    char stage[20U];
+    ::sprintf(stage, "tx_%s", getStateName(state));
+    writeStage(stage, txTime, m_length);
+  }
+
+  ::printf("\n      ]\n    }");
+}
+
+// Every stage is per 48 kHz sample, so that they add up to the whole
+void CBench::writeStage(const char* name, uint64_t time, unsigned int samples)
+{
+  if (time == 0U)
+    time = 1U;
+
+  double nsPerSample = double(time) / double(samples);
+
+  ::printf("%s\n        {\"stage\": \"%s\", \"ns_per_sample\": %.2f, \"realtime_factor\": %.1f}", m_firstStage ? "" : ",", name, nsPerSample, 1000000000.0 / (nsPerSample * double(SAMPLE_RATE)));
+
+  m_firstStage = false;
+}
+
+int main(int argc, char** argv)
+{
+  unsigned int seconds = 10U;
+  if (argc > 1)
+    seconds = ::atoi(argv[1]);
+
+  if (seconds == 0U) {
+    ::fprintf(stderr, "Usage: MMDVMBench [seconds per case]\n");
+    return 1;
+  }
+
+  CBench bench(seconds);
+  if (!bench.open())
+    return 1;
+
+  bench.run();
+
+  return 0;
+}
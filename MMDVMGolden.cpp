@@ -0,0 +1,728 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// The golden vector check. Each mode has a recorded input, <mode>_rx.wav, that
+// is replayed through the receivers, and every payload sent in it, listed in
+// <mode>_rx.txt, must come back to the host with few enough bit errors. The
+// same input is then played into an audio hub, as a sound card would, and
+// received by a modem attached to it, with the same result expected, and
+// replayed after a silence to a modem in IDLE with every mode enabled, the
+// activity gate and the mode classifier on. The
+// modulators must reproduce <mode>_tx.wav to within TX_TOLERANCE. Run it with
+// "make check" on any build configuration, and with "make golden" to record the
+// current modulators as the reference.
+
+#include "SignalGenerator.h"
+#include "AudioHub.h"
+#include "WAVFileReader.h"
+#include "WAVFileWriter.h"
+#include "SerialPort.h"
+#include "Globals.h"
+#include "Utils.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+const unsigned int SAMPLE_RATE  = 48000U;
+const unsigned int BLOCK_LENGTH = RX_BLOCK_SIZE * RX_DECIMATION;
+
+const uint8_t FRAME_START = 0xE0U;
+
+// The modulators may differ by this much between builds, such as FIXED_POINT
+const float TX_TOLERANCE = 0.002F;
+
+// The receivers may differ by this bit error rate, as symbols near a threshold
+// are sliced differently by builds such as FIXED_POINT and INT16_BUFFERS
+const float RX_TOLERANCE = 0.002F;
+
+// Longer than the activity gate stays open with nothing to hear
+const unsigned int IDLE_LEAD_SAMPLES = SAMPLE_RATE * 5U;
+
+// How much of the input is played into the hub at a time, 100 ms
+const unsigned int HUB_CHUNK_LENGTH = SAMPLE_RATE / 10U;
+
+// How long a hub client may take to pass a chunk on, samples lost in the hub never arrive
+const unsigned int HUB_TIMEOUT_MS = 1000U;
+
+// How far apart a received frame and the frame it is matched to can be
+const unsigned int MATCH_WINDOW = 50U;
+
+// A new input is the signal with noise and a DC offset, between stretches of noise
+const float INPUT_SNR_DB = 30.0F;
+const float INPUT_DC     = 0.02F;
+const unsigned int INPUT_LEAD_SAMPLES = SAMPLE_RATE / 10U;
+const unsigned int INPUT_TAIL_SAMPLES = SAMPLE_RATE / 2U;
+
+struct GoldenMode {
+  const char*  name;
+  MMDVM_STATE  state;
+  uint8_t      type;        // The host frame carrying the payload
+  uint8_t      offset;      // Where the payload starts in it
+  unsigned int rxFrames;    // In a new input
+  unsigned int txFrames;
+};
+
+static const GoldenMode GOLDEN_MODES[] = {
+#if defined(MODE_DSTAR)
+  {"dstar", STATE_DSTAR, 0x11U, 3U, 42U, 21U},
+#endif
+#if defined(MODE_DMR)
+  {"dmr",   STATE_DMR,   0x1AU, 4U, 18U, 6U},
+#endif
+#if defined(MODE_YSF)
+  {"ysf",   STATE_YSF,   0x20U, 4U, 8U,  3U},
+#endif
+#if defined(MODE_P25)
+  {"p25",   STATE_P25,   0x31U, 4U, 6U,  2U},
+#endif
+#if defined(MODE_NXDN)
+  {"nxdn",  STATE_NXDN,  0x40U, 4U, 10U, 4U},
+#endif
+  {NULL,    STATE_IDLE,  0x00U, 0U, 0U,  0U}
+};
+
+// Passes the samples from a hub client to a modem in the blocks that it takes,
+// and processes them there, in place of the modem's own thread
+class CHubTap : public IAudioCallback {
+public:
+  CHubTap(CModem* modem);
+
+  unsigned int getCount() const;
+
+  virtual void readCallback(const float* input, unsigned int nSamples);
+  virtual void writeCallback(float* output, int& nSamples);
+  virtual void xrunCallback(bool capture);
+
+private:
+  CModem*                   m_modem;
+  std::vector<float>        m_buffer;
+  std::atomic<unsigned int> m_count;
+};
+
+CHubTap::CHubTap(CModem* modem) :
+m_modem(modem),
+m_buffer(),
+m_count(0U)
+{
+}
+
+unsigned int CHubTap::getCount() const
+{
+  return m_count.load(std::memory_order_acquire);
+}
+
+void CHubTap::readCallback(const float* input, unsigned int nSamples)
+{
+  m_buffer.insert(m_buffer.end(), input, input + nSamples);
+
+  unsigned int length = (m_buffer.size() / BLOCK_LENGTH) * BLOCK_LENGTH;
+  for (unsigned int i = 0U; i < length; i += BLOCK_LENGTH) {
+    m_modem->io.readCallback(&m_buffer[i], BLOCK_LENGTH);
+    m_modem->io.process();
+  }
+
+  m_buffer.erase(m_buffer.begin(), m_buffer.begin() + length);
+
+  m_count.fetch_add(nSamples, std::memory_order_release);
+}
+
+void CHubTap::writeCallback(float* output, int& nSamples)
+{
+  m_modem->io.writeCallback(output, nSamples);
+}
+
+void CHubTap::xrunCallback(bool capture)
+{
+  m_modem->io.xrunCallback(capture);
+}
+
+class CGoldenTest {
+public:
+  CGoldenTest(const std::string& directory, bool update);
+
+  bool open();
+
+  // Returns the number of failures
+  unsigned int run();
+
+private:
+  std::string              m_directory;
+  bool                     m_update;
+  int                      m_pipe[2U];
+  std::vector<uint8_t>     m_pending;
+  std::vector<std::vector<uint8_t> > m_received;
+
+  bool checkRX(const GoldenMode& mode);
+  bool checkHub(const GoldenMode& mode);
+  bool checkIdle(const GoldenMode& mode);
+  bool checkTX(const GoldenMode& mode);
+  bool createInput(const GoldenMode& mode, const std::string& inputName, const std::string& framesName) const;
+  bool readInput(const GoldenMode& mode, std::vector<float>& samples, std::vector<std::vector<uint8_t> >& sent) const;
+  bool compare(const GoldenMode& mode, const char* check, const std::vector<std::vector<uint8_t> >& sent) const;
+  CModem* createModem(const GoldenMode& mode, bool idle);
+  void receive(CModem* modem, const std::vector<float>& samples);
+  void drain();
+  bool readSamples(const std::string& fileName, std::vector<float>& samples) const;
+  bool writeSamples(const std::string& fileName, const std::vector<float>& samples) const;
+  bool readLines(const std::string& fileName, std::vector<std::string>& lines) const;
+  bool writeLines(const std::string& fileName, const std::vector<std::string>& lines) const;
+  std::string getFileName(const GoldenMode& mode, const char* suffix) const;
+};
+
+CGoldenTest::CGoldenTest(const std::string& directory, bool update) :
+m_directory(directory),
+m_update(update),
+m_pipe(),
+m_pending(),
+m_received()
+{
+}
+
+bool CGoldenTest::open()
+{
+  if (::pipe(m_pipe) == -1) {
+    ::fprintf(stderr, "Unable to create the frame pipe\n");
+    return false;
+  }
+
+  ::fcntl(m_pipe[0U], F_SETFL, O_NONBLOCK);
+#if defined(F_SETPIPE_SZ)
+  ::fcntl(m_pipe[1U], F_SETPIPE_SZ, 1024 * 1024);
+#endif
+
+  if (m_update)
+    ::mkdir(m_directory.c_str(), 0755);
+
+  return true;
+}
+
+unsigned int CGoldenTest::run()
+{
+  unsigned int failures = 0U;
+
+  for (unsigned int i = 0U; GOLDEN_MODES[i].name != NULL; i++) {
+    if (!checkRX(GOLDEN_MODES[i]))
+      failures++;
+
+    if (!checkHub(GOLDEN_MODES[i]))
+      failures++;
+
+    if (!checkIdle(GOLDEN_MODES[i]))
+      failures++;
+
+    if (!checkTX(GOLDEN_MODES[i]))
+      failures++;
+  }
+
+  return failures;
+}
+
+bool CGoldenTest::checkRX(const GoldenMode& mode)
+{
+  std::string inputName  = getFileName(mode, "_rx.wav");
+  std::string framesName = getFileName(mode, "_rx.txt");
+
+  // The inputs are only ever made once, so that they do not follow the modulators
+  if (m_update && ::access(inputName.c_str(), R_OK) != 0) {
+    if (!createInput(mode, inputName, framesName))
+      return false;
+  }
+
+  std::vector<float> samples;
+  std::vector<std::vector<uint8_t> > sent;
+  if (!readInput(mode, samples, sent))
+    return false;
+
+  receive(createModem(mode, false), samples);
+
+  return compare(mode, "rx", sent);
+}
+
+bool CGoldenTest::checkHub(const GoldenMode& mode)
+{
+  std::vector<float> samples;
+  std::vector<std::vector<uint8_t> > sent;
+  if (!readInput(mode, samples, sent))
+    return false;
+
+  char name[32U];
+  ::sprintf(name, "golden-%d", int(::getpid()));
+
+  CAudioHub hub(name, SAMPLE_RATE);
+  if (!hub.open())
+    return false;
+
+  CModem* modem = createModem(mode, false);
+
+  CHubTap tap(modem);
+
+  CAudioHubClient* client = new CAudioHubClient(name, 0U);
+  client->setCallback(&tap);
+  if (!client->open()) {
+    delete client;
+    delete modem;
+    return false;
+  }
+
+  // Played in as the sound card would, and waited for so that nothing is overrun
+  IAudioCallback* port = hub.getPort(0U);
+
+  std::vector<float> playback(HUB_CHUNK_LENGTH);
+
+  for (unsigned int i = 0U; i < samples.size(); i += HUB_CHUNK_LENGTH) {
+    unsigned int n = samples.size() - i;
+    if (n > HUB_CHUNK_LENGTH)
+      n = HUB_CHUNK_LENGTH;
+
+    port->readCallback(&samples[i], n);
+
+    int length = n;
+    port->writeCallback(&playback[0U], length);
+
+    for (unsigned int ms = 0U; tap.getCount() < (i + n) && ms < HUB_TIMEOUT_MS; ms++)
+      CThread::sleep(1U);
+
+    drain();
+
+    if (tap.getCount() < (i + n))
+      break;
+  }
+
+  client->close();
+  delete client;
+
+  hub.close();
+
+  drain();
+
+  delete modem;
+
+  if (tap.getCount() != samples.size()) {
+    ::fprintf(stdout, "%s hub: FAIL, %u of %u samples passed on\n", mode.name, tap.getCount(), (unsigned int)samples.size());
+    return false;
+  }
+
+  return compare(mode, "hub", sent);
+}
+
+bool CGoldenTest::checkIdle(const GoldenMode& mode)
+{
+  std::vector<float> samples;
+  std::vector<std::vector<uint8_t> > sent;
+  if (!readInput(mode, samples, sent))
+    return false;
+
+  // The gate closes in the silence, so that the signal has to open it
+  samples.insert(samples.begin(), IDLE_LEAD_SAMPLES, 0.0F);
+
+  receive(createModem(mode, true), samples);
+
+  return compare(mode, "idle", sent);
+}
+
+bool CGoldenTest::readInput(const GoldenMode& mode, std::vector<float>& samples, std::vector<std::vector<uint8_t> >& sent) const
+{
+  std::string inputName  = getFileName(mode, "_rx.wav");
+  std::string framesName = getFileName(mode, "_rx.txt");
+
+  if (!readSamples(inputName, samples))
+    return false;
+
+  std::vector<std::string> lines;
+  if (!readLines(framesName, lines))
+    return false;
+
+  sent.clear();
+  for (unsigned int i = 0U; i < lines.size(); i++) {
+    std::vector<uint8_t> frame;
+
+    const char* p = lines[i].c_str();
+    for (;;) {
+      char* end;
+      unsigned long value = ::strtoul(p, &end, 16);
+      if (end == p)
+        break;
+
+      frame.push_back(value);
+      p = end;
+    }
+
+    if (*p != '\0' || frame.empty()) {
+      ::fprintf(stderr, "%s, line %u is not hex\n", framesName.c_str(), i + 1U);
+      return false;
+    }
+
+    sent.push_back(frame);
+  }
+
+  return true;
+}
+
+bool CGoldenTest::compare(const GoldenMode& mode, const char* check, const std::vector<std::vector<uint8_t> >& sent) const
+{
+  // Match each received payload to the nearest sent one ahead of the last match,
+  // anything else, such as the frames decoded from the noise after the signal, is ignored
+  unsigned int recovered = 0U;
+  unsigned int bits      = 0U;
+  unsigned int errors    = 0U;
+  unsigned int missing   = 0U;
+
+  unsigned int next = 0U;
+  for (unsigned int i = 0U; i < m_received.size(); i++) {
+    const std::vector<uint8_t>& frame = m_received[i];
+    if (frame[2U] != mode.type)
+      continue;
+
+    unsigned int bestErrors = 0xFFFFFFFFU;
+    unsigned int bestFrame  = next;
+    for (unsigned int j = next; j < sent.size() && j < (next + MATCH_WINDOW); j++) {
+      if (frame.size() < (mode.offset + sent[j].size()))
+        break;
+
+      unsigned int errs = 0U;
+      for (unsigned int k = 0U; k < sent[j].size(); k++)
+        errs += countBits8(frame[mode.offset + k] ^ sent[j][k]);
+
+      if (errs < bestErrors) {
+        bestErrors = errs;
+        bestFrame  = j;
+      }
+    }
+
+    // More than a quarter of the bits wrong is not the frame that was sent
+    if (bestErrors == 0xFFFFFFFFU || (bestErrors * 4U) > (sent[bestFrame].size() * 8U))
+      continue;
+
+    if (missing == 0U && bestFrame != recovered)
+      missing = recovered + 1U;
+
+    recovered++;
+    bits  += sent[bestFrame].size() * 8U;
+    errors += bestErrors;
+    next   = bestFrame + 1U;
+  }
+
+  if (missing == 0U && recovered < sent.size())
+    missing = recovered + 1U;
+
+  float ber = bits == 0U ? 1.0F : float(errors) / float(bits);
+
+  if (missing == 0U && ber <= RX_TOLERANCE) {
+    ::fprintf(stdout, "%s %s: pass, %u frames, %u bit errors in %u bits\n", mode.name, check, recovered, errors, bits);
+    return true;
+  }
+
+  ::fprintf(stdout, "%s %s: FAIL, %u of %u frames received, %u bit errors in %u bits", mode.name, check, recovered, (unsigned int)sent.size(), errors, bits);
+  if (missing > 0U)
+    ::fprintf(stdout, ", the first missing is frame %u\n", missing);
+  else
+    ::fprintf(stdout, "\n");
+
+  return false;
+}
+
+bool CGoldenTest::checkTX(const GoldenMode& mode)
+{
+  std::string fileName = getFileName(mode, "_tx.wav");
+
+  CSignalGenerator generator(mode.state);
+
+  std::vector<float> signal;
+  generator.generate(mode.txFrames, 0xFFFFFFFFU, signal);
+
+  if (m_update) {
+    if (!writeSamples(fileName, signal))
+      return false;
+
+    ::fprintf(stdout, "%s tx: recorded %u samples\n", mode.name, (unsigned int)signal.size());
+    return true;
+  }
+
+  std::vector<float> expected;
+  if (!readSamples(fileName, expected))
+    return false;
+
+  if (expected.size() != signal.size()) {
+    ::fprintf(stdout, "%s tx: FAIL, %u samples expected and %u generated\n", mode.name, (unsigned int)expected.size(), (unsigned int)signal.size());
+    return false;
+  }
+
+  float maxError = 0.0F;
+  unsigned int worst = 0U;
+  for (unsigned int i = 0U; i < signal.size(); i++) {
+    float error = ::fabsf(signal[i] - expected[i]);
+    if (error > maxError) {
+      maxError = error;
+      worst    = i;
+    }
+  }
+
+  if (maxError > TX_TOLERANCE) {
+    ::fprintf(stdout, "%s tx: FAIL, the largest error is %.5f at sample %u\n", mode.name, maxError, worst);
+    return false;
+  }
+
+  ::fprintf(stdout, "%s tx: pass, %u samples, the largest error is %.5f\n", mode.name, (unsigned int)signal.size(), maxError);
+
+  return true;
+}
+
+bool CGoldenTest::createInput(const GoldenMode& mode, const std::string& inputName, const std::string& framesName) const
+{
+  CSignalGenerator generator(mode.state);
+
+  std::vector<float> signal(INPUT_LEAD_SAMPLES, 0.0F);
+  generator.generate(mode.rxFrames, 0xFFFFFFFFU, signal);
+
+  float power = 0.0F;
+  for (unsigned int i = INPUT_LEAD_SAMPLES; i < signal.size(); i++)
+    power += signal[i] * signal[i];
+  power /= float(signal.size() - INPUT_LEAD_SAMPLES);
+
+  signal.resize(signal.size() + INPUT_TAIL_SAMPLES, 0.0F);
+
+  // Gaussian noise by Box-Muller
+  float noise = ::sqrtf(power / ::powf(10.0F, INPUT_SNR_DB / 10.0F));
+
+  ::srand(1U);
+  for (unsigned int i = 0U; i < signal.size(); i++) {
+    float u1 = (float(::rand()) + 1.0F) / (float(RAND_MAX) + 2.0F);
+    float u2 = float(::rand()) / float(RAND_MAX);
+
+    signal[i] += noise * ::sqrtf(-2.0F * ::logf(u1)) * ::cosf(2.0F * float(M_PI) * u2) + INPUT_DC;
+  }
+
+  if (!writeSamples(inputName, signal))
+    return false;
+
+  // The payloads that were sent, as hex
+  const std::vector<std::vector<uint8_t> >& frames = generator.getFrames();
+
+  std::vector<std::string> lines;
+  for (unsigned int i = 0U; i < frames.size(); i++) {
+    std::string line;
+    for (unsigned int j = 0U; j < frames[i].size(); j++) {
+      char hex[4U];
+      ::sprintf(hex, j == 0U ? "%02X" : " %02X", frames[i][j]);
+      line += hex;
+    }
+
+    lines.push_back(line);
+  }
+
+  if (!writeLines(framesName, lines))
+    return false;
+
+  ::fprintf(stdout, "%s rx: created %s and %s\n", mode.name, inputName.c_str(), framesName.c_str());
+
+  return true;
+}
+
+// In IDLE every mode is listened for, otherwise only the mode given
+CModem* CGoldenTest::createModem(const GoldenMode& mode, bool idle)
+{
+  CModem* modem = new CModem;
+
+  modem->dstarEnable  = idle || mode.state == STATE_DSTAR;
+  modem->dmrEnable    = idle || mode.state == STATE_DMR;
+  modem->ysfEnable    = idle || mode.state == STATE_YSF;
+  modem->p25Enable    = idle || mode.state == STATE_P25;
+  modem->nxdnEnable   = idle || mode.state == STATE_NXDN;
+  modem->pocsagEnable = false;
+  modem->modemState   = idle ? STATE_IDLE : mode.state;
+
+  // The frames go to a pipe instead of the host
+  modem->serial.m_fd = m_pipe[1U];
+
+  modem->io.start();
+  modem->io.setMode();
+
+  if (idle) {
+    modem->io.setGate(true);
+    modem->io.setClassifier(true);
+  }
+
+  m_pending.clear();
+  m_received.clear();
+
+  return modem;
+}
+
+void CGoldenTest::receive(CModem* modem, const std::vector<float>& samples)
+{
+  unsigned int length = (samples.size() / BLOCK_LENGTH) * BLOCK_LENGTH;
+  for (unsigned int i = 0U; i < length; i += BLOCK_LENGTH) {
+    modem->io.readCallback(&samples[i], BLOCK_LENGTH);
+    modem->io.process();
+
+    if ((i % SAMPLE_RATE) == 0U)
+      drain();
+  }
+
+  drain();
+
+  delete modem;
+}
+
+// Keeps the complete frames written to the host
+void CGoldenTest::drain()
+{
+  uint8_t buffer[4096U];
+  ssize_t n;
+  while ((n = ::read(m_pipe[0U], buffer, sizeof(buffer))) > 0)
+    m_pending.insert(m_pending.end(), buffer, buffer + n);
+
+  unsigned int ptr = 0U;
+
+  while ((m_pending.size() - ptr) >= 3U) {
+    if (m_pending[ptr] != FRAME_START) {
+      ptr++;
+      continue;
+    }
+
+    unsigned int length = m_pending[ptr + 1U];
+    if (length < 3U) {
+      ptr++;
+      continue;
+    }
+
+    if ((m_pending.size() - ptr) < length)
+      break;
+
+    m_received.push_back(std::vector<uint8_t>(m_pending.begin() + ptr, m_pending.begin() + ptr + length));
+    ptr += length;
+  }
+
+  m_pending.erase(m_pending.begin(), m_pending.begin() + ptr);
+}
+
+bool CGoldenTest::readSamples(const std::string& fileName, std::vector<float>& samples) const
+{
+  CWAVFileReader reader(fileName);
+  if (!reader.open())
+    return false;
+
+  if (reader.getSampleRate() != SAMPLE_RATE || reader.getChannels() != 1U) {
+    ::fprintf(stderr, "%s is not mono at %u Hz\n", fileName.c_str(), SAMPLE_RATE);
+    return false;
+  }
+
+  samples.clear();
+
+  float buffer[1024U];
+  unsigned int n;
+  while ((n = reader.read(buffer, 1024U)) > 0U)
+    samples.insert(samples.end(), buffer, buffer + n);
+
+  reader.close();
+
+  return true;
+}
+
+bool CGoldenTest::writeSamples(const std::string& fileName, const std::vector<float>& samples) const
+{
+  CWAVFileWriter writer(fileName, SAMPLE_RATE, 1U);
+  if (!writer.open())
+    return false;
+
+  bool ret = writer.write(&samples[0U], samples.size());
+
+  writer.close();
+
+  return ret;
+}
+
+bool CGoldenTest::readLines(const std::string& fileName, std::vector<std::string>& lines) const
+{
+  FILE* fp = ::fopen(fileName.c_str(), "rt");
+  if (fp == NULL) {
+    ::fprintf(stderr, "Unable to open %s, run make golden first\n", fileName.c_str());
+    return false;
+  }
+
+  lines.clear();
+
+  char buffer[1024U];
+  while (::fgets(buffer, sizeof(buffer), fp) != NULL) {
+    buffer[::strcspn(buffer, "\r\n")] = '\0';
+    lines.push_back(buffer);
+  }
+
+  ::fclose(fp);
+
+  return true;
+}
+
+bool CGoldenTest::writeLines(const std::string& fileName, const std::vector<std::string>& lines) const
+{
+  FILE* fp = ::fopen(fileName.c_str(), "wt");
+  if (fp == NULL) {
+    ::fprintf(stderr, "Unable to create %s\n", fileName.c_str());
+    return false;
+  }
+
+  for (unsigned int i = 0U; i < lines.size(); i++)
+    ::fprintf(fp, "%s\n", lines[i].c_str());
+
+  ::fclose(fp);
+
+  return true;
+}
+
+std::string CGoldenTest::getFileName(const GoldenMode& mode, const char* suffix) const
+{
+  return m_directory + "/" + mode.name + suffix;
+}
+
+int main(int argc, char** argv)
+{
+  std::string directory("golden");
+  bool update = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (::strcmp("-update", argv[i]) == 0) {
+      update = true;
+    } else if (::strcmp("-dir", argv[i]) == 0 && (i + 1) < argc) {
+      directory = argv[++i];
+    } else {
+      ::fprintf(stderr, "Usage: MMDVMGolden [-update] [-dir <directory>]\n");
+      return 1;
+    }
+  }
+
+  CGoldenTest test(directory, update);
+  if (!test.open())
+    return 1;
+
+  unsigned int failures = test.run();
+  if (failures > 0U) {
+    ::fprintf(stdout, "%u checks failed\n", failures);
+    return 1;
+  }
+
+  return 0;
+}
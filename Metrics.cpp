@@ -0,0 +1,169 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Metrics.h"
+
+#include <cstring>
+
+const uint64_t PUBLISH_INTERVAL = 1000000000U;
+
+// In the order of TX_MODE
+static const char* TX_MODE_NAMES[TX_MODE_COUNT] = {
+  "dstar", "dmr", "ysf", "p25", "nxdn", "pocsag", "other"
+};
+
+CMetrics::CMetrics() :
+m_rxFrames(),
+m_rxLost(),
+m_rxSyncs(),
+m_rxSynced(),
+m_txSamples(),
+m_keyUps(),
+m_adcOverflows(),
+m_dacOverflows(),
+m_publishTime(0U),
+m_sequence(),
+m_snapshot()
+{
+  for (unsigned int i = 0U; i < RX_MODE_COUNT; i++) {
+    m_rxFrames[i].store(0U, std::memory_order_relaxed);
+    m_rxLost[i].store(0U, std::memory_order_relaxed);
+    m_rxSyncs[i].store(0U, std::memory_order_relaxed);
+    m_rxSynced[i].store(false, std::memory_order_relaxed);
+  }
+
+  for (unsigned int i = 0U; i < TX_MODE_COUNT; i++)
+    m_txSamples[i].store(0U, std::memory_order_relaxed);
+
+  m_keyUps.store(0U, std::memory_order_relaxed);
+  m_adcOverflows.store(0U, std::memory_order_relaxed);
+  m_dacOverflows.store(0U, std::memory_order_relaxed);
+
+  m_sequence.store(0U, std::memory_order_relaxed);
+  ::memset(&m_snapshot, 0x00U, sizeof(MetricsSnapshot));
+}
+
+// A sync is the first frame after the receiver lost or ended the last transmission
+void CMetrics::addFrame(RX_MODE mode, RX_FRAME frame)
+{
+  switch (frame) {
+    case RX_FRAME_DATA:
+      m_rxFrames[mode].fetch_add(1U, std::memory_order_relaxed);
+      if (!m_rxSynced[mode].exchange(true, std::memory_order_relaxed))
+        m_rxSyncs[mode].fetch_add(1U, std::memory_order_relaxed);
+      break;
+    case RX_FRAME_LOST:
+      m_rxLost[mode].fetch_add(1U, std::memory_order_relaxed);
+      m_rxSynced[mode].store(false, std::memory_order_relaxed);
+      break;
+    default:
+      m_rxSynced[mode].store(false, std::memory_order_relaxed);
+      break;
+  }
+}
+
+void CMetrics::addTX(TX_MODE mode, uint32_t samples)
+{
+  m_txSamples[mode].fetch_add(samples, std::memory_order_relaxed);
+}
+
+void CMetrics::addKeyUp()
+{
+  m_keyUps.fetch_add(1U, std::memory_order_relaxed);
+}
+
+void CMetrics::addADCOverflow()
+{
+  m_adcOverflows.fetch_add(1U, std::memory_order_relaxed);
+}
+
+void CMetrics::addDACOverflow()
+{
+  m_dacOverflows.fetch_add(1U, std::memory_order_relaxed);
+}
+
+void CMetrics::publish(const CAudioStats& audio, const CActivityGate& gate, const CStageStats* stages)
+{
+  uint64_t time = CStageStats::now();
+  if (m_publishTime != 0U && (time - m_publishTime) < PUBLISH_INTERVAL)
+    return;
+
+  m_publishTime = time;
+
+  // Only this thread writes the snapshot, the readers retry if they overlap with it
+  uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+  m_sequence.store(sequence + 1U, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  for (unsigned int i = 0U; i < RX_MODE_COUNT; i++) {
+    m_snapshot.rxFrames[i] = m_rxFrames[i].load(std::memory_order_relaxed);
+    m_snapshot.rxLost[i]   = m_rxLost[i].load(std::memory_order_relaxed);
+    m_snapshot.rxSyncs[i]  = m_rxSyncs[i].load(std::memory_order_relaxed);
+  }
+
+  for (unsigned int i = 0U; i < TX_MODE_COUNT; i++)
+    m_snapshot.txSamples[i] = m_txSamples[i].load(std::memory_order_relaxed);
+
+  m_snapshot.keyUps       = m_keyUps.load(std::memory_order_relaxed);
+  m_snapshot.adcOverflows = m_adcOverflows.load(std::memory_order_relaxed);
+  m_snapshot.dacOverflows = m_dacOverflows.load(std::memory_order_relaxed);
+
+  m_snapshot.rxLevel     = audio.getRXLevel();
+  m_snapshot.rxHighWater = audio.getRXHighWater();
+  m_snapshot.rxLength    = audio.getRXLength();
+  m_snapshot.txLevel     = audio.getTXLevel();
+  m_snapshot.txHighWater = audio.getTXHighWater();
+  m_snapshot.txLength    = audio.getTXLength();
+
+  for (unsigned int i = 0U; i < AUDIO_EVENT_COUNT; i++) {
+    m_snapshot.audioEvents[i]  = audio.getEvents(AUDIO_EVENT(i));
+    m_snapshot.audioSamples[i] = audio.getSamples(AUDIO_EVENT(i));
+  }
+
+  gate.getStats(m_snapshot.gateSkipped, m_snapshot.gateProcessed, m_snapshot.gateCloses);
+
+  m_snapshot.hasStages = stages != NULL;
+  if (stages != NULL) {
+    for (unsigned int i = 0U; i < STAGE_COUNT; i++) {
+      m_snapshot.stageTime[i]  = stages->getTotalTime(STATS_STAGE(i));
+      m_snapshot.stageCalls[i] = stages->getTotalCalls(STATS_STAGE(i));
+    }
+  }
+
+  m_sequence.store(sequence + 2U, std::memory_order_release);
+}
+
+void CMetrics::read(MetricsSnapshot& snapshot) const
+{
+  for (;;) {
+    uint32_t before = m_sequence.load(std::memory_order_acquire);
+
+    if ((before & 1U) == 0U) {
+      ::memcpy(&snapshot, &m_snapshot, sizeof(MetricsSnapshot));
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      if (m_sequence.load(std::memory_order_relaxed) == before)
+        return;
+    }
+  }
+}
+
+const char* CMetrics::getName(TX_MODE mode)
+{
+  return TX_MODE_NAMES[mode];
+}
@@ -0,0 +1,112 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(METRICS_H)
+#define  METRICS_H
+
+#include "ActivityGate.h"
+#include "AudioStats.h"
+#include "StageStats.h"
+
+#include <atomic>
+#include <cstdint>
+
+// The transmitters, for the air time
+enum TX_MODE {
+  TX_MODE_DSTAR,
+  TX_MODE_DMR,
+  TX_MODE_YSF,
+  TX_MODE_P25,
+  TX_MODE_NXDN,
+  TX_MODE_POCSAG,
+  TX_MODE_OTHER,      // The CW ID and calibration
+  TX_MODE_COUNT
+};
+
+// What a frame to the host says about its receiver
+enum RX_FRAME {
+  RX_FRAME_DATA,
+  RX_FRAME_LOST,
+  RX_FRAME_END
+};
+
+// Everything in one consistent copy, for the metrics thread
+struct MetricsSnapshot {
+  uint64_t rxFrames[RX_MODE_COUNT];
+  uint64_t rxLost[RX_MODE_COUNT];
+  uint64_t rxSyncs[RX_MODE_COUNT];
+  uint64_t txSamples[TX_MODE_COUNT];
+  uint64_t keyUps;
+  uint64_t adcOverflows;
+  uint64_t dacOverflows;
+
+  uint16_t rxLevel;
+  uint16_t rxHighWater;
+  uint16_t rxLength;
+  uint16_t txLevel;
+  uint16_t txHighWater;
+  uint16_t txLength;
+  uint32_t audioEvents[AUDIO_EVENT_COUNT];
+  uint32_t audioSamples[AUDIO_EVENT_COUNT];
+
+  uint32_t gateSkipped;
+  uint32_t gateProcessed;
+  uint32_t gateCloses;
+
+  bool     hasStages;
+  uint64_t stageTime[STAGE_COUNT];
+  uint64_t stageCalls[STAGE_COUNT];
+};
+
+// Counters that any modem thread may add to without a lock. The main loop
+// publishes them, with the ring and stage figures, behind a sequence lock so
+// that reading them never holds up the modem.
+class CMetrics {
+public:
+  CMetrics();
+
+  void addFrame(RX_MODE mode, RX_FRAME frame);
+  void addTX(TX_MODE mode, uint32_t samples);
+  void addKeyUp();
+  void addADCOverflow();
+  void addDACOverflow();
+
+  // From the main loop, copies everything at most once a second
+  void publish(const CAudioStats& audio, const CActivityGate& gate, const CStageStats* stages);
+
+  // From any other thread, never blocks the publisher
+  void read(MetricsSnapshot& snapshot) const;
+
+  static const char* getName(TX_MODE mode);
+
+private:
+  std::atomic<uint64_t> m_rxFrames[RX_MODE_COUNT];
+  std::atomic<uint64_t> m_rxLost[RX_MODE_COUNT];
+  std::atomic<uint64_t> m_rxSyncs[RX_MODE_COUNT];
+  std::atomic<bool>     m_rxSynced[RX_MODE_COUNT];
+  std::atomic<uint64_t> m_txSamples[TX_MODE_COUNT];
+  std::atomic<uint64_t> m_keyUps;
+  std::atomic<uint64_t> m_adcOverflows;
+  std::atomic<uint64_t> m_dacOverflows;
+
+  uint64_t              m_publishTime;
+  std::atomic<uint32_t> m_sequence;       // Odd while the snapshot is being written
+  MetricsSnapshot       m_snapshot;
+};
+
+#endif
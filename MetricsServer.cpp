@@ -0,0 +1,294 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "MetricsServer.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// How long a client has to send its request, a bare connection gets the metrics without HTTP
+const int REQUEST_TIMEOUT = 200;
+
+const double SAMPLE_RATE = 48000.0;
+
+CMetricsServer::CMetricsServer(const std::string& address) :
+CThread(),
+m_address(address),
+m_fd(-1),
+m_names(),
+m_metrics()
+{
+}
+
+CMetricsServer::~CMetricsServer()
+{
+}
+
+void CMetricsServer::addModem(const std::string& name, const CMetrics* metrics)
+{
+  m_names.push_back(name);
+  m_metrics.push_back(metrics);
+}
+
+bool CMetricsServer::open()
+{
+  bool tcp = !m_address.empty() && m_address.find_first_not_of("0123456789") == std::string::npos;
+
+  if (tcp) {
+    m_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (m_fd == -1) {
+      ::fprintf(stderr, "Unable to create the metrics socket, errno=%d\n", errno);
+      return false;
+    }
+
+    int reuse = 1;
+    ::setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    ::memset(&addr, 0x00U, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(::atoi(m_address.c_str()));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (::bind(m_fd, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+      ::fprintf(stderr, "Unable to bind the metrics to port %s, errno=%d\n", m_address.c_str(), errno);
+      ::close(m_fd);
+      return false;
+    }
+  } else {
+    m_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_fd == -1) {
+      ::fprintf(stderr, "Unable to create the metrics socket, errno=%d\n", errno);
+      return false;
+    }
+
+    struct sockaddr_un addr;
+    ::memset(&addr, 0x00U, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    ::strncpy(addr.sun_path, m_address.c_str(), sizeof(addr.sun_path) - 1U);
+
+    // A socket left by an earlier run is replaced
+    ::unlink(m_address.c_str());
+
+    if (::bind(m_fd, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+      ::fprintf(stderr, "Unable to bind the metrics to %s, errno=%d\n", m_address.c_str(), errno);
+      ::close(m_fd);
+      return false;
+    }
+  }
+
+  if (::listen(m_fd, 4) == -1) {
+    ::fprintf(stderr, "Unable to listen for metrics clients, errno=%d\n", errno);
+    ::close(m_fd);
+    return false;
+  }
+
+  ::printf("Serving the metrics on %s\n", m_address.c_str());
+
+  return run();
+}
+
+void CMetricsServer::entry()
+{
+  for (;;) {
+    int fd = ::accept(m_fd, NULL, NULL);
+    if (fd == -1) {
+      if (errno != EINTR)
+        ::fprintf(stderr, "Unable to accept a metrics client, errno=%d\n", errno);
+      continue;
+    }
+
+    serve(fd);
+
+    ::close(fd);
+  }
+}
+
+// Prometheus scrapes with HTTP, anything else is sent the bare text
+void CMetricsServer::serve(int fd)
+{
+  char request[512U];
+  ssize_t n = 0;
+
+  struct pollfd pfd;
+  pfd.fd     = fd;
+  pfd.events = POLLIN;
+  if (::poll(&pfd, 1, REQUEST_TIMEOUT) > 0)
+    n = ::recv(fd, request, sizeof(request) - 1U, 0);
+
+  std::string text = format();
+
+  std::string reply;
+  if (n >= 4 && ::memcmp(request, "GET ", 4U) == 0) {
+    char header[200U];
+    ::snprintf(header, sizeof(header), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %u\r\nConnection: close\r\n\r\n", (unsigned int)text.size());
+    reply = header;
+  }
+
+  reply += text;
+
+  size_t ptr = 0U;
+  while (ptr < reply.size()) {
+    ssize_t ret = ::send(fd, reply.c_str() + ptr, reply.size() - ptr, MSG_NOSIGNAL);
+    if (ret <= 0)
+      return;
+
+    ptr += ret;
+  }
+}
+
+static void addHeader(std::string& text, const char* name, const char* type, const char* help)
+{
+  text += "# HELP ";
+  text += name;
+  text += " ";
+  text += help;
+  text += "\n# TYPE ";
+  text += name;
+  text += " ";
+  text += type;
+  text += "\n";
+}
+
+static void addValue(std::string& text, const char* name, const std::string& modem, const char* label, const char* value, double number)
+{
+  char buffer[300U];
+
+  if (label == NULL)
+    ::snprintf(buffer, sizeof(buffer), "%s{modem=\"%s\"} %.17g\n", name, modem.c_str(), number);
+  else
+    ::snprintf(buffer, sizeof(buffer), "%s{modem=\"%s\",%s=\"%s\"} %.17g\n", name, modem.c_str(), label, value, number);
+
+  text += buffer;
+}
+
+std::string CMetricsServer::format() const
+{
+  std::vector<MetricsSnapshot> snapshots(m_metrics.size());
+  for (unsigned int i = 0U; i < m_metrics.size(); i++)
+    m_metrics[i]->read(snapshots[i]);
+
+  std::string text;
+
+  addHeader(text, "mmdvm_rx_frames_total", "counter", "Frames decoded and sent to the host.");
+  for (unsigned int i = 0U; i < snapshots.size(); i++) {
+    for (unsigned int j = 0U; j < RX_MODE_COUNT; j++)
+      addValue(text, "mmdvm_rx_frames_total", m_names[i], "mode", CStageStats::getName(RX_MODE(j)), double(snapshots[i].rxFrames[j]));
+  }
+
+  addHeader(text, "mmdvm_rx_lost_total", "counter", "Transmissions whose signal was lost.");
+  for (unsigned int i = 0U; i < snapshots.size(); i++) {
+    for (unsigned int j = 0U; j < RX_MODE_COUNT; j++)
+      addValue(text, "mmdvm_rx_lost_total", m_names[i], "mode", CStageStats::getName(RX_MODE(j)), double(snapshots[i].rxLost[j]));
+  }
+
+  addHeader(text, "mmdvm_rx_syncs_total", "counter", "Transmissions picked up, the first frame after a loss or an end.");
+  for (unsigned int i = 0U; i < snapshots.size(); i++) {
+    for (unsigned int j = 0U; j < RX_MODE_COUNT; j++)
+      addValue(text, "mmdvm_rx_syncs_total", m_names[i], "mode", CStageStats::getName(RX_MODE(j)), double(snapshots[i].rxSyncs[j]));
+  }
+
+  addHeader(text, "mmdvm_tx_airtime_seconds_total", "counter", "Time spent transmitting each mode.");
+  for (unsigned int i = 0U; i < snapshots.size(); i++) {
+    for (unsigned int j = 0U; j < TX_MODE_COUNT; j++)
+      addValue(text, "mmdvm_tx_airtime_seconds_total", m_names[i], "mode", CMetrics::getName(TX_MODE(j)), double(snapshots[i].txSamples[j]) / SAMPLE_RATE);
+  }
+
+  addHeader(text, "mmdvm_ptt_keyups_total", "counter", "Times the transmitter was keyed.");
+  for (unsigned int i = 0U; i < snapshots.size(); i++)
+    addValue(text, "mmdvm_ptt_keyups_total", m_names[i], NULL, NULL, double(snapshots[i].keyUps));
+
+  addHeader(text, "mmdvm_adc_overflows_total", "counter", "Received samples at full scale.");
+  for (unsigned int i = 0U; i < snapshots.size(); i++)
+    addValue(text, "mmdvm_adc_overflows_total", m_names[i], NULL, NULL, double(snapshots[i].adcOverflows));
+
+  addHeader(text, "mmdvm_dac_overflows_total", "counter", "Transmitted samples beyond full scale.");
+  for (unsigned int i = 0U; i < snapshots.size(); i++)
+    addValue(text, "mmdvm_dac_overflows_total", m_names[i], NULL, NULL, double(snapshots[i].dacOverflows));
+
+  addHeader(text, "mmdvm_ring_level_samples", "gauge", "Samples waiting in the ring.");
+  for (unsigned int i = 0U; i < snapshots.size(); i++) {
+    addValue(text, "mmdvm_ring_level_samples", m_names[i], "ring", "rx", snapshots[i].rxLevel);
+    addValue(text, "mmdvm_ring_level_samples", m_names[i], "ring", "tx", snapshots[i].txLevel);
+  }
+
+  addHeader(text, "mmdvm_ring_high_water_samples", "gauge", "The most samples ever waiting in the ring.");
+  for (unsigned int i = 0U; i < snapshots.size(); i++) {
+    addValue(text, "mmdvm_ring_high_water_samples", m_names[i], "ring", "rx", snapshots[i].rxHighWater);
+    addValue(text, "mmdvm_ring_high_water_samples", m_names[i], "ring", "tx", snapshots[i].txHighWater);
+  }
+
+  addHeader(text, "mmdvm_ring_length_samples", "gauge", "The size of the ring.");
+  for (unsigned int i = 0U; i < snapshots.size(); i++) {
+    addValue(text, "mmdvm_ring_length_samples", m_names[i], "ring", "rx", snapshots[i].rxLength);
+    addValue(text, "mmdvm_ring_length_samples", m_names[i], "ring", "tx", snapshots[i].txLength);
+  }
+
+  addHeader(text, "mmdvm_audio_events_total", "counter", "Ring overflows and underruns and sound card xruns.");
+  for (unsigned int i = 0U; i < snapshots.size(); i++) {
+    for (unsigned int j = 0U; j < AUDIO_EVENT_COUNT; j++)
+      addValue(text, "mmdvm_audio_events_total", m_names[i], "event", CAudioStats::getName(AUDIO_EVENT(j)), snapshots[i].audioEvents[j]);
+  }
+
+  addHeader(text, "mmdvm_audio_lost_samples_total", "counter", "Samples lost to ring overflows and underruns.");
+  for (unsigned int i = 0U; i < snapshots.size(); i++) {
+    for (unsigned int j = 0U; j < AUDIO_EVENT_COUNT; j++)
+      addValue(text, "mmdvm_audio_lost_samples_total", m_names[i], "event", CAudioStats::getName(AUDIO_EVENT(j)), snapshots[i].audioSamples[j]);
+  }
+
+  addHeader(text, "mmdvm_gate_blocks_total", "counter", "Receive blocks kept from or given to the IDLE demodulators by the activity gate.");
+  for (unsigned int i = 0U; i < snapshots.size(); i++) {
+    addValue(text, "mmdvm_gate_blocks_total", m_names[i], "state", "skipped", snapshots[i].gateSkipped);
+    addValue(text, "mmdvm_gate_blocks_total", m_names[i], "state", "processed", snapshots[i].gateProcessed);
+  }
+
+  addHeader(text, "mmdvm_gate_closes_total", "counter", "Times the activity gate has closed on a quiet channel.");
+  for (unsigned int i = 0U; i < snapshots.size(); i++)
+    addValue(text, "mmdvm_gate_closes_total", m_names[i], NULL, NULL, snapshots[i].gateCloses);
+
+  // Only a STAGE_STATS build times the stages
+  bool stages = false;
+  for (unsigned int i = 0U; i < snapshots.size(); i++)
+    stages = stages || snapshots[i].hasStages;
+
+  if (stages) {
+    addHeader(text, "mmdvm_stage_seconds_total", "counter", "CPU time spent in each stage.");
+    for (unsigned int i = 0U; i < snapshots.size(); i++) {
+      for (unsigned int j = 0U; j < STAGE_COUNT; j++)
+        addValue(text, "mmdvm_stage_seconds_total", m_names[i], "stage", CStageStats::getName(STATS_STAGE(j)), double(snapshots[i].stageTime[j]) / 1e9);
+    }
+
+    addHeader(text, "mmdvm_stage_calls_total", "counter", "Calls into each stage.");
+    for (unsigned int i = 0U; i < snapshots.size(); i++) {
+      for (unsigned int j = 0U; j < STAGE_COUNT; j++)
+        addValue(text, "mmdvm_stage_calls_total", m_names[i], "stage", CStageStats::getName(STATS_STAGE(j)), double(snapshots[i].stageCalls[j]));
+    }
+  }
+
+  return text;
+}
@@ -0,0 +1,53 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(METRICSSERVER_H)
+#define  METRICSSERVER_H
+
+#include "Metrics.h"
+#include "Thread.h"
+
+#include <string>
+#include <vector>
+
+// Serves the metrics of every modem in the Prometheus text format, on a Unix
+// socket or a loopback TCP port. It runs on its own thread and only reads the
+// published snapshots.
+class CMetricsServer : public CThread {
+public:
+  // A path for a Unix socket, or a port number for TCP on 127.0.0.1
+  CMetricsServer(const std::string& address);
+  virtual ~CMetricsServer();
+
+  void addModem(const std::string& name, const CMetrics* metrics);
+
+  bool open();
+
+  virtual void entry();
+
+private:
+  std::string                    m_address;
+  int                            m_fd;
+  std::vector<std::string>       m_names;
+  std::vector<const CMetrics*>   m_metrics;
+
+  void serve(int fd);
+  std::string format() const;
+};
+
+#endif
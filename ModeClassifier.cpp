@@ -0,0 +1,239 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "ModeClassifier.h"
+
+#include <cmath>
+
+// Zero crossings per 48 kHz sample after the filter, random data crosses at about
+// half the symbol rate. Between the two rates the signal may be either.
+const float FAST_CROSSING_RATE = 0.040F;   // 4800 baud, 0.036 to 0.061 seen
+const float SLOW_CROSSING_RATE = 0.030F;   // 2400 baud, 0.020 to 0.032 seen
+
+// E[x^4] / E[x^2]^2 after the filter, 1.33 to 1.72 for GMSK and 1.78 to 2.39
+// for 4FSK down to 3 dB SNR. Between the two the signal may be either.
+const float TWO_LEVEL_RATIO  = 1.60F;
+const float FOUR_LEVEL_RATIO = 1.75F;
+
+// The preambles are tones, with evenly spaced zero crossings. Their intervals
+// vary by less than this fraction of the mean down to 3 dB SNR, data by more than 0.3
+const float TONE_VARIATION = 0.28F;
+
+// Of the RMS level of the last window, so that noise does not add crossings
+const float HYSTERESIS_LEVEL = 0.25F;
+
+// 10ms windows, four in a row after the preamble are classified together
+const uint16_t WINDOW_SAMPLES   = RX_SAMPLE_RATE / 100U;
+const uint8_t  CLASSIFY_WINDOWS = 4U;
+
+// Fewer crossings in a window than this say nothing about it
+const uint16_t MIN_INTERVALS = 4U;
+
+// The activity gate's -40 dBFS, scaled for the moving sum, below it is the noise before the signal
+const float MIN_ENERGY = 0.0001F * float(CLASSIFY_FILTER_LENGTH * CLASSIFY_FILTER_LENGTH);
+
+// A second, longer than any preamble, after which every receiver is kept
+const uint8_t  MAX_WINDOWS = 100U;
+
+CModeClassifier::CModeClassifier() :
+m_filter(),
+m_filterPtr(0U),
+m_filterSum(0.0F),
+m_positive(true),
+m_hysteresis(0.0F),
+m_interval(0U),
+m_count(0U),
+m_energy(0.0F),
+m_energy4(0.0F),
+m_crossings(0U),
+m_intervals(0U),
+m_intervalSum(0.0F),
+m_intervalSum2(0.0F),
+m_totalEnergy(0.0F),
+m_totalEnergy4(0.0F),
+m_totalCrossings(0U),
+m_totalCount(0U),
+m_dataWindows(0U),
+m_lastData(false),
+m_windows(0U),
+m_done(false),
+m_classes(CLASS_ALL),
+m_dstar(0U),
+m_fsk(0U),
+m_nxdn(0U),
+m_unknown(0U)
+{
+}
+
+void CModeClassifier::reset()
+{
+  for (uint16_t i = 0U; i < CLASSIFY_FILTER_LENGTH; i++)
+    m_filter[i] = 0.0F;
+
+  m_filterPtr      = 0U;
+  m_filterSum      = 0.0F;
+  m_positive       = true;
+  m_hysteresis     = 0.0F;
+  m_interval       = 0U;
+  m_count          = 0U;
+  m_energy         = 0.0F;
+  m_energy4        = 0.0F;
+  m_crossings      = 0U;
+  m_intervals      = 0U;
+  m_intervalSum    = 0.0F;
+  m_intervalSum2   = 0.0F;
+  m_totalEnergy    = 0.0F;
+  m_totalEnergy4   = 0.0F;
+  m_totalCrossings = 0U;
+  m_totalCount     = 0U;
+  m_dataWindows    = 0U;
+  m_lastData       = false;
+  m_windows        = 0U;
+  m_done           = false;
+  m_classes        = CLASS_ALL;
+}
+
+uint8_t CModeClassifier::process(const float* samples, uint16_t length)
+{
+  for (uint16_t i = 0U; i < length && !m_done; i++) {
+    // A moving sum, its scale does not matter here
+    m_filterSum += samples[i] - m_filter[m_filterPtr];
+    m_filter[m_filterPtr] = samples[i];
+
+    m_filterPtr++;
+    if (m_filterPtr >= CLASSIFY_FILTER_LENGTH)
+      m_filterPtr = 0U;
+
+    float sample  = m_filterSum;
+    float sample2 = sample * sample;
+    m_energy  += sample2;
+    m_energy4 += sample2 * sample2;
+
+    m_interval++;
+    if (m_positive ? (sample < -m_hysteresis) : (sample > m_hysteresis)) {
+      m_positive = !m_positive;
+
+      if (m_crossings > 0U) {
+        m_intervalSum  += float(m_interval);
+        m_intervalSum2 += float(m_interval) * float(m_interval);
+        m_intervals++;
+      }
+
+      m_crossings++;
+      m_interval = 0U;
+    }
+
+    m_count++;
+    if (m_count >= WINDOW_SAMPLES)
+      endWindow();
+  }
+
+  return m_classes;
+}
+
+void CModeClassifier::endWindow()
+{
+  m_hysteresis = HYSTERESIS_LEVEL * ::sqrtf(m_energy / float(m_count));
+
+  // Anything but a tone or the noise, after the preamble
+  bool data = false;
+  if (m_intervals >= MIN_INTERVALS && m_energy >= (MIN_ENERGY * float(m_count))) {
+    float mean     = m_intervalSum / float(m_intervals);
+    float variance = m_intervalSum2 / float(m_intervals) - mean * mean;
+    data = variance > (TONE_VARIATION * TONE_VARIATION * mean * mean);
+  }
+
+  // The first window may only be partly filled by the signal, so it is left out
+  if (data && m_lastData) {
+    m_totalEnergy    += m_energy;
+    m_totalEnergy4   += m_energy4;
+    m_totalCrossings += m_crossings;
+    m_totalCount     += m_count;
+    m_dataWindows++;
+  } else {
+    m_totalEnergy    = 0.0F;
+    m_totalEnergy4   = 0.0F;
+    m_totalCrossings = 0U;
+    m_totalCount     = 0U;
+    m_dataWindows    = 0U;
+  }
+
+  m_lastData = data;
+  m_windows++;
+
+  if (m_dataWindows >= CLASSIFY_WINDOWS) {
+    m_classes = classify();
+    m_done    = true;
+
+    if (m_classes == CLASS_DSTAR)
+      m_dstar++;
+    else if (m_classes == CLASS_4FSK)
+      m_fsk++;
+    else if (m_classes == CLASS_NXDN)
+      m_nxdn++;
+    else
+      m_unknown++;
+  } else if (m_windows >= MAX_WINDOWS) {
+    m_classes = CLASS_ALL;
+    m_done    = true;
+    m_unknown++;
+  }
+
+  m_count        = 0U;
+  m_energy       = 0.0F;
+  m_energy4      = 0.0F;
+  m_crossings    = 0U;
+  m_intervals    = 0U;
+  m_intervalSum  = 0.0F;
+  m_intervalSum2 = 0.0F;
+}
+
+uint8_t CModeClassifier::classify() const
+{
+  if (m_totalEnergy <= 0.0F)
+    return CLASS_ALL;
+
+  float rate  = float(m_totalCrossings) / float(m_totalCount * RX_DECIMATION);
+  float ratio = (m_totalEnergy4 * float(m_totalCount)) / (m_totalEnergy * m_totalEnergy);
+
+  bool fast = rate > SLOW_CROSSING_RATE;
+  bool slow = rate < FAST_CROSSING_RATE;
+  bool two  = ratio < FOUR_LEVEL_RATIO;
+  bool four = ratio > TWO_LEVEL_RATIO;
+
+  uint8_t classes = 0U;
+  if (fast && two)
+    classes |= CLASS_DSTAR;
+  if (fast && four)
+    classes |= CLASS_4FSK;
+  if (slow)
+    classes |= CLASS_NXDN;
+
+  if (classes == 0U)
+    return CLASS_ALL;
+
+  return classes;
+}
+
+void CModeClassifier::getStats(uint32_t& dstar, uint32_t& fsk, uint32_t& nxdn, uint32_t& unknown) const
+{
+  dstar   = m_dstar;
+  fsk     = m_fsk;
+  nxdn    = m_nxdn;
+  unknown = m_unknown;
+}
@@ -0,0 +1,80 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(MODECLASSIFIER_H)
+#define  MODECLASSIFIER_H
+
+#include "RXRate.h"
+
+#include <cstdint>
+
+const uint8_t CLASS_DSTAR = 0x01U;    // GMSK at 4800 baud
+const uint8_t CLASS_4FSK  = 0x02U;    // 4FSK at 4800 baud, DMR, YSF and P25
+const uint8_t CLASS_NXDN  = 0x04U;    // 4FSK at 2400 baud
+const uint8_t CLASS_ALL   = 0x07U;
+
+// One 4800 baud symbol, to take the noise above the signal out of the statistics
+const uint16_t CLASSIFY_FILTER_LENGTH = RX_SAMPLE_RATE / 4800U;
+
+class CModeClassifier {
+public:
+  CModeClassifier();
+
+  // For a new signal, which may be of any class until it has been classified
+  void reset();
+
+  // Returns the classes that the signal may belong to. That is CLASS_ALL until
+  // several windows after the preamble have been seen, and for good if they
+  // leave it uncertain or never come
+  uint8_t process(const float* samples, uint16_t length);
+
+  void getStats(uint32_t& dstar, uint32_t& fsk, uint32_t& nxdn, uint32_t& unknown) const;
+
+private:
+  float    m_filter[CLASSIFY_FILTER_LENGTH];
+  uint16_t m_filterPtr;
+  float    m_filterSum;
+  bool     m_positive;
+  float    m_hysteresis;
+  uint16_t m_interval;
+  uint16_t m_count;
+  float    m_energy;
+  float    m_energy4;
+  uint16_t m_crossings;
+  uint16_t m_intervals;
+  float    m_intervalSum;
+  float    m_intervalSum2;
+  float    m_totalEnergy;
+  float    m_totalEnergy4;
+  uint32_t m_totalCrossings;
+  uint16_t m_totalCount;
+  uint8_t  m_dataWindows;
+  bool     m_lastData;
+  uint8_t  m_windows;
+  bool     m_done;
+  uint8_t  m_classes;
+  uint32_t m_dstar;
+  uint32_t m_fsk;
+  uint32_t m_nxdn;
+  uint32_t m_unknown;
+
+  void endWindow();
+  uint8_t classify() const;
+};
+
+#endif
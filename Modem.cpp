@@ -0,0 +1,251 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Modem.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+CModem::CModem() :
+CThread(),
+modemState(STATE_IDLE),
+dstarEnable(true),
+dmrEnable(true),
+ysfEnable(true),
+p25Enable(true),
+nxdnEnable(true),
+pocsagEnable(true),
+duplex(true),
+tx(false),
+dcd(false),
+serial(*this),
+io(*this),
+#if defined(MODE_DSTAR)
+dstarRX(*this),
+dstarTX(*this),
+#endif
+#if defined(MODE_DMR)
+dmrDMORX(*this),
+dmrDMOTX(*this),
+#endif
+#if defined(MODE_YSF)
+ysfRX(*this),
+ysfTX(*this),
+#endif
+#if defined(MODE_P25)
+p25RX(*this),
+p25TX(*this),
+#endif
+#if defined(MODE_NXDN)
+nxdnRX(*this),
+nxdnTX(*this),
+#endif
+#if defined(MODE_POCSAG)
+pocsagTX(*this),
+#endif
+#if defined(MODE_DSTAR)
+calDStarRX(*this),
+calDStarTX(*this),
+#endif
+#if defined(MODE_DMR)
+calDMR(*this),
+#endif
+#if defined(MODE_P25)
+calP25(*this),
+#endif
+#if defined(MODE_NXDN)
+calNXDN(*this),
+#endif
+#if defined(MODE_POCSAG)
+calPOCSAG(*this),
+#endif
+cwIdTX(*this),
+#if defined(STAGE_STATS)
+stats(),
+#endif
+metrics(),
+debug(),
+m_cpu(-1),
+m_ptyPath(),
+m_statsFile()
+{
+}
+
+bool CModem::open(const std::string& ptyPath)
+{
+  m_ptyPath = ptyPath;
+
+  serial.setPtyPath(ptyPath);
+  bool ret = serial.open();
+  if (!ret) {
+    ::fprintf(stderr, "Unable to open serial port on vpty: %s\n", ptyPath.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+void CModem::setCPU(int cpu)
+{
+  m_cpu = cpu;
+}
+
+void CModem::setStatsFile(const std::string& fileName)
+{
+  m_statsFile = fileName;
+}
+
+bool CModem::setDebugFile(const std::string& fileName)
+{
+  return debug.setFile(fileName);
+}
+
+void CModem::process()
+{
+  STATS_START(loopStart);
+
+  STATS_START(hostStart);
+  serial.process();
+  STATS_STOP(stats, hostStart, STAGE_HOST);
+
+  io.process();
+
+  processTX();
+
+  STATS_STOP(stats, loopStart, STAGE_LOOP);
+
+  io.logAudioStats(m_ptyPath);
+
+#if defined(STAGE_STATS)
+  metrics.publish(io.getAudioStats(), io.getGate(), &stats);
+#else
+  metrics.publish(io.getAudioStats(), io.getGate(), NULL);
+#endif
+
+#if defined(STAGE_STATS)
+  if (stats.update() && !m_statsFile.empty()) {
+    if (!stats.writeFile(m_statsFile))
+      ::fprintf(stderr, "Unable to write the stage timings to %s\n", m_statsFile.c_str());
+  }
+#endif
+}
+
+void CModem::processTX()
+{
+#if defined(MODE_DSTAR)
+  if (dstarEnable && modemState == STATE_DSTAR) {
+    STATS_START(start);
+    dstarTX.process();
+    STATS_STOP(stats, start, STAGE_TX_DSTAR);
+  }
+#endif
+
+#if defined(MODE_DMR)
+  if (dmrEnable && modemState == STATE_DMR) {
+    STATS_START(start);
+    dmrDMOTX.process();
+    STATS_STOP(stats, start, STAGE_TX_DMR);
+  }
+#endif
+
+#if defined(MODE_YSF)
+  if (ysfEnable && modemState == STATE_YSF) {
+    STATS_START(start);
+    ysfTX.process();
+    STATS_STOP(stats, start, STAGE_TX_YSF);
+  }
+#endif
+
+#if defined(MODE_P25)
+  if (p25Enable && modemState == STATE_P25) {
+    STATS_START(start);
+    p25TX.process();
+    STATS_STOP(stats, start, STAGE_TX_P25);
+  }
+#endif
+
+#if defined(MODE_NXDN)
+  if (nxdnEnable && modemState == STATE_NXDN) {
+    STATS_START(start);
+    nxdnTX.process();
+    STATS_STOP(stats, start, STAGE_TX_NXDN);
+  }
+#endif
+
+#if defined(MODE_POCSAG)
+  if (pocsagEnable && (modemState == STATE_POCSAG || pocsagTX.busy())) {
+    STATS_START(start);
+    pocsagTX.process();
+    STATS_STOP(stats, start, STAGE_TX_POCSAG);
+  }
+#endif
+
+  // Calibration and the CW ID are timed together
+  STATS_START(otherStart);
+
+#if defined(MODE_DSTAR)
+  if (modemState == STATE_DSTARCAL)
+    calDStarTX.process();
+#endif
+
+#if defined(MODE_DMR)
+  if (modemState == STATE_DMRCAL || modemState == STATE_LFCAL || modemState == STATE_DMRDMO1K)
+    calDMR.process();
+#endif
+
+#if defined(MODE_P25)
+  if (modemState == STATE_P25CAL1K)
+    calP25.process();
+#endif
+
+#if defined(MODE_NXDN)
+  if (modemState == STATE_NXDNCAL1K)
+    calNXDN.process();
+#endif
+
+#if defined(MODE_POCSAG)
+  if (modemState == STATE_CALPOCSAG)
+    calPOCSAG.process();
+#endif
+
+  if (modemState == STATE_IDLE)
+    cwIdTX.process();
+
+  STATS_STOP(stats, otherStart, STAGE_TX_OTHER);
+}
+
+void CModem::entry()
+{
+#if defined(__linux__)
+  if (m_cpu >= 0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(m_cpu, &cpus);
+
+    if (::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set_t), &cpus) != 0)
+      ::fprintf(stderr, "Unable to run the modem on CPU %d\n", m_cpu);
+  }
+#endif
+
+  for (;;) {
+    process();
+    CThread::sleep(5U);
+  }
+}
@@ -0,0 +1,133 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(MODEM_H)
+#define  MODEM_H
+
+#include "Globals.h"
+#include "DebugLog.h"
+#include "Metrics.h"
+#include "StageStats.h"
+#include "Thread.h"
+
+#include <string>
+
+// Everything that one modem needs, so that a process can run one per sound card and pty
+class CModem : public CThread {
+public:
+  CModem();
+
+  // The sound card is opened separately, with io as its callback
+  bool open(const std::string& ptyPath);
+
+  // Run on the given CPU, or anywhere if negative
+  void setCPU(int cpu);
+
+  // Where to write the stage timings each second, needs a STAGE_STATS build
+  void setStatsFile(const std::string& fileName);
+
+  // Where to write the debug messages instead of sending them to the host
+  bool setDebugFile(const std::string& fileName);
+
+  // One pass of the main loop
+  void process();
+
+  virtual void entry();
+
+  MMDVM_STATE modemState;
+
+  bool        dstarEnable;
+  bool        dmrEnable;
+  bool        ysfEnable;
+  bool        p25Enable;
+  bool        nxdnEnable;
+  bool        pocsagEnable;
+
+  bool        duplex;
+
+  bool        tx;
+  bool        dcd;
+
+  CSerialPort serial;
+  CIO         io;
+
+#if defined(MODE_DSTAR)
+  CDStarRX    dstarRX;
+  CDStarTX    dstarTX;
+#endif
+
+#if defined(MODE_DMR)
+  CDMRDMORX   dmrDMORX;
+  CDMRDMOTX   dmrDMOTX;
+#endif
+
+#if defined(MODE_YSF)
+  CYSFRX      ysfRX;
+  CYSFTX      ysfTX;
+#endif
+
+#if defined(MODE_P25)
+  CP25RX      p25RX;
+  CP25TX      p25TX;
+#endif
+
+#if defined(MODE_NXDN)
+  CNXDNRX     nxdnRX;
+  CNXDNTX     nxdnTX;
+#endif
+
+#if defined(MODE_POCSAG)
+  CPOCSAGTX   pocsagTX;
+#endif
+
+#if defined(MODE_DSTAR)
+  CCalDStarRX calDStarRX;
+  CCalDStarTX calDStarTX;
+#endif
+#if defined(MODE_DMR)
+  CCalDMR     calDMR;
+#endif
+#if defined(MODE_P25)
+  CCalP25     calP25;
+#endif
+#if defined(MODE_NXDN)
+  CCalNXDN    calNXDN;
+#endif
+#if defined(MODE_POCSAG)
+  CCalPOCSAG  calPOCSAG;
+#endif
+
+  CCWIdTX     cwIdTX;
+
+#if defined(STAGE_STATS)
+  CStageStats stats;
+#endif
+
+  CMetrics    metrics;
+
+  CDebugLog   debug;
+
+private:
+  int         m_cpu;
+  std::string m_ptyPath;
+  std::string m_statsFile;
+
+  void processTX();
+};
+
+#endif
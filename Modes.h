@@ -0,0 +1,69 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(MODES_H)
+#define  MODES_H
+
+// The Makefile passes one MODE_xxx per protocol in MODES, without any all are built
+#if !defined(MODE_DSTAR) && !defined(MODE_DMR) && !defined(MODE_YSF) && !defined(MODE_P25) && !defined(MODE_NXDN) && !defined(MODE_POCSAG)
+#define MODE_DSTAR
+#define MODE_DMR
+#define MODE_YSF
+#define MODE_P25
+#define MODE_NXDN
+#define MODE_POCSAG
+#endif
+
+#if defined(MODE_DSTAR)
+const bool HAS_DSTAR = true;
+#else
+const bool HAS_DSTAR = false;
+#endif
+
+#if defined(MODE_DMR)
+const bool HAS_DMR = true;
+#else
+const bool HAS_DMR = false;
+#endif
+
+#if defined(MODE_YSF)
+const bool HAS_YSF = true;
+#else
+const bool HAS_YSF = false;
+#endif
+
+#if defined(MODE_P25)
+const bool HAS_P25 = true;
+#else
+const bool HAS_P25 = false;
+#endif
+
+#if defined(MODE_NXDN)
+const bool HAS_NXDN = true;
+#else
+const bool HAS_NXDN = false;
+#endif
+
+#if defined(MODE_POCSAG)
+const bool HAS_POCSAG = true;
+#else
+const bool HAS_POCSAG = false;
+#endif
+
+#endif
+
@@ -20,11 +20,14 @@
 #define  NXDNTX_H
 
 #include "FIRInterpolator.h"
+#include "NXDNDefines.h"
 #include "SerialRB.h"
 
+class CModem;
+
 class CNXDNTX {
 public:
-  CNXDNTX();
+  CNXDNTX(CModem& modem);
 
   uint8_t writeData(const uint8_t* data, uint8_t length);
 
@@ -35,8 +38,14 @@ public:
   uint8_t getSpace() const;
 
 private:
+  // The modulation filter, defined in NXDNTX.cpp
+  static const uint16_t RRC_0_2_FILTER_PHASE_LEN = 9U; // phaseLength = numTaps/L
+
+  static const float RRC_0_2_FILTER[];
+
+  CModem&          m_modem;
   CSerialRB        m_buffer;
-  CFIRInterpolator m_modFilter;
+  CStaticFIRInterpolator<NXDN_RADIO_SYMBOL_LENGTH, RRC_0_2_FILTER_PHASE_LEN, RRC_0_2_FILTER, 4U> m_modFilter;
   uint8_t          m_poBuffer[1200U];
   uint16_t         m_poLen;
   uint16_t         m_poPtr;
@@ -23,6 +23,9 @@
 
 const float SCALING_FACTOR = 0.5722F;
 
+// Measured with MMDVMBER at 30 dB with the centre held one and two samples out
+const float TIMING_GAIN = 0.9F;
+
 const uint8_t CORRELATION_COUNTDOWN = 10U;//5U;
 
 const uint8_t MAX_SYNC_BIT_START_ERRS = 2U;
@@ -34,13 +37,12 @@ const uint8_t BIT_MASK_TABLE[] = { 0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x0
 
 #define WRITE_BIT1(p,i,b) p[(i)>>3] = (b) ? (p[(i)>>3] | BIT_MASK_TABLE[(i)&7]) : (p[(i)>>3] & ~BIT_MASK_TABLE[(i)&7])
 
-const uint8_t NOAVEPTR = 99U;
-
 const uint16_t NOENDPTR = 9999U;
 
 const unsigned int MAX_SYNC_FRAMES = 4U + 1U;
 
-CP25RX::CP25RX() :
+CP25RX::CP25RX(CModem& modem) :
+m_modem(modem),
 m_state(P25RXS_NONE),
 m_bitBuffer(),
 m_buffer(),
@@ -56,12 +58,17 @@ m_lduSyncPtr(NOENDPTR),
 m_maxCorr(0.0F),
 m_lostCount(0U),
 m_countdown(0U),
-m_centre(),
 m_centreVal(0.0F),
-m_threshold(),
 m_thresholdVal(0.0F),
-m_averagePtr(NOAVEPTR),
-m_duid(0U)
+m_levels(16U),
+m_duid(0U),
+m_timing(P25_RX_SYMBOL_LENGTH, TIMING_GAIN),
+m_frame(),
+m_slicePtr(NOENDPTR),
+m_sliceCount(0U)
+#if defined(RX_24KHZ)
+,m_fraction(0.0F)
+#endif
 {
 }
 
@@ -71,7 +78,6 @@ void CP25RX::reset()
   m_dataPtr       = 0U;
   m_bitPtr        = 0U;
   m_maxCorr       = 0.0F;
-  m_averagePtr    = NOAVEPTR;
   m_hdrStartPtr   = NOENDPTR;
   m_lduStartPtr   = NOENDPTR;
   m_lduEndPtr     = NOENDPTR;
@@ -84,6 +90,14 @@ void CP25RX::reset()
   m_lostCount     = 0U;
   m_countdown     = 0U;
   m_duid          = 0U;
+  m_slicePtr      = NOENDPTR;
+  m_sliceCount    = 0U;
+#if defined(RX_24KHZ)
+  m_fraction      = 0.0F;
+#endif
+
+  m_levels.reset();
+  m_timing.reset();
 }
 
 void CP25RX::samples(const float* samples, uint8_t length)
@@ -91,11 +105,28 @@ void CP25RX::samples(const float* samples, uint8_t length)
   for (uint8_t i = 0U; i < length; i++) {
     float sample = samples[i];
 
+#if defined(SYMBOL_TIMING)
+    // Once locked only the samples around the symbol centre are needed
+    if (m_state == P25RXS_LDU && !isNearSymbol(sample)) {
+      m_dataPtr++;
+      if (m_dataPtr >= P25_LDU_FRAME_LENGTH_SAMPLES) {
+        m_dataPtr = 0U;
+        m_duid = 0U;
+      }
+
+      m_bitPtr++;
+      if (m_bitPtr >= P25_RX_SYMBOL_LENGTH)
+        m_bitPtr = 0U;
+
+      continue;
+    }
+#endif
+
     m_bitBuffer[m_bitPtr] <<= 1;
     if (sample < 0.0F)
       m_bitBuffer[m_bitPtr] |= 0x01U;
 
-    m_buffer[m_dataPtr] = sample;
+    m_buffer[m_dataPtr] = toBuffer(sample);
 
     switch (m_state) {
     case P25RXS_HDR:
@@ -116,7 +147,7 @@ void CP25RX::samples(const float* samples, uint8_t length)
     }
 
     m_bitPtr++;
-    if (m_bitPtr >= P25_RADIO_SYMBOL_LENGTH)
+    if (m_bitPtr >= P25_RX_SYMBOL_LENGTH)
       m_bitPtr = 0U;
   }
 }
@@ -127,10 +158,10 @@ void CP25RX::processNone(float sample)
   if (ret) {
     // On the first sync, start the countdown to the state change
     if (m_countdown == 0U) {
-      io.setDecode(true);
-      io.setADCDetection(true);
+      m_modem.io.setDecode(true);
+      m_modem.io.setADCDetection(true);
 
-      m_averagePtr = NOAVEPTR;
+      m_levels.reset();
 
       m_countdown = CORRELATION_COUNTDOWN;
     }
@@ -149,6 +180,11 @@ void CP25RX::processNone(float sample)
       if (m_maxSyncPtr >= P25_LDU_FRAME_LENGTH_SAMPLES)
         m_maxSyncPtr -= P25_LDU_FRAME_LENGTH_SAMPLES;
 
+#if defined(RX_24KHZ)
+      // The HDR is sliced at its own sync
+      findFraction();
+#endif
+
       m_state     = P25RXS_HDR;
       m_countdown = 0U;
   }
@@ -164,7 +200,12 @@ void CP25RX::processHdr(float sample)
       correlateSync();
   }
 
-  if (m_dataPtr == m_maxSyncPtr) {
+  // The symbols are sliced once the sample after them has arrived too
+  uint16_t ptr = m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - RX_SLICE_DELAY;
+  if (ptr >= P25_LDU_FRAME_LENGTH_SAMPLES)
+    ptr -= P25_LDU_FRAME_LENGTH_SAMPLES;
+
+  if (ptr == m_maxSyncPtr) {
     uint16_t nidStartPtr = m_hdrStartPtr + P25_SYNC_LENGTH_SAMPLES;
     if (nidStartPtr >= P25_LDU_FRAME_LENGTH_SAMPLES)
         nidStartPtr -= P25_LDU_FRAME_LENGTH_SAMPLES;
@@ -185,7 +226,7 @@ void CP25RX::processHdr(float sample)
                 samplesToBits(m_hdrStartPtr, P25_HDR_FRAME_LENGTH_SYMBOLS, frame, 8U, m_centreVal, m_thresholdVal);
 
                 frame[0U] = 0x01U;
-                serial.writeP25Hdr(frame, P25_HDR_FRAME_LENGTH_BYTES + 1U);
+                m_modem.serial.writeP25Hdr(frame, P25_HDR_FRAME_LENGTH_BYTES + 1U);
             }
             break;
         case P25_DUID_TSDU: {
@@ -197,7 +238,7 @@ void CP25RX::processHdr(float sample)
                 samplesToBits(m_hdrStartPtr, P25_TSDU_FRAME_LENGTH_SYMBOLS, frame, 8U, m_centreVal, m_thresholdVal);
 
                 frame[0U] = 0x01U;
-                serial.writeP25Hdr(frame, P25_TSDU_FRAME_LENGTH_BYTES + 1U);
+                m_modem.serial.writeP25Hdr(frame, P25_TSDU_FRAME_LENGTH_BYTES + 1U);
             }
             break;
         case P25_DUID_TDU: {
@@ -209,7 +250,7 @@ void CP25RX::processHdr(float sample)
                 samplesToBits(m_hdrStartPtr, P25_TERM_FRAME_LENGTH_SYMBOLS, frame, 8U, m_centreVal, m_thresholdVal);
 
                 frame[0U] = 0x01U;
-                serial.writeP25Hdr(frame, P25_TERM_FRAME_LENGTH_BYTES + 1U);
+                m_modem.serial.writeP25Hdr(frame, P25_TERM_FRAME_LENGTH_BYTES + 1U);
             }
             break;
         case P25_DUID_TDULC: {
@@ -221,7 +262,7 @@ void CP25RX::processHdr(float sample)
                 samplesToBits(m_hdrStartPtr, P25_TERMLC_FRAME_LENGTH_SYMBOLS, frame, 8U, m_centreVal, m_thresholdVal);
 
                 frame[0U] = 0x01U;
-                serial.writeP25Hdr(frame, P25_TERMLC_FRAME_LENGTH_BYTES + 1U);
+                m_modem.serial.writeP25Hdr(frame, P25_TERMLC_FRAME_LENGTH_BYTES + 1U);
             }
             break;
         default:
@@ -237,7 +278,12 @@ void CP25RX::processHdr(float sample)
       m_maxSyncPtr -= P25_LDU_FRAME_LENGTH_SAMPLES;
 
     m_state   = P25RXS_LDU;
+
+    startSlicing();
+
     m_maxCorr = 0.0F;
+
+    m_timing.reset();
   }
 }
 
@@ -251,7 +297,28 @@ void CP25RX::processLdu(float sample)
       correlateSync();
   }
 
-  if (m_dataPtr == m_lduEndPtr) {
+  // The symbols are sliced once the sample after them has arrived too
+  uint16_t ptr = m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - RX_SLICE_DELAY;
+  if (ptr >= P25_LDU_FRAME_LENGTH_SAMPLES)
+    ptr -= P25_LDU_FRAME_LENGTH_SAMPLES;
+
+  // Once the sync window has closed the start of the frame is fixed
+  if (ptr == m_maxSyncPtr)
+    startSlicing();
+  else if (m_sliceCount < P25_LDU_FRAME_LENGTH_SYMBOLS && ptr == m_slicePtr) {
+    sliceSymbols(1U);
+
+#if defined(SYMBOL_TIMING)
+    // Clear of the sync window and the end of the frame, the timing loop moves the symbol centre
+    if (m_sliceCount > (P25_SYNC_LENGTH_SYMBOLS + 1U) && m_sliceCount < (P25_LDU_FRAME_LENGTH_SYMBOLS - 2U)) {
+      int8_t adjustment = m_timing.getAdjustment();
+      if (adjustment != 0)
+        adjustTiming(adjustment);
+    }
+#endif
+  }
+
+  if (ptr == m_lduEndPtr) {
     // Only update the centre and threshold if they are from a good sync
     if (m_lostCount == MAX_SYNC_FRAMES) {
       m_minSyncPtr = m_lduSyncPtr + P25_LDU_FRAME_LENGTH_SAMPLES - 1U;
@@ -263,41 +330,50 @@ void CP25RX::processLdu(float sample)
         m_maxSyncPtr -= P25_LDU_FRAME_LENGTH_SAMPLES;
     }
 
-    calculateLevels(m_lduStartPtr, P25_LDU_FRAME_LENGTH_SYMBOLS);
+    // Only the last symbol is left, sliced with the same levels as the rest
+    sliceSymbols(P25_LDU_FRAME_LENGTH_SYMBOLS - m_sliceCount);
 
-    DEBUG4("P25RX: sync found in Ldu pos/centre/threshold", m_lduSyncPtr, int16_t(m_centreVal * 2048.0F), int16_t(m_thresholdVal * 2048.0F));
+    // These levels are for the next frame
+    calculateLevels();
 
-    uint8_t frame[P25_LDU_FRAME_LENGTH_BYTES + 3U];
-    samplesToBits(m_lduStartPtr, P25_LDU_FRAME_LENGTH_SYMBOLS, frame, 8U, m_centreVal, m_thresholdVal);
+    DEBUG4("P25RX: sync found in Ldu pos/centre/threshold", m_lduSyncPtr, int16_t(m_centreVal * 2048.0F), int16_t(m_thresholdVal * 2048.0F));
 
     // We've not seen a data sync for too long, signal RXLOST and change to RX_NONE
     m_lostCount--;
     if (m_lostCount == 0U) {
       DEBUG1("P25RX: sync timed out, lost lock");
 
-      io.setDecode(false);
-      io.setADCDetection(false);
+      m_modem.io.setDecode(false);
+      m_modem.io.setADCDetection(false);
 
-      serial.writeP25Lost();
+      m_modem.serial.writeP25Lost();
 
       m_state      = P25RXS_NONE;
       m_lduEndPtr  = NOENDPTR;
-      m_averagePtr = NOAVEPTR;
       m_countdown  = 0U;
       m_maxCorr    = 0.0F;
       m_duid       = 0U;
+#if defined(RX_24KHZ)
+      m_fraction   = 0.0F;
+#endif
+
+      m_levels.reset();
     } else {
-      frame[0U] = m_lostCount == (MAX_SYNC_FRAMES - 1U) ? 0x01U : 0x00U;
-      writeLdu(frame);
+      m_frame[0U] = m_lostCount == (MAX_SYNC_FRAMES - 1U) ? 0x01U : 0x00U;
+      writeLdu(m_frame);
       m_maxCorr = 0.0F;
     }
+
+    // The next frame starts in the same place
+    m_slicePtr   = m_lduStartPtr;
+    m_sliceCount = 0U;
   }
 }
 
 bool CP25RX::correlateSync()
 {
   if (countBits32((m_bitBuffer[m_bitPtr] & P25_SYNC_SYMBOLS_MASK) ^ P25_SYNC_SYMBOLS) <= MAX_SYNC_SYMBOLS_ERRS) {
-    uint16_t ptr = m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - P25_SYNC_LENGTH_SAMPLES + P25_RADIO_SYMBOL_LENGTH;
+    uint16_t ptr = m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - P25_SYNC_LENGTH_SAMPLES + P25_RX_SYMBOL_LENGTH;
     if (ptr >= P25_LDU_FRAME_LENGTH_SAMPLES)
       ptr -= P25_LDU_FRAME_LENGTH_SAMPLES;
 
@@ -306,7 +382,7 @@ bool CP25RX::correlateSync()
     float max = -1.0F;
 
     for (uint8_t i = 0U; i < P25_SYNC_LENGTH_SYMBOLS; i++) {
-      float val = m_buffer[ptr];
+      float val = fromBuffer(m_buffer[ptr]);
 
       if (val > max)
         max = val;
@@ -328,19 +404,19 @@ bool CP25RX::correlateSync()
         break;
       }
 
-      ptr += P25_RADIO_SYMBOL_LENGTH;
+      ptr += P25_RX_SYMBOL_LENGTH;
       if (ptr >= P25_LDU_FRAME_LENGTH_SAMPLES)
         ptr -= P25_LDU_FRAME_LENGTH_SAMPLES;
     }
 
     if (corr > m_maxCorr) {
-      if (m_averagePtr == NOAVEPTR) {
+      if (!m_levels.isValid()) {
         m_centreVal = (max + min) / 2.0F;
 
         m_thresholdVal = (max - m_centreVal) * SCALING_FACTOR;
       }
 
-      uint16_t startPtr = m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - P25_SYNC_LENGTH_SAMPLES + P25_RADIO_SYMBOL_LENGTH;
+      uint16_t startPtr = m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - P25_SYNC_LENGTH_SAMPLES + P25_RX_SYMBOL_LENGTH;
       if (startPtr >= P25_LDU_FRAME_LENGTH_SAMPLES)
         startPtr -= P25_LDU_FRAME_LENGTH_SAMPLES;
 
@@ -366,7 +442,7 @@ bool CP25RX::correlateSync()
         // These are the positions of the start and end of an LDU
         m_lduStartPtr = startPtr;
 
-        m_lduEndPtr = m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - P25_SYNC_LENGTH_SAMPLES - 1U;
+        m_lduEndPtr = m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - P25_SYNC_LENGTH_SAMPLES;
         if (m_lduEndPtr >= P25_LDU_FRAME_LENGTH_SAMPLES)
           m_lduEndPtr -= P25_LDU_FRAME_LENGTH_SAMPLES;
 
@@ -396,72 +472,90 @@ bool CP25RX::correlateSync()
 
 void CP25RX::calculateLevels(uint16_t start, uint16_t count)
 {
-  float maxPos = -1.0F;
-  float minPos =  1.0F;
-  float maxNeg =  1.0F;
-  float minNeg = -1.0F;
+  m_levels.resetFrame();
 
   for (uint16_t i = 0U; i < count; i++) {
-    float sample = m_buffer[start];
+#if defined(RX_24KHZ)
+    m_levels.sample(fromBuffer(m_buffer, P25_LDU_FRAME_LENGTH_SAMPLES, start, m_fraction));
+#else
+    m_levels.sample(fromBuffer(m_buffer[start]));
+#endif
 
-    if (sample > 0.0F) {
-      if (sample > maxPos)
-        maxPos = sample;
-      if (sample < minPos)
-        minPos = sample;
-    } else {
-      if (sample < maxNeg)
-        maxNeg = sample;
-      if (sample > minNeg)
-        minNeg = sample;
-    }
-
-    start += P25_RADIO_SYMBOL_LENGTH;
+    start += P25_RX_SYMBOL_LENGTH;
     if (start >= P25_LDU_FRAME_LENGTH_SAMPLES)
       start -= P25_LDU_FRAME_LENGTH_SAMPLES;
   }
 
-  float posThresh = (maxPos + minPos) / 2.0F;
-  float negThresh = (maxNeg + minNeg) / 2.0F;
+  calculateLevels();
+}
 
-  float centre = (posThresh + negThresh) / 2.0F;
+void CP25RX::calculateLevels()
+{
+  m_levels.update(m_centreVal, m_thresholdVal);
 
-  float threshold = posThresh - centre;
+  float posThresh, negThresh;
+  m_levels.getThresholds(posThresh, negThresh);
 
-  DEBUG5("P25RX: pos/neg/centre/threshold", int16_t(posThresh * 2048.0F), int16_t(negThresh * 2048.0F), int16_t(centre * 2048.0F), int16_t(threshold * 2048.0F));
+  DEBUG5("P25RX: pos/neg/centre/threshold", int16_t(posThresh * 2048.0F), int16_t(negThresh * 2048.0F), int16_t(m_centreVal * 2048.0F), int16_t(m_thresholdVal * 2048.0F));
+}
 
-  if (m_averagePtr == NOAVEPTR) {
-    for (uint8_t i = 0U; i < 16U; i++) {
-      m_centre[i]    = centre;
-      m_threshold[i] = threshold;
-    }
+void CP25RX::startSlicing()
+{
+#if defined(RX_24KHZ)
+  // Only a sync found in this frame says where its symbols peak
+  if (m_maxCorr > 0.0F)
+    findFraction();
+#endif
 
-    m_averagePtr = 0U;
-  } else {
-    m_centre[m_averagePtr]    = centre;
-    m_threshold[m_averagePtr] = threshold;
+  m_slicePtr   = m_lduStartPtr;
+  m_sliceCount = 0U;
 
-    m_averagePtr++;
-    if (m_averagePtr >= 16U)
-      m_averagePtr = 0U;
-  }
+  m_levels.resetFrame();
+
+  // Catch up with the symbols that have already arrived
+  uint16_t offset = m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - RX_SLICE_DELAY - m_lduStartPtr;
+  if (offset >= P25_LDU_FRAME_LENGTH_SAMPLES)
+    offset -= P25_LDU_FRAME_LENGTH_SAMPLES;
+
+  sliceSymbols(offset / P25_RX_SYMBOL_LENGTH + 1U);
+}
+
+void CP25RX::sliceSymbols(uint16_t count)
+{
+  if (count > (P25_LDU_FRAME_LENGTH_SYMBOLS - m_sliceCount))
+    count = P25_LDU_FRAME_LENGTH_SYMBOLS - m_sliceCount;
 
-  m_centreVal    = 0.0F;
-  m_thresholdVal = 0.0F;
+  samplesToBits(m_slicePtr, count, m_frame, 8U + m_sliceCount * 2U, m_centreVal, m_thresholdVal);
+
+  // The levels for the next frame come from the symbols as they are sliced
+  uint16_t ptr = m_slicePtr;
+  for (uint16_t i = 0U; i < count; i++) {
+#if defined(RX_24KHZ)
+    m_levels.sample(fromBuffer(m_buffer, P25_LDU_FRAME_LENGTH_SAMPLES, ptr, m_fraction));
+#else
+    m_levels.sample(fromBuffer(m_buffer[ptr]));
+#endif
 
-  for (uint8_t i = 0U; i < 16U; i++) {
-    m_centreVal    += m_centre[i];
-    m_thresholdVal += m_threshold[i];
+    ptr += P25_RX_SYMBOL_LENGTH;
+    if (ptr >= P25_LDU_FRAME_LENGTH_SAMPLES)
+      ptr -= P25_LDU_FRAME_LENGTH_SAMPLES;
   }
 
-  m_centreVal    /= 16.0F;
-  m_thresholdVal /= 16.0F;
+  m_sliceCount += count;
+
+  m_slicePtr += count * P25_RX_SYMBOL_LENGTH;
+  if (m_slicePtr >= P25_LDU_FRAME_LENGTH_SAMPLES)
+    m_slicePtr -= P25_LDU_FRAME_LENGTH_SAMPLES;
 }
 
 void CP25RX::samplesToBits(uint16_t start, uint16_t count, uint8_t* buffer, uint16_t offset, float centre, float threshold)
 {
   for (uint16_t i = 0U; i < count; i++) {
-    float sample = m_buffer[start] - centre;
+#if defined(RX_24KHZ)
+    float sample = fromBuffer(m_buffer, P25_LDU_FRAME_LENGTH_SAMPLES, start, m_fraction) - centre;
+#else
+    float sample = fromBuffer(m_buffer[start]) - centre;
+#endif
 
     if (sample < -threshold) {
       WRITE_BIT1(buffer, offset, false);
@@ -485,14 +579,142 @@ void CP25RX::samplesToBits(uint16_t start, uint16_t count, uint8_t* buffer, uint
       offset++;
     }
 
-    start += P25_RADIO_SYMBOL_LENGTH;
+    start += P25_RX_SYMBOL_LENGTH;
     if (start >= P25_LDU_FRAME_LENGTH_SAMPLES)
       start -= P25_LDU_FRAME_LENGTH_SAMPLES;
   }
 }
 
+#if defined(RX_24KHZ)
+float CP25RX::correlate(uint16_t ptr) const
+{
+  // The sync ends at ptr
+  ptr += P25_LDU_FRAME_LENGTH_SAMPLES - P25_SYNC_LENGTH_SAMPLES + P25_RX_SYMBOL_LENGTH;
+  if (ptr >= P25_LDU_FRAME_LENGTH_SAMPLES)
+    ptr -= P25_LDU_FRAME_LENGTH_SAMPLES;
+
+  float corr = 0.0F;
+
+  for (uint8_t i = 0U; i < P25_SYNC_LENGTH_SYMBOLS; i++) {
+    corr -= float(P25_SYNC_SYMBOLS_VALUES[i]) * fromBuffer(m_buffer[ptr]);
+
+    ptr += P25_RX_SYMBOL_LENGTH;
+    if (ptr >= P25_LDU_FRAME_LENGTH_SAMPLES)
+      ptr -= P25_LDU_FRAME_LENGTH_SAMPLES;
+  }
+
+  return corr;
+}
+
+void CP25RX::findFraction()
+{
+  // At five samples per symbol the nearest sample can be a tenth of a symbol from the centre
+  uint16_t early = (m_lduSyncPtr == 0U) ? (P25_LDU_FRAME_LENGTH_SAMPLES - 1U) : (m_lduSyncPtr - 1U);
+
+  uint16_t late = m_lduSyncPtr + 1U;
+  if (late >= P25_LDU_FRAME_LENGTH_SAMPLES)
+    late = 0U;
+
+  m_fraction = getPeakFraction(correlate(early), correlate(m_lduSyncPtr), correlate(late));
+
+  // The first frame is sliced with the levels of its sync, read at the same point
+  if (m_levels.isValid())
+    return;
+
+  uint16_t ptr = m_lduStartPtr;
+
+  float min =  1.0F;
+  float max = -1.0F;
+
+  for (uint8_t i = 0U; i < P25_SYNC_LENGTH_SYMBOLS; i++) {
+    float val = fromBuffer(m_buffer, P25_LDU_FRAME_LENGTH_SAMPLES, ptr, m_fraction);
+
+    if (val > max)
+      max = val;
+    if (val < min)
+      min = val;
+
+    ptr += P25_RX_SYMBOL_LENGTH;
+    if (ptr >= P25_LDU_FRAME_LENGTH_SAMPLES)
+      ptr -= P25_LDU_FRAME_LENGTH_SAMPLES;
+  }
+
+  m_centreVal    = (max + min) / 2.0F;
+  m_thresholdVal = (max - m_centreVal) * SCALING_FACTOR;
+}
+#endif
+
+#if defined(SYMBOL_TIMING)
+bool CP25RX::isNearSymbol(float sample)
+{
+  uint16_t phase = (m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - m_lduSyncPtr) % P25_RX_SYMBOL_LENGTH;
+
+#if defined(RX_24KHZ)
+  // The set is read at the slicing point and a sample either side, once the samples around them are in
+  if (phase == 3U) {
+    uint16_t latePtr = m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - 2U;
+    if (latePtr >= P25_LDU_FRAME_LENGTH_SAMPLES)
+      latePtr -= P25_LDU_FRAME_LENGTH_SAMPLES;
+
+    uint16_t onTimePtr = m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - 3U;
+    if (onTimePtr >= P25_LDU_FRAME_LENGTH_SAMPLES)
+      onTimePtr -= P25_LDU_FRAME_LENGTH_SAMPLES;
+
+    uint16_t earlyPtr = m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - 4U;
+    if (earlyPtr >= P25_LDU_FRAME_LENGTH_SAMPLES)
+      earlyPtr -= P25_LDU_FRAME_LENGTH_SAMPLES;
+
+    m_timing.sample(fromBuffer(m_buffer, P25_LDU_FRAME_LENGTH_SAMPLES, earlyPtr, m_fraction) - m_centreVal, fromBuffer(m_buffer, P25_LDU_FRAME_LENGTH_SAMPLES, onTimePtr, m_fraction) - m_centreVal, fromBuffer(m_buffer, P25_LDU_FRAME_LENGTH_SAMPLES, latePtr, m_fraction) - m_centreVal);
+  }
+#else
+  // The late sample completes an early, on time and late set
+  if (phase == 1U) {
+    uint16_t onTimePtr = m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - 1U;
+    if (onTimePtr >= P25_LDU_FRAME_LENGTH_SAMPLES)
+      onTimePtr -= P25_LDU_FRAME_LENGTH_SAMPLES;
+
+    uint16_t earlyPtr = m_dataPtr + P25_LDU_FRAME_LENGTH_SAMPLES - 2U;
+    if (earlyPtr >= P25_LDU_FRAME_LENGTH_SAMPLES)
+      earlyPtr -= P25_LDU_FRAME_LENGTH_SAMPLES;
+
+    m_timing.sample(fromBuffer(m_buffer[earlyPtr]) - m_centreVal, fromBuffer(m_buffer[onTimePtr]) - m_centreVal, sample - m_centreVal);
+  }
+#endif
+
+  return phase <= SYMBOL_TIMING_WINDOW || phase >= (P25_RX_SYMBOL_LENGTH - SYMBOL_TIMING_WINDOW);
+}
+
+void CP25RX::adjustTiming(int8_t adjustment)
+{
+#if defined(RX_24KHZ)
+  // Half a sample at a time, the pointers only move when the slicing point passes a sample
+  m_fraction += adjustment > 0 ? 0.5F : -0.5F;
+
+  if (m_fraction > 0.5F) {
+    m_fraction -= 1.0F;
+  } else if (m_fraction < -0.5F) {
+    m_fraction += 1.0F;
+  } else {
+    DEBUG2("P25RX: symbol timing adjusted", adjustment);
+    return;
+  }
+#endif
+
+  uint16_t offset = adjustment > 0 ? 1U : (P25_LDU_FRAME_LENGTH_SAMPLES - 1U);
+
+  m_lduSyncPtr  = (m_lduSyncPtr + offset) % P25_LDU_FRAME_LENGTH_SAMPLES;
+  m_lduStartPtr = (m_lduStartPtr + offset) % P25_LDU_FRAME_LENGTH_SAMPLES;
+  m_lduEndPtr   = (m_lduEndPtr + offset) % P25_LDU_FRAME_LENGTH_SAMPLES;
+  m_minSyncPtr  = (m_minSyncPtr + offset) % P25_LDU_FRAME_LENGTH_SAMPLES;
+  m_maxSyncPtr  = (m_maxSyncPtr + offset) % P25_LDU_FRAME_LENGTH_SAMPLES;
+  m_slicePtr    = (m_slicePtr + offset) % P25_LDU_FRAME_LENGTH_SAMPLES;
+
+  DEBUG2("P25RX: symbol timing adjusted", adjustment);
+}
+#endif
+
 void CP25RX::writeLdu(uint8_t* ldu)
 {
-  serial.writeP25Ldu(ldu, P25_LDU_FRAME_LENGTH_BYTES + 1U);
+  m_modem.serial.writeP25Ldu(ldu, P25_LDU_FRAME_LENGTH_BYTES + 1U);
 }
 
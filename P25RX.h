@@ -21,6 +21,9 @@
 #define  P25RX_H
 
 #include "P25Defines.h"
+#include "SampleBuffer.h"
+#include "LevelTracker.h"
+#include "SymbolTiming.h"
 
 enum P25RX_STATE {
   P25RXS_NONE,
@@ -28,18 +31,21 @@ enum P25RX_STATE {
   P25RXS_LDU
 };
 
+class CModem;
+
 class CP25RX {
 public:
-  CP25RX();
+  CP25RX(CModem& modem);
 
   void samples(const float* samples, uint8_t length);
 
   void reset();
 
 private:
+  CModem&     m_modem;
   P25RX_STATE m_state;
-  uint32_t    m_bitBuffer[P25_RADIO_SYMBOL_LENGTH];
-  float       m_buffer[P25_LDU_FRAME_LENGTH_SAMPLES];
+  uint32_t    m_bitBuffer[P25_RX_SYMBOL_LENGTH];
+  buffer_t    m_buffer[P25_LDU_FRAME_LENGTH_SAMPLES];
   uint16_t    m_bitPtr;
   uint16_t    m_dataPtr;
   uint16_t    m_hdrStartPtr;
@@ -52,19 +58,36 @@ private:
   float       m_maxCorr;
   uint16_t    m_lostCount;
   uint8_t     m_countdown;
-  float       m_centre[16U];
   float       m_centreVal;
-  float       m_threshold[16U];
   float       m_thresholdVal;
-  uint8_t     m_averagePtr;
+  CLevelTracker m_levels;
   uint8_t     m_duid;
+  CSymbolTiming m_timing;
+  uint8_t     m_frame[P25_LDU_FRAME_LENGTH_BYTES + 3U];
+  uint16_t    m_slicePtr;
+  uint16_t    m_sliceCount;
+#if defined(RX_24KHZ)
+  // How far between samples the last sync peaked, the symbols are read there
+  float       m_fraction;
+#endif
 
   void processNone(float sample);
   void processHdr(float sample);
   void processLdu(float sample);
   bool correlateSync();
   void calculateLevels(uint16_t start, uint16_t count);
+  void calculateLevels();
+  void startSlicing();
+  void sliceSymbols(uint16_t count);
   void samplesToBits(uint16_t start, uint16_t count, uint8_t* buffer, uint16_t offset, float centre, float threshold);
+#if defined(RX_24KHZ)
+  float correlate(uint16_t ptr) const;
+  void findFraction();
+#endif
+#if defined(SYMBOL_TIMING)
+  bool isNearSymbol(float sample);
+  void adjustTiming(int8_t adjustment);
+#endif
   void writeLdu(uint8_t* ldu);
 };
 
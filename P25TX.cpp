@@ -23,25 +23,23 @@
 #include "P25Defines.h"
 
 // Generated using rcosdesign(0.2, 8, 10, 'normal') in MATLAB
-static float RC_0_2_FILTER[] = {-0.0135502F, -0.0273751F, -0.0400098F, -0.0499283F, -0.0556963F, -0.0561541F, -0.0506302F, -0.0390027F,
-								-0.0217292F,  0.0000000F,  0.0244148F,  0.0492264F,  0.0718406F,  0.0896023F,  0.1000092F,  0.1010163F,
-								 0.0913724F,  0.0706503F,  0.0395520F,  0.0000000F, -0.0451064F, -0.0918912F, -0.1357463F, -0.1717277F,
-								-0.1948912F, -0.2008118F, -0.1858577F, -0.1476791F, -0.0854518F,  0.0000000F,  0.1060213F,  0.2283395F,
-								 0.3611866F,  0.4977874F,  0.6306955F,  0.7523118F,  0.8554949F,  0.9340800F,  0.9832758F,  1.0000000F,
-								 0.9832758F,  0.9340800F,  0.8554949F,  0.7523118F,  0.6306955F,  0.4977874F,  0.3611866F,  0.2283395F,
-								 0.1060213F,  0.0000000F, -0.0854518F, -0.1476791F, -0.1858577F, -0.2008118F, -0.1948912F, -0.1717277F,
-								-0.1357463F, -0.0918912F, -0.0451064F,  0.0000000F,  0.0395520F,  0.0706503F,  0.0913724F,  0.1010163F,
-								 0.1000092F,  0.0896023F,  0.0718406F,  0.0492264F,  0.0244148F,  0.0000000F, -0.0217292F, -0.0390027F,
-								-0.0506302F, -0.0561541F, -0.0556963F, -0.0499283F, -0.0400098F, -0.0273751F, -0.0135502F,  0.0000000F}; // numTaps = 80, L = 10
-const uint16_t RC_0_2_FILTER_PHASE_LEN = 8U; // phaseLength = numTaps/L
+const float CP25TX::RC_0_2_FILTER[] = {-0.0135502F, -0.0273751F, -0.0400098F, -0.0499283F, -0.0556963F, -0.0561541F, -0.0506302F, -0.0390027F,
+								       -0.0217292F,  0.0000000F,  0.0244148F,  0.0492264F,  0.0718406F,  0.0896023F,  0.1000092F,  0.1010163F,
+								        0.0913724F,  0.0706503F,  0.0395520F,  0.0000000F, -0.0451064F, -0.0918912F, -0.1357463F, -0.1717277F,
+								       -0.1948912F, -0.2008118F, -0.1858577F, -0.1476791F, -0.0854518F,  0.0000000F,  0.1060213F,  0.2283395F,
+								        0.3611866F,  0.4977874F,  0.6306955F,  0.7523118F,  0.8554949F,  0.9340800F,  0.9832758F,  1.0000000F,
+								        0.9832758F,  0.9340800F,  0.8554949F,  0.7523118F,  0.6306955F,  0.4977874F,  0.3611866F,  0.2283395F,
+								        0.1060213F,  0.0000000F, -0.0854518F, -0.1476791F, -0.1858577F, -0.2008118F, -0.1948912F, -0.1717277F,
+								       -0.1357463F, -0.0918912F, -0.0451064F,  0.0000000F,  0.0395520F,  0.0706503F,  0.0913724F,  0.1010163F,
+								        0.1000092F,  0.0896023F,  0.0718406F,  0.0492264F,  0.0244148F,  0.0000000F, -0.0217292F, -0.0390027F,
+								       -0.0506302F, -0.0561541F, -0.0556963F, -0.0499283F, -0.0400098F, -0.0273751F, -0.0135502F,  0.0000000F}; // numTaps = 80, L = 10
 
 // Generated in MATLAB using the following commands, and then normalised for unity gain
 // shape2 = 'Inverse-sinc Lowpass';
 // d2 = fdesign.interpolator(1, shape2);
 // h2 = design(d2, 'SystemObject', true);
-static float LOWPASS_FILTER[] = {0.0394910F, -0.0686972F, 0.1315958F, -0.2564165F, 0.6408582F, 0.6408582F, -0.2564165F, 0.1315958F,
-								-0.0686972F, 0.0394910F};
-const uint16_t LOWPASS_FILTER_LEN = 10U;
+const float CP25TX::LOWPASS_FILTER[] = {0.0394910F, -0.0686972F, 0.1315958F, -0.2564165F, 0.6408582F, 0.6408582F, -0.2564165F, 0.1315958F,
+								       -0.0686972F, 0.0394910F};
 
 const float P25_LEVELA =  0.504;
 const float P25_LEVELB =  0.168;
@@ -50,10 +48,11 @@ const float P25_LEVELD = -0.504;
 
 const uint8_t P25_START_SYNC = 0x77U;
 
-CP25TX::CP25TX() :
+CP25TX::CP25TX(CModem& modem) :
+m_modem(modem),
 m_buffer(4000U),
-m_modFilter(P25_RADIO_SYMBOL_LENGTH, RC_0_2_FILTER_PHASE_LEN, RC_0_2_FILTER, 4U),
-m_lpFilter(LOWPASS_FILTER_LEN, LOWPASS_FILTER, P25_RADIO_SYMBOL_LENGTH * 4U),
+m_modFilter(),
+m_lpFilter(),
 m_poBuffer(),
 m_poLen(0U),
 m_poPtr(0U),
@@ -67,7 +66,7 @@ void CP25TX::process()
     return;
 
   if (m_poLen == 0U) {
-    if (!m_tx) {
+    if (!m_modem.tx) {
       for (uint16_t i = 0U; i < m_txDelay; i++)
         m_poBuffer[m_poLen++] = P25_START_SYNC;
     } else {
@@ -82,7 +81,7 @@ void CP25TX::process()
   }
 
   if (m_poLen > 0U) {
-    uint16_t space = io.getSpace();
+    uint16_t space = m_modem.io.getSpace();
     
     while (space > (4U * P25_RADIO_SYMBOL_LENGTH)) {
       uint8_t c = m_poBuffer[m_poPtr++];
@@ -144,7 +143,7 @@ void CP25TX::writeByte(uint8_t c)
 
   m_lpFilter.process(intBuffer, outBuffer, P25_RADIO_SYMBOL_LENGTH * 4U);
 
-  io.write(STATE_P25, outBuffer, P25_RADIO_SYMBOL_LENGTH * 4U);
+  m_modem.io.write(STATE_P25, outBuffer, P25_RADIO_SYMBOL_LENGTH * 4U);
 }
 
 void CP25TX::setTXDelay(uint8_t delay)
@@ -20,12 +20,15 @@
 #define  P25TX_H
 
 #include "FIRInterpolator.h"
+#include "P25Defines.h"
 #include "SerialRB.h"
 #include "FIR.h"
 
+class CModem;
+
 class CP25TX {
 public:
-  CP25TX();
+  CP25TX(CModem& modem);
 
   uint8_t writeData(const uint8_t* data, uint8_t length);
 
@@ -36,9 +39,17 @@ public:
   uint8_t getSpace() const;
 
 private:
+  // The modulation filters, defined in P25TX.cpp
+  static const uint16_t RC_0_2_FILTER_PHASE_LEN = 8U; // phaseLength = numTaps/L
+  static const uint16_t LOWPASS_FILTER_LEN      = 10U;
+
+  static const float RC_0_2_FILTER[];
+  static const float LOWPASS_FILTER[];
+
+  CModem&          m_modem;
   CSerialRB        m_buffer;
-  CFIRInterpolator m_modFilter;
-  CFIR             m_lpFilter;
+  CStaticFIRInterpolator<P25_RADIO_SYMBOL_LENGTH, RC_0_2_FILTER_PHASE_LEN, RC_0_2_FILTER, 4U> m_modFilter;
+  CStaticFIR<LOWPASS_FILTER_LEN, LOWPASS_FILTER, P25_RADIO_SYMBOL_LENGTH * 4U> m_lpFilter;
   uint8_t          m_poBuffer[1200U];
   uint16_t         m_poLen;
   uint16_t         m_poPtr;
@@ -23,8 +23,6 @@ const uint16_t POCSAG_FRAME_LENGTH_BYTES = 17U * sizeof(uint32_t);
 
 const uint16_t POCSAG_PREAMBLE_LENGTH_BYTES = 18U * sizeof(uint32_t);
 
-const uint16_t POCSAG_RADIO_SYMBOL_LENGTH = 40U;
-
 const float POCSAG_LEVEL1[] = { 0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,
 							    0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,
 								0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,  0.741F,
@@ -34,14 +32,14 @@ const float POCSAG_LEVEL0[] = {-0.741F, -0.741F, -0.741F, -0.741F, -0.741F, -0.7
 							   -0.741F, -0.741F, -0.741F, -0.741F, -0.741F, -0.741F, -0.741F, -0.741F, -0.741F, -0.741F, -0.741F,
 							   -0.741F, -0.741F, -0.741F, -0.741F, -0.741F, -0.741F, -0.741F};
 
-const float SHAPING_FILTER[] = {0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F};
-const uint16_t SHAPING_FILTER_LEN = 12U;
+const float CPOCSAGTX::SHAPING_FILTER[] = {0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F, 0.0833F};
 
 const uint8_t POCSAG_SYNC = 0xAAU;
 
-CPOCSAGTX::CPOCSAGTX() :
+CPOCSAGTX::CPOCSAGTX(CModem& modem) :
+m_modem(modem),
 m_buffer(4000U),
-m_modFilter(SHAPING_FILTER_LEN, SHAPING_FILTER, POCSAG_RADIO_SYMBOL_LENGTH * 8U),
+m_modFilter(),
 m_poBuffer(),
 m_poLen(0U),
 m_poPtr(0U),
@@ -55,7 +53,7 @@ void CPOCSAGTX::process()
     return;
 
   if (m_poLen == 0U) {
-    if (!m_tx) {
+    if (!m_modem.tx) {
       for (uint16_t i = 0U; i < m_txDelay; i++)
         m_poBuffer[m_poLen++] = POCSAG_SYNC;
     } else {
@@ -69,7 +67,7 @@ void CPOCSAGTX::process()
   }
 
   if (m_poLen > 0U) {
-    uint16_t space = io.getSpace();
+    uint16_t space = m_modem.io.getSpace();
     
     while (space > (8U * POCSAG_RADIO_SYMBOL_LENGTH)) {
       uint8_t c = m_poBuffer[m_poPtr++];
@@ -130,7 +128,7 @@ void CPOCSAGTX::writeByte(uint8_t c)
 
   m_modFilter.process(inBuffer, outBuffer, POCSAG_RADIO_SYMBOL_LENGTH * 8U);
 
-  io.write(STATE_POCSAG, outBuffer, POCSAG_RADIO_SYMBOL_LENGTH * 8U);
+  m_modem.io.write(STATE_POCSAG, outBuffer, POCSAG_RADIO_SYMBOL_LENGTH * 8U);
 }
 
 void CPOCSAGTX::setTXDelay(uint8_t delay)
@@ -22,9 +22,13 @@
 #include "SerialRB.h"
 #include "FIR.h"
 
+const uint16_t POCSAG_RADIO_SYMBOL_LENGTH = 40U;
+
+class CModem;
+
 class CPOCSAGTX {
 public:
-  CPOCSAGTX();
+  CPOCSAGTX(CModem& modem);
 
   uint8_t writeData(const uint8_t* data, uint8_t length);
 
@@ -39,8 +43,14 @@ public:
   bool busy();
 
 private:
+  // The modulation filter, defined in POCSAGTX.cpp
+  static const uint16_t SHAPING_FILTER_LEN = 12U;
+
+  static const float SHAPING_FILTER[];
+
+  CModem&   m_modem;
   CSerialRB m_buffer;
-  CFIR      m_modFilter;
+  CStaticFIR<SHAPING_FILTER_LEN, SHAPING_FILTER, POCSAG_RADIO_SYMBOL_LENGTH * 8U> m_modFilter;
   uint8_t   m_poBuffer[200U];
   uint16_t  m_poLen;
   uint16_t  m_poPtr;
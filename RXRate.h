@@ -0,0 +1,37 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(RXRATE_H)
+#define  RXRATE_H
+
+#if defined(RX_24KHZ)
+// The receivers run at 24 kHz, after the decimating front end in CIO
+const unsigned int RX_DECIMATION = 2U;
+
+// The symbols are sliced up to half a sample after the nearest one, so wait for the sample after it
+const unsigned int RX_SLICE_DELAY = 1U;
+#else
+const unsigned int RX_DECIMATION = 1U;
+
+const unsigned int RX_SLICE_DELAY = 0U;
+#endif
+
+const unsigned int RX_SAMPLE_RATE = 48000U / RX_DECIMATION;
+
+#endif
+
@@ -0,0 +1,50 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Globals.h"
+#include "RXWorker.h"
+
+CRXWorker::CRXWorker(CIO& io, CFanoutRB& fanout, RX_CHAIN chain) :
+CThread(),
+m_io(io),
+m_fanout(fanout),
+m_chain(chain),
+m_outbound()
+{
+}
+
+CFrameRB& CRXWorker::getOutbound()
+{
+  return m_outbound;
+}
+
+void CRXWorker::entry()
+{
+  // Anything the receivers send to the host is queued for the main thread
+  CSerialPort::setThreadOutbound(&m_outbound);
+
+  RXBlock block;
+
+  do {
+    while (m_fanout.peek(m_chain, block)) {
+      CSerialPort::setCaptureTime(block.captured);
+      m_io.processChain(m_chain, block.samples, block.dcSamples, block.modes);
+      m_fanout.advance(m_chain);
+    }
+  } while (m_fanout.wait(m_chain));
+}
@@ -0,0 +1,55 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(RXWORKER_H)
+#define  RXWORKER_H
+
+#include "FanoutRB.h"
+#include "FrameRB.h"
+#include "Thread.h"
+
+class CIO;
+
+enum RX_CHAIN {
+  RX_CHAIN_DSTAR,
+  RX_CHAIN_P25,
+  RX_CHAIN_NXDN,
+  RX_CHAIN_RRC,     // DMR and YSF share the RRC filter output
+  RX_CHAIN_COUNT,   // The chains above are the ones that run in IDLE
+
+  RX_CHAIN_DSTARCAL = RX_CHAIN_COUNT,
+  RX_CHAIN_MAX
+};
+
+// Runs one IDLE receive chain on its own thread, until the fanout is stopped
+class CRXWorker : public CThread {
+public:
+  CRXWorker(CIO& io, CFanoutRB& fanout, RX_CHAIN chain);
+
+  CFrameRB& getOutbound();
+
+  virtual void entry();
+
+private:
+  CIO&       m_io;
+  CFanoutRB& m_fanout;
+  RX_CHAIN   m_chain;
+  CFrameRB   m_outbound;
+};
+
+#endif
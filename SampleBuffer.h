@@ -0,0 +1,97 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(SAMPLEBUFFER_H)
+#define  SAMPLEBUFFER_H
+
+#include <cstdint>
+
+// The type of the receivers' circular sample histories, INT16_BUFFERS halves their size
+#if defined(INT16_BUFFERS)
+typedef int16_t buffer_t;
+
+// Q12, the filtered samples stay well inside +/-8
+const float BUFFER_SCALE = 4096.0F;
+
+inline buffer_t toBuffer(float sample)
+{
+  // The offset makes the truncation round to nearest without a branch on the sign
+  int32_t scaled = int32_t(sample * BUFFER_SCALE + 32768.5F) - 32768;
+
+  scaled = scaled >  32767 ?  32767 : scaled;
+  scaled = scaled < -32768 ? -32768 : scaled;
+
+  return buffer_t(scaled);
+}
+
+inline float fromBuffer(buffer_t sample)
+{
+  return float(sample) * (1.0F / BUFFER_SCALE);
+}
+#else
+typedef float buffer_t;
+
+inline buffer_t toBuffer(float sample)
+{
+  return sample;
+}
+
+inline float fromBuffer(buffer_t sample)
+{
+  return sample;
+}
+#endif
+
+#if defined(RX_24KHZ)
+// Reads between ptr and the sample after it, or before it when the fraction is negative
+inline float fromBuffer(const buffer_t* buffer, uint16_t length, uint16_t ptr, float fraction)
+{
+  uint16_t other;
+  if (fraction < 0.0F) {
+    other    = (ptr == 0U) ? (length - 1U) : (ptr - 1U);
+    fraction = -fraction;
+  } else {
+    other = ptr + 1U;
+    if (other >= length)
+      other = 0U;
+  }
+
+  float sample = fromBuffer(buffer[ptr]);
+
+  return sample + (fromBuffer(buffer[other]) - sample) * fraction;
+}
+
+// Where a parabola through the correlations a sample either side of the best one peaks, from -0.5 to +0.5
+inline float getPeakFraction(float early, float peak, float late)
+{
+  float curve = early - 2.0F * peak + late;
+  if (curve >= 0.0F)
+    return 0.0F;
+
+  float fraction = 0.5F * (early - late) / curve;
+
+  if (fraction > 0.5F)
+    return 0.5F;
+  if (fraction < -0.5F)
+    return -0.5F;
+
+  return fraction;
+}
+#endif
+
+#endif
@@ -28,6 +28,9 @@
 
 #include "SerialPort.h"
 
+static thread_local CFrameRB* t_outbound = NULL;
+static thread_local uint64_t  t_captured = 0U;
+
 #define CHECK_BIT(var, bit) \
 	(var & (1 << bit))
 #define UINT8_TO_FLOAT(var) \
@@ -41,6 +44,9 @@ const uint8_t MMDVM_SET_CONFIG   = 0x02U;
 const uint8_t MMDVM_SET_MODE     = 0x03U;
 const uint8_t MMDVM_SET_FREQ     = 0x04U;
 
+const uint8_t MMDVM_GET_AUDIO    = 0x06U;
+const uint8_t MMDVM_GET_STATS    = 0x07U;
+
 const uint8_t MMDVM_CAL_DATA     = 0x08U;
 const uint8_t MMDVM_RSSI_DATA    = 0x09U;
 
@@ -74,6 +80,63 @@ const uint8_t MMDVM_POCSAG_DATA  = 0x50U;
 const uint8_t MMDVM_ACK          = 0x70U;
 const uint8_t MMDVM_NAK          = 0x7FU;
 
+// The receiver a frame to the host comes from, and what it says
+static bool getRXMode(uint8_t operation, RX_MODE& mode, RX_FRAME& frame)
+{
+	switch (operation) {
+	case MMDVM_DSTAR_HEADER:
+	case MMDVM_DSTAR_DATA:
+		mode  = RX_MODE_DSTAR;
+		frame = RX_FRAME_DATA;
+		return true;
+	case MMDVM_DSTAR_LOST:
+		mode  = RX_MODE_DSTAR;
+		frame = RX_FRAME_LOST;
+		return true;
+	case MMDVM_DSTAR_EOT:
+		mode  = RX_MODE_DSTAR;
+		frame = RX_FRAME_END;
+		return true;
+	case MMDVM_DMR_DATA1:
+	case MMDVM_DMR_DATA2:
+		mode  = RX_MODE_DMR;
+		frame = RX_FRAME_DATA;
+		return true;
+	case MMDVM_DMR_LOST1:
+	case MMDVM_DMR_LOST2:
+		mode  = RX_MODE_DMR;
+		frame = RX_FRAME_LOST;
+		return true;
+	case MMDVM_YSF_DATA:
+		mode  = RX_MODE_YSF;
+		frame = RX_FRAME_DATA;
+		return true;
+	case MMDVM_YSF_LOST:
+		mode  = RX_MODE_YSF;
+		frame = RX_FRAME_LOST;
+		return true;
+	case MMDVM_P25_HDR:
+	case MMDVM_P25_LDU:
+		mode  = RX_MODE_P25;
+		frame = RX_FRAME_DATA;
+		return true;
+	case MMDVM_P25_LOST:
+		mode  = RX_MODE_P25;
+		frame = RX_FRAME_LOST;
+		return true;
+	case MMDVM_NXDN_DATA:
+		mode  = RX_MODE_NXDN;
+		frame = RX_FRAME_DATA;
+		return true;
+	case MMDVM_NXDN_LOST:
+		mode  = RX_MODE_NXDN;
+		frame = RX_FRAME_LOST;
+		return true;
+	default:
+		return false;
+	}
+}
+
 const uint8_t MMDVM_SERIAL       = 0x80U;
 
 const uint8_t MMDVM_TRANSPARENT  = 0x90U;
@@ -92,13 +155,42 @@ const char HARDWARE[] = concat(DESCRIPTION, __TIME__, __DATE__);
 const uint8_t PROTOCOL_VERSION   = 1U;
 
 
-CSerialPort::CSerialPort() :
+CSerialPort::CSerialPort(CModem& modem) :
+	m_modem(modem),
 	m_ptr(0U),
 	m_len(0U),
 	m_debug(true),
 	m_repeat(),
-	m_ptyPath("/dev/ttyMMDVM0")
+	m_ptyPath("/dev/ttyMMDVM0"),
+	m_fd(-1),
+	m_fdLock(),
+	m_outbound(),
+	m_outboundCount(0U)
+{
+}
+
+void CSerialPort::setThreadOutbound(CFrameRB* outbound)
+{
+	t_outbound = outbound;
+}
+
+void CSerialPort::addOutbound(CFrameRB* outbound)
 {
+	assert(m_outboundCount < MAX_OUTBOUND);
+
+	m_outbound[m_outboundCount++] = outbound;
+}
+
+void CSerialPort::clearOutbound()
+{
+	writeOutbound();
+
+	m_outboundCount = 0U;
+}
+
+void CSerialPort::setCaptureTime(uint64_t captured)
+{
+	t_captured = captured;
 }
 
 void CSerialPort::setPtyPath(const std::string& ptyPath)
@@ -134,7 +226,7 @@ void CSerialPort::sendNAK(mmdvm_frame &frame, uint8_t err)
 
 void CSerialPort::getStatus()
 {
-	io.resetWatchdog();
+	m_modem.io.resetWatchdog();
 
 	uint8_t reply[20U];
 
@@ -144,76 +236,82 @@ void CSerialPort::getStatus()
 	reply[2U]  = MMDVM_GET_STATUS;
 
 	reply[3U]  = 0x00U;
-	if (m_dstarEnable)
+	if (m_modem.dstarEnable)
 		reply[3U] |= 0x01U;
-	if (m_dmrEnable)
+	if (m_modem.dmrEnable)
 		reply[3U] |= 0x02U;
-	if (m_ysfEnable)
+	if (m_modem.ysfEnable)
 		reply[3U] |= 0x04U;
-	if (m_p25Enable)
+	if (m_modem.p25Enable)
 		reply[3U] |= 0x08U;
-	if (m_nxdnEnable)
+	if (m_modem.nxdnEnable)
 		reply[3U] |= 0x10U;
-	if (m_pocsagEnable)
+	if (m_modem.pocsagEnable)
 		reply[3U] |= 0x20U;
 
-	reply[4U]  = uint8_t(m_modemState);
+	reply[4U]  = uint8_t(m_modem.modemState);
 
-	reply[5U]  = m_tx  ? 0x01U : 0x00U;
+	reply[5U]  = m_modem.tx  ? 0x01U : 0x00U;
 
 	bool adcOverflow;
 	bool dacOverflow;
-	io.getOverflow(adcOverflow, dacOverflow);
+	m_modem.io.getOverflow(adcOverflow, dacOverflow);
 
 	if (adcOverflow)
 		reply[5U] |= 0x02U;
 
-	if (io.hasRXOverflow())
+	if (m_modem.io.hasRXOverflow())
 		reply[5U] |= 0x04U;
 
-	if (io.hasTXOverflow())
+	if (m_modem.io.hasTXOverflow())
 		reply[5U] |= 0x08U;
 
-	if (io.hasLockout())
+	if (m_modem.io.hasLockout())
 		reply[5U] |= 0x10U;
 
 	if (dacOverflow)
 		reply[5U] |= 0x20U;
 
-	reply[5U] |= m_dcd ? 0x40U : 0x00U;
+	reply[5U] |= m_modem.dcd ? 0x40U : 0x00U;
 
-	if (m_dstarEnable)
-		reply[6U] = dstarTX.getSpace();
-	else
-		reply[6U] = 0U;
+	reply[6U] = 0U;
+#if defined(MODE_DSTAR)
+	if (m_modem.dstarEnable)
+		reply[6U] = m_modem.dstarTX.getSpace();
+#endif
 
-	if (m_dmrEnable) {
+	reply[7U] = 0U;
+	reply[8U] = 0U;
+#if defined(MODE_DMR)
+	if (m_modem.dmrEnable) {
 		reply[7U] = 10U;
-		reply[8U] = dmrDMOTX.getSpace();
-	} else {
-		reply[7U] = 0U;
-		reply[8U] = 0U;
+		reply[8U] = m_modem.dmrDMOTX.getSpace();
 	}
-
-	if (m_ysfEnable)
-		reply[9U] = ysfTX.getSpace();
-	else
-		reply[9U] = 0U;
-
-	if (m_p25Enable)
-		reply[10U] = p25TX.getSpace();
-	else
-		reply[10U] = 0U;
-
-	if (m_nxdnEnable)
-		reply[11U] = nxdnTX.getSpace();
-	else
-		reply[11U] = 0U;
-
-	if (m_pocsagEnable)
-		reply[12U] = pocsagTX.getSpace();
-	else
-		reply[12U] = 0U;
+#endif
+
+	reply[9U] = 0U;
+#if defined(MODE_YSF)
+	if (m_modem.ysfEnable)
+		reply[9U] = m_modem.ysfTX.getSpace();
+#endif
+
+	reply[10U] = 0U;
+#if defined(MODE_P25)
+	if (m_modem.p25Enable)
+		reply[10U] = m_modem.p25TX.getSpace();
+#endif
+
+	reply[11U] = 0U;
+#if defined(MODE_NXDN)
+	if (m_modem.nxdnEnable)
+		reply[11U] = m_modem.nxdnTX.getSpace();
+#endif
+
+	reply[12U] = 0U;
+#if defined(MODE_POCSAG)
+	if (m_modem.pocsagEnable)
+		reply[12U] = m_modem.pocsagTX.getSpace();
+#endif
 
 	write(reply, 13);
 }
@@ -237,6 +335,113 @@ void CSerialPort::getVersion()
 	write(reply, count);
 }
 
+static uint8_t* putUInt16(uint8_t* p, uint16_t value)
+{
+	*p++ = value >> 8;
+	*p++ = value;
+
+	return p;
+}
+
+static uint8_t* putUInt32(uint8_t* p, uint32_t value)
+{
+	*p++ = value >> 24;
+	*p++ = value >> 16;
+	*p++ = value >> 8;
+	*p++ = value;
+
+	return p;
+}
+
+void CSerialPort::getAudio()
+{
+	const CAudioStats& stats = m_modem.io.getAudioStats();
+
+	uint8_t reply[17U + AUDIO_EVENT_COUNT * 8U + CAudioStats::RECENT_EVENTS * 5U];
+
+	// The occupancy, high water mark and length of the receive and transmit rings
+	reply[0U] = MMDVM_FRAME_START;
+	reply[1U] = 0U;
+	reply[2U] = MMDVM_GET_AUDIO;
+
+	uint8_t* p = reply + 3U;
+	p = putUInt16(p, stats.getRXLevel());
+	p = putUInt16(p, stats.getRXHighWater());
+	p = putUInt16(p, stats.getRXLength());
+	p = putUInt16(p, stats.getTXLevel());
+	p = putUInt16(p, stats.getTXHighWater());
+	p = putUInt16(p, stats.getTXLength());
+
+	// How often each kind of loss happened and the samples lost
+	*p++ = AUDIO_EVENT_COUNT;
+	for (unsigned int i = 0U; i < AUDIO_EVENT_COUNT; i++) {
+		p = putUInt32(p, stats.getEvents(AUDIO_EVENT(i)));
+		p = putUInt32(p, stats.getSamples(AUDIO_EVENT(i)));
+	}
+
+	// The most recent losses, newest first, with how many ms ago they were
+	AudioEvent events[CAudioStats::RECENT_EVENTS];
+	unsigned int count = stats.getRecent(events);
+	uint64_t time = CAudioStats::getTime();
+
+	*p++ = count;
+	for (unsigned int i = 0U; i < count; i++) {
+		uint64_t age = time > events[i].time ? time - events[i].time : 0U;
+
+		*p++ = events[i].event;
+		p = putUInt32(p, age > 0xFFFFFFFFU ? 0xFFFFFFFFU : uint32_t(age));
+	}
+
+	reply[1U] = p - reply;
+
+	write(reply, reply[1U]);
+}
+
+#if defined(STAGE_STATS)
+void CSerialPort::getStats()
+{
+	uint8_t reply[5U + STAGE_COUNT * 4U + RX_MODE_COUNT * 6U];
+
+	// The CPU budget, in 0.01% of a core, and calls per second of each stage
+	reply[0U] = MMDVM_FRAME_START;
+	reply[1U] = 5U + STAGE_COUNT * 4U + RX_MODE_COUNT * 6U;
+	reply[2U] = MMDVM_GET_STATS;
+	reply[3U] = STAGE_COUNT;
+
+	uint8_t count = 4U;
+	for (unsigned int i = 0U; i < STAGE_COUNT; i++) {
+		uint16_t budget = m_modem.stats.getBudget(STATS_STAGE(i));
+		uint32_t calls  = m_modem.stats.getCalls(STATS_STAGE(i));
+		if (calls > 0xFFFFU)
+			calls = 0xFFFFU;
+
+		reply[count++] = budget >> 8;
+		reply[count++] = budget;
+		reply[count++] = calls >> 8;
+		reply[count++] = calls;
+	}
+
+	// Then the receive latency of each mode, the median, 99th percentile and largest, in 0.1ms
+	reply[count++] = RX_MODE_COUNT;
+
+	for (unsigned int i = 0U; i < RX_MODE_COUNT; i++) {
+		const CLatencyHistogram& latency = m_modem.stats.getLatency(RX_MODE(i));
+
+		uint32_t values[3U] = { latency.getPercentile(50U), latency.getPercentile(99U), latency.getMax() };
+		for (unsigned int j = 0U; j < 3U; j++) {
+			uint32_t value = values[j] / 100U;
+			if (value > 0xFFFFU)
+				value = 0xFFFFU;
+
+			reply[count++] = value >> 8;
+			reply[count++] = value;
+		}
+	}
+
+	write(reply, count);
+}
+#endif
+
 uint8_t CSerialPort::setConfig(mmdvm_frame &frame)
 {
 	if(frame.length != sizeof(mmdvm_config_frame) + 3)
@@ -254,13 +459,15 @@ uint8_t CSerialPort::setConfig(mmdvm_frame &frame)
 
 
 	m_debug = CHECK_BIT(config.config_flags, 4);
+	m_modem.debug.setEnabled(m_debug);
 
-	bool dstarEnable  = CHECK_BIT(config.protocol_enable_flags, 0);
-	bool dmrEnable    = CHECK_BIT(config.protocol_enable_flags, 1);
-	bool ysfEnable    = CHECK_BIT(config.protocol_enable_flags, 2);
-	bool p25Enable    = CHECK_BIT(config.protocol_enable_flags, 3);
-	bool nxdnEnable   = CHECK_BIT(config.protocol_enable_flags, 4);
-	bool pocsagEnable = CHECK_BIT(config.protocol_enable_flags, 5);
+	// Modes left out of the build are never enabled
+	bool dstarEnable  = HAS_DSTAR  && CHECK_BIT(config.protocol_enable_flags, 0);
+	bool dmrEnable    = HAS_DMR    && CHECK_BIT(config.protocol_enable_flags, 1);
+	bool ysfEnable    = HAS_YSF    && CHECK_BIT(config.protocol_enable_flags, 2);
+	bool p25Enable    = HAS_P25    && CHECK_BIT(config.protocol_enable_flags, 3);
+	bool nxdnEnable   = HAS_NXDN   && CHECK_BIT(config.protocol_enable_flags, 4);
+	bool pocsagEnable = HAS_POCSAG && CHECK_BIT(config.protocol_enable_flags, 5);
 
 
 	MMDVM_STATE modemState = MMDVM_STATE(config.modem_state);
@@ -293,17 +500,29 @@ uint8_t CSerialPort::setConfig(mmdvm_frame &frame)
 		return 4;
 	if (modemState == STATE_POCSAG && !pocsagEnable)
 		return 4;
+	if (modemState == STATE_DSTARCAL && !HAS_DSTAR)
+		return 4;
+	if ((modemState == STATE_DMRCAL || modemState == STATE_LFCAL || modemState == STATE_DMRDMO1K) && !HAS_DMR)
+		return 4;
+	if (modemState == STATE_P25CAL1K && !HAS_P25)
+		return 4;
+	if (modemState == STATE_NXDNCAL1K && !HAS_NXDN)
+		return 4;
+	if (modemState == STATE_CALPOCSAG && !HAS_POCSAG)
+		return 4;
 
+	// Let any IDLE worker threads finish before the state and the receivers change
+	m_modem.io.flush();
 
-	m_modemState  = modemState;
+	m_modem.modemState  = modemState;
 
-	m_dstarEnable  = dstarEnable;
-	m_dmrEnable    = dmrEnable;
-	m_ysfEnable    = ysfEnable;
-	m_p25Enable    = p25Enable;
-	m_nxdnEnable   = nxdnEnable;
-	m_pocsagEnable = pocsagEnable;
-	m_duplex       = !simplex;
+	m_modem.dstarEnable  = dstarEnable;
+	m_modem.dmrEnable    = dmrEnable;
+	m_modem.ysfEnable    = ysfEnable;
+	m_modem.p25Enable    = p25Enable;
+	m_modem.nxdnEnable   = nxdnEnable;
+	m_modem.pocsagEnable = pocsagEnable;
+	m_modem.duplex       = !simplex;
 
 	float rxLevel = float(config.rx_level) / 255.0F;
 	float cwIdTXLevel  = float(config.cw_id_level) / 255.0F;
@@ -311,7 +530,9 @@ uint8_t CSerialPort::setConfig(mmdvm_frame &frame)
 	if (config.color_code > 15)
 		return 4;
 
-	dmrDMORX.setColorCode(config.color_code);
+#if defined(MODE_DMR)
+	m_modem.dmrDMORX.setColorCode(config.color_code);
+#endif
 
 	// XXX Where are bytes 7 and 8?
 
@@ -328,18 +549,37 @@ uint8_t CSerialPort::setConfig(mmdvm_frame &frame)
 	if (config.tx_delay > 50U)
 		return 4;
 
-	dstarTX.setTXDelay(config.tx_delay);
-	ysfTX.setTXDelay(config.tx_delay);
-	p25TX.setTXDelay(config.tx_delay);
-	dmrDMOTX.setTXDelay(config.tx_delay);
-	nxdnTX.setTXDelay(config.tx_delay);
-	pocsagTX.setTXDelay(config.tx_delay);
-
-	ysfTX.setParams(ysfLoDev, config.ysf_tx_hang);
-
-	io.setParameters(rxInvert, txInvert, pttInvert, rxLevel, cwIdTXLevel, dstarTXLevel, dmrTXLevel, ysfTXLevel, p25TXLevel, nxdnTXLevel, pocsagTXLevel, txDCOffset, rxDCOffset);
-
-	io.start();
+#if defined(MODE_DSTAR)
+	m_modem.dstarTX.setTXDelay(config.tx_delay);
+#endif
+#if defined(MODE_YSF)
+	m_modem.ysfTX.setTXDelay(config.tx_delay);
+#endif
+#if defined(MODE_P25)
+	m_modem.p25TX.setTXDelay(config.tx_delay);
+#endif
+#if defined(MODE_DMR)
+	m_modem.dmrDMOTX.setTXDelay(config.tx_delay);
+#endif
+#if defined(MODE_NXDN)
+	m_modem.nxdnTX.setTXDelay(config.tx_delay);
+#endif
+#if defined(MODE_POCSAG)
+	m_modem.pocsagTX.setTXDelay(config.tx_delay);
+#endif
+
+#if defined(MODE_YSF)
+	m_modem.ysfTX.setParams(ysfLoDev, config.ysf_tx_hang);
+#else
+	(void)ysfLoDev;
+#endif
+
+	m_modem.io.setParameters(rxInvert, txInvert, pttInvert, rxLevel, cwIdTXLevel, dstarTXLevel, dmrTXLevel, ysfTXLevel, p25TXLevel, nxdnTXLevel, pocsagTXLevel, txDCOffset, rxDCOffset);
+
+	// The enabled modes decide which receive chains run
+	m_modem.io.setMode();
+
+	m_modem.io.start();
 
 	return 0U;
 }
@@ -351,7 +591,7 @@ uint8_t CSerialPort::setMode(mmdvm_frame &frame)
 
 	MMDVM_STATE modemState = MMDVM_STATE(frame.mode);
 
-	if (modemState == m_modemState)
+	if (modemState == m_modem.modemState)
 		return 0;
 
 	if (modemState != STATE_IDLE &&
@@ -370,17 +610,27 @@ uint8_t CSerialPort::setMode(mmdvm_frame &frame)
 	    modemState != STATE_NXDNCAL1K &&
             modemState != STATE_CALPOCSAG)
 		return 4;
-	if (modemState == STATE_DSTAR && !m_dstarEnable)
+	if (modemState == STATE_DSTAR && !m_modem.dstarEnable)
+		return 4;
+	if (modemState == STATE_DMR && !m_modem.dmrEnable)
+		return 4;
+	if (modemState == STATE_YSF && !m_modem.ysfEnable)
+		return 4;
+	if (modemState == STATE_P25 && !m_modem.p25Enable)
+		return 4;
+	if (modemState == STATE_NXDN && !m_modem.nxdnEnable)
 		return 4;
-	if (modemState == STATE_DMR && !m_dmrEnable)
+	if (modemState == STATE_POCSAG && !m_modem.pocsagEnable)
 		return 4;
-	if (modemState == STATE_YSF && !m_ysfEnable)
+	if (modemState == STATE_DSTARCAL && !HAS_DSTAR)
 		return 4;
-	if (modemState == STATE_P25 && !m_p25Enable)
+	if ((modemState == STATE_DMRCAL || modemState == STATE_LFCAL || modemState == STATE_DMRDMO1K) && !HAS_DMR)
 		return 4;
-	if (modemState == STATE_NXDN && !m_nxdnEnable)
+	if (modemState == STATE_P25CAL1K && !HAS_P25)
 		return 4;
-	if (modemState == STATE_POCSAG && !m_pocsagEnable)
+	if (modemState == STATE_NXDNCAL1K && !HAS_NXDN)
+		return 4;
+	if (modemState == STATE_CALPOCSAG && !HAS_POCSAG)
 		return 4;
 
 	setMode(modemState);
@@ -438,26 +688,39 @@ void CSerialPort::setMode(MMDVM_STATE modemState)
 		break;
 	}
 
+	// Let any IDLE worker threads finish before the receivers are reset
+	m_modem.io.flush();
+
+#if defined(MODE_DSTAR)
 	if (modemState != STATE_DSTAR)
-		dstarRX.reset();
+		m_modem.dstarRX.reset();
+#endif
 
+#if defined(MODE_DMR)
 	if (modemState != STATE_DMR)
-		dmrDMORX.reset();
+		m_modem.dmrDMORX.reset();
+#endif
 
+#if defined(MODE_YSF)
 	if (modemState != STATE_YSF)
-		ysfRX.reset();
+		m_modem.ysfRX.reset();
+#endif
 
+#if defined(MODE_P25)
 	if (modemState != STATE_P25)
-		p25RX.reset();
+		m_modem.p25RX.reset();
+#endif
 
+#if defined(MODE_NXDN)
 	if (modemState != STATE_NXDN)
-		nxdnRX.reset();
+		m_modem.nxdnRX.reset();
+#endif
 
-	cwIdTX.reset();
+	m_modem.cwIdTX.reset();
 
-	m_modemState = modemState;
+	m_modem.modemState = modemState;
 
-	io.setMode();
+	m_modem.io.setMode();
 }
 
 bool CSerialPort::open() {
@@ -499,6 +762,34 @@ int CSerialPort::write(const unsigned char* buffer, unsigned int length)
 	if (length == 0U)
 		return 0;
 
+	RX_MODE mode;
+	RX_FRAME frame;
+	if (length > 2U && getRXMode(buffer[2U], mode, frame)) {
+		m_modem.metrics.addFrame(mode, frame);
+
+#if defined(STAGE_STATS)
+		if (t_captured != 0U && frame == RX_FRAME_DATA)
+			m_modem.stats.addLatency(mode, t_captured);
+#endif
+	}
+
+	if (t_outbound != NULL) {
+		STATS_START(writeStart);
+		if (!t_outbound->put(buffer, length))
+			::fprintf(stderr, "Outbound queue overflow, frame dropped\n");
+		STATS_STOP(m_modem.stats, writeStart, STAGE_SERIAL_WRITE);
+		return length;
+	}
+
+	return writePty(buffer, length);
+}
+
+int CSerialPort::writePty(const unsigned char* buffer, unsigned int length)
+{
+	STATS_START(writeStart);
+
+	std::lock_guard<std::mutex> lock(m_fdLock);
+
 	unsigned int ptr = 0U;
 	while (ptr < length) {
 		ssize_t n = ::write(m_fd, buffer + ptr, length - ptr);
@@ -513,21 +804,38 @@ int CSerialPort::write(const unsigned char* buffer, unsigned int length)
 			ptr += n;
 	}
 
+	STATS_STOP(m_modem.stats, writeStart, STAGE_SERIAL_WRITE);
+
 	return length;
 }
 
 
+void CSerialPort::writeOutbound()
+{
+	uint8_t buffer[200U];
+
+	// Each queue holds complete frames, so draining one at a time keeps them whole
+	for (uint8_t i = 0U; i < m_outboundCount; i++) {
+		uint16_t n;
+		while ((n = m_outbound[i]->get(buffer, 200U)) > 0U)
+			writePty(buffer, n);
+	}
+}
+
 void CSerialPort::process()
 {
 	mmdvm_frame frame = { 0 };
 	uint8_t err = 2;
 
+	writeOutbound();
+
 	int read_bytes = ::read(m_fd, (void *) &frame, 2);
 	if(read_bytes < 0) {
 		if(errno == EAGAIN) {
 			return;
 		} else if(errno == EIO) {
 			::fprintf(stderr, "Slave disconnected, reopening master\n");
+			std::lock_guard<std::mutex> lock(m_fdLock);
 			::close(m_fd);
 			open();
 			return;
@@ -581,6 +889,16 @@ void CSerialPort::process()
 	case MMDVM_GET_VERSION:
 		getVersion();
 		break;
+	case MMDVM_GET_AUDIO:
+		getAudio();
+		break;
+	case MMDVM_GET_STATS:
+#if defined(STAGE_STATS)
+		getStats();
+#else
+		sendNAK(frame, 1);
+#endif
+		break;
 	case MMDVM_SET_CONFIG:
 		err = setConfig(frame);
 		if (err == 0U)
@@ -601,16 +919,24 @@ void CSerialPort::process()
 		break;
 
 	case MMDVM_CAL_DATA:
-		if (m_modemState == STATE_DSTARCAL)
-			err = calDStarTX.write(frame.data, frame.length - 3U);
-		if (m_modemState == STATE_DMRCAL ||
-		    m_modemState == STATE_LFCAL ||
-		    m_modemState == STATE_DMRDMO1K)
-			err = calDMR.write(frame.data, frame.length - 3U);
-		if (m_modemState == STATE_P25CAL1K)
-			err = calP25.write(frame.data, frame.length - 3U);
-		if (m_modemState == STATE_NXDNCAL1K)
-			err = calNXDN.write(frame.data, frame.length - 3U);
+#if defined(MODE_DSTAR)
+		if (m_modem.modemState == STATE_DSTARCAL)
+			err = m_modem.calDStarTX.write(frame.data, frame.length - 3U);
+#endif
+#if defined(MODE_DMR)
+		if (m_modem.modemState == STATE_DMRCAL ||
+		    m_modem.modemState == STATE_LFCAL ||
+		    m_modem.modemState == STATE_DMRDMO1K)
+			err = m_modem.calDMR.write(frame.data, frame.length - 3U);
+#endif
+#if defined(MODE_P25)
+		if (m_modem.modemState == STATE_P25CAL1K)
+			err = m_modem.calP25.write(frame.data, frame.length - 3U);
+#endif
+#if defined(MODE_NXDN)
+		if (m_modem.modemState == STATE_NXDNCAL1K)
+			err = m_modem.calNXDN.write(frame.data, frame.length - 3U);
+#endif
 		if (err == 0U) {
 			sendACK(frame);
 		} else {
@@ -621,8 +947,8 @@ void CSerialPort::process()
 
 	case MMDVM_SEND_CWID:
 		err = 5;
-		if (m_modemState == STATE_IDLE)
-			err = cwIdTX.write(frame.data, frame.length - 3U);
+		if (m_modem.modemState == STATE_IDLE)
+			err = m_modem.cwIdTX.write(frame.data, frame.length - 3U);
 		if (err != 0) {
 			DEBUG2("Invalid CW Id data", err);
 			sendNAK(frame, err);
@@ -631,12 +957,14 @@ void CSerialPort::process()
 
 
 	case MMDVM_DSTAR_HEADER:
-		if (m_dstarEnable) {
-			if (m_modemState == STATE_IDLE || m_modemState == STATE_DSTAR)
-				err = dstarTX.writeHeader(frame.data, frame.length - 3);
+#if defined(MODE_DSTAR)
+		if (m_modem.dstarEnable) {
+			if (m_modem.modemState == STATE_IDLE || m_modem.modemState == STATE_DSTAR)
+				err = m_modem.dstarTX.writeHeader(frame.data, frame.length - 3);
 		}
+#endif
 		if (err == 0U) {
-			if (m_modemState == STATE_IDLE)
+			if (m_modem.modemState == STATE_IDLE)
 				setMode(STATE_DSTAR);
 		} else {
 			DEBUG2("Received invalid D-Star header", err);
@@ -645,12 +973,14 @@ void CSerialPort::process()
 		break;
 
 	case MMDVM_DSTAR_DATA:
-		if (m_dstarEnable) {
-			if (m_modemState == STATE_IDLE || m_modemState == STATE_DSTAR)
-				err = dstarTX.writeData(frame.data, frame.length - 3);
+#if defined(MODE_DSTAR)
+		if (m_modem.dstarEnable) {
+			if (m_modem.modemState == STATE_IDLE || m_modem.modemState == STATE_DSTAR)
+				err = m_modem.dstarTX.writeData(frame.data, frame.length - 3);
 		}
+#endif
 		if (err == 0U) {
-			if (m_modemState == STATE_IDLE)
+			if (m_modem.modemState == STATE_IDLE)
 				setMode(STATE_DSTAR);
 		} else {
 			DEBUG2("Received invalid D-Star data", err);
@@ -659,12 +989,14 @@ void CSerialPort::process()
 		break;
 
 	case MMDVM_DSTAR_EOT:
-		if (m_dstarEnable) {
-			if (m_modemState == STATE_IDLE || m_modemState == STATE_DSTAR)
-				err = dstarTX.writeEOT();
+#if defined(MODE_DSTAR)
+		if (m_modem.dstarEnable) {
+			if (m_modem.modemState == STATE_IDLE || m_modem.modemState == STATE_DSTAR)
+				err = m_modem.dstarTX.writeEOT();
 		}
+#endif
 		if (err == 0U) {
-			if (m_modemState == STATE_IDLE)
+			if (m_modem.modemState == STATE_IDLE)
 				setMode(STATE_DSTAR);
 		} else {
 			DEBUG2("Received invalid D-Star EOT", err);
@@ -673,12 +1005,14 @@ void CSerialPort::process()
 		break;
 
 	case MMDVM_DMR_DATA2:
-		if (m_dmrEnable) {
-			if (m_modemState == STATE_IDLE || m_modemState == STATE_DMR)
-				err = dmrDMOTX.writeData(frame.data, frame.length - 3);
+#if defined(MODE_DMR)
+		if (m_modem.dmrEnable) {
+			if (m_modem.modemState == STATE_IDLE || m_modem.modemState == STATE_DMR)
+				err = m_modem.dmrDMOTX.writeData(frame.data, frame.length - 3);
 		}
+#endif
 		if (err == 0U) {
-			if (m_modemState == STATE_IDLE)
+			if (m_modem.modemState == STATE_IDLE)
 				setMode(STATE_DMR);
 		} else {
 			DEBUG2("Received invalid DMR data", err);
@@ -687,12 +1021,14 @@ void CSerialPort::process()
 		break;
 
 	case MMDVM_YSF_DATA:
-		if (m_ysfEnable) {
-			if (m_modemState == STATE_IDLE || m_modemState == STATE_YSF)
-				err = ysfTX.writeData(frame.data, frame.length - 3);
+#if defined(MODE_YSF)
+		if (m_modem.ysfEnable) {
+			if (m_modem.modemState == STATE_IDLE || m_modem.modemState == STATE_YSF)
+				err = m_modem.ysfTX.writeData(frame.data, frame.length - 3);
 		}
+#endif
 		if (err == 0U) {
-			if (m_modemState == STATE_IDLE)
+			if (m_modem.modemState == STATE_IDLE)
 				setMode(STATE_YSF);
 		} else {
 			DEBUG2("Received invalid System Fusion data", err);
@@ -701,12 +1037,14 @@ void CSerialPort::process()
 		break;
 
 	case MMDVM_P25_HDR:
-		if (m_p25Enable) {
-			if (m_modemState == STATE_IDLE || m_modemState == STATE_P25)
-				err = p25TX.writeData(frame.data, frame.length - 3);
+#if defined(MODE_P25)
+		if (m_modem.p25Enable) {
+			if (m_modem.modemState == STATE_IDLE || m_modem.modemState == STATE_P25)
+				err = m_modem.p25TX.writeData(frame.data, frame.length - 3);
 		}
+#endif
 		if (err == 0U) {
-			if (m_modemState == STATE_IDLE)
+			if (m_modem.modemState == STATE_IDLE)
 				setMode(STATE_P25);
 		} else {
 			DEBUG2("Received invalid P25 header", err);
@@ -715,12 +1053,14 @@ void CSerialPort::process()
 		break;
 
 	case MMDVM_P25_LDU:
-		if (m_p25Enable) {
-			if (m_modemState == STATE_IDLE || m_modemState == STATE_P25)
-				err = p25TX.writeData(frame.data, frame.length - 3);
+#if defined(MODE_P25)
+		if (m_modem.p25Enable) {
+			if (m_modem.modemState == STATE_IDLE || m_modem.modemState == STATE_P25)
+				err = m_modem.p25TX.writeData(frame.data, frame.length - 3);
 		}
+#endif
 		if (err == 0U) {
-			if (m_modemState == STATE_IDLE)
+			if (m_modem.modemState == STATE_IDLE)
 				setMode(STATE_P25);
 		} else {
 			DEBUG2("Received invalid P25 LDU", err);
@@ -729,12 +1069,14 @@ void CSerialPort::process()
 		break;
 
 	case MMDVM_NXDN_DATA:
-		if (m_nxdnEnable) {
-			if (m_modemState == STATE_IDLE || m_modemState == STATE_NXDN)
-				err = nxdnTX.writeData(frame.data, frame.length - 3);
+#if defined(MODE_NXDN)
+		if (m_modem.nxdnEnable) {
+			if (m_modem.modemState == STATE_IDLE || m_modem.modemState == STATE_NXDN)
+				err = m_modem.nxdnTX.writeData(frame.data, frame.length - 3);
 		}
+#endif
 		if (err == 0U) {
-			if (m_modemState == STATE_IDLE)
+			if (m_modem.modemState == STATE_IDLE)
 				setMode(STATE_NXDN);
 		} else {
 			DEBUG2("Received invalid NXDN data", err);
@@ -743,12 +1085,14 @@ void CSerialPort::process()
 		break;
 
 	case MMDVM_POCSAG_DATA:
-		if (m_pocsagEnable) {
-			if (m_modemState == STATE_IDLE || m_modemState == STATE_POCSAG)
-				err = pocsagTX.writeData(frame.data, frame.length - 3);
+#if defined(MODE_POCSAG)
+		if (m_modem.pocsagEnable) {
+			if (m_modem.modemState == STATE_IDLE || m_modem.modemState == STATE_POCSAG)
+				err = m_modem.pocsagTX.writeData(frame.data, frame.length - 3);
 		}
+#endif
 		if (err == 0U) {
-			if (m_modemState == STATE_IDLE)
+			if (m_modem.modemState == STATE_IDLE)
 				setMode(STATE_POCSAG);
 		} else {
 			DEBUG2("Received invalid POCSAG data", err);
@@ -767,7 +1111,7 @@ void CSerialPort::process()
 	}
 
 	// XXX Evaluate this.  Don't think this is needed.
-	if (io.getWatchdog() >= 48000U) {
+	if (m_modem.io.getWatchdog() >= 48000U) {
 		m_ptr = 0U;
 		m_len = 0U;
 	}
@@ -784,16 +1128,16 @@ inline void CSerialPort::writeSingleByteReply(const uint8_t reply) {
 }
 
 void CSerialPort::writeDStarLost() {
-	if (!m_dstarEnable ||
-	    (m_modemState != STATE_DSTAR && m_modemState != STATE_IDLE))
+	if (!m_modem.dstarEnable ||
+	    (m_modem.modemState != STATE_DSTAR && m_modem.modemState != STATE_IDLE))
 		return;
 
 	writeSingleByteReply(MMDVM_DSTAR_LOST);
 }
 
 void CSerialPort::writeDStarEOT() {
-	if (!m_dstarEnable ||
-	    (m_modemState != STATE_DSTAR && m_modemState != STATE_IDLE))
+	if (!m_modem.dstarEnable ||
+	    (m_modem.modemState != STATE_DSTAR && m_modem.modemState != STATE_IDLE))
 		return;
 
 	writeSingleByteReply(MMDVM_DSTAR_EOT);
@@ -814,10 +1158,10 @@ void CSerialPort::writeDataFrame(const uint8_t operation, const uint8_t *data, u
 
 
 void CSerialPort::writeDStarHeader(const uint8_t* header, uint8_t length) {
-	if (m_modemState != STATE_DSTAR && m_modemState != STATE_IDLE)
+	if (m_modem.modemState != STATE_DSTAR && m_modem.modemState != STATE_IDLE)
 		return;
 
-	if (!m_dstarEnable)
+	if (!m_modem.dstarEnable)
 		return;
 
 	uint8_t reply[50U];
@@ -835,10 +1179,10 @@ void CSerialPort::writeDStarHeader(const uint8_t* header, uint8_t length) {
 }
 
 void CSerialPort::writeDStarData(const uint8_t* data, uint8_t length) {
-	if (m_modemState != STATE_DSTAR && m_modemState != STATE_IDLE)
+	if (m_modem.modemState != STATE_DSTAR && m_modem.modemState != STATE_IDLE)
 		return;
 
-	if (!m_dstarEnable)
+	if (!m_modem.dstarEnable)
 		return;
 
 	uint8_t reply[20U];
@@ -857,10 +1201,10 @@ void CSerialPort::writeDStarData(const uint8_t* data, uint8_t length) {
 }
 
 void CSerialPort::writeDMRData(bool slot, const uint8_t* data, uint8_t length) {
-	if (m_modemState != STATE_DMR && m_modemState != STATE_IDLE)
+	if (m_modem.modemState != STATE_DMR && m_modem.modemState != STATE_IDLE)
 		return;
 
-	if (!m_dmrEnable)
+	if (!m_modem.dmrEnable)
 		return;
 
 	uint8_t reply[40U];
@@ -879,8 +1223,8 @@ void CSerialPort::writeDMRData(bool slot, const uint8_t* data, uint8_t length) {
 }
 
 void CSerialPort::writeDMRLost(bool slot) {
-	if (!m_dmrEnable ||
-	    (m_modemState != STATE_DMR && m_modemState != STATE_IDLE))
+	if (!m_modem.dmrEnable ||
+	    (m_modem.modemState != STATE_DMR && m_modem.modemState != STATE_IDLE))
 		return;
 
 	writeSingleByteReply(slot ? MMDVM_DMR_LOST2 : MMDVM_DMR_LOST1);
@@ -888,10 +1232,10 @@ void CSerialPort::writeDMRLost(bool slot) {
 
 void CSerialPort::writeYSFData(const uint8_t* data, uint8_t length)
 {
-	if (m_modemState != STATE_YSF && m_modemState != STATE_IDLE)
+	if (m_modem.modemState != STATE_YSF && m_modem.modemState != STATE_IDLE)
 		return;
 
-	if (!m_ysfEnable)
+	if (!m_modem.ysfEnable)
 		return;
 
 	uint8_t reply[130U];
@@ -910,8 +1254,8 @@ void CSerialPort::writeYSFData(const uint8_t* data, uint8_t length)
 }
 
 void CSerialPort::writeYSFLost() {
-	if (!m_ysfEnable ||
-	    (m_modemState != STATE_YSF && m_modemState != STATE_IDLE))
+	if (!m_modem.ysfEnable ||
+	    (m_modem.modemState != STATE_YSF && m_modem.modemState != STATE_IDLE))
 		return;
 
 	writeSingleByteReply(MMDVM_YSF_LOST);
@@ -919,10 +1263,10 @@ void CSerialPort::writeYSFLost() {
 
 void CSerialPort::writeP25Hdr(const uint8_t* data, uint8_t length)
 {
-	if (m_modemState != STATE_P25 && m_modemState != STATE_IDLE)
+	if (m_modem.modemState != STATE_P25 && m_modem.modemState != STATE_IDLE)
 		return;
 
-	if (!m_p25Enable)
+	if (!m_modem.p25Enable)
 		return;
 
 	uint8_t reply[120U];
@@ -942,10 +1286,10 @@ void CSerialPort::writeP25Hdr(const uint8_t* data, uint8_t length)
 
 void CSerialPort::writeP25Ldu(const uint8_t* data, uint8_t length)
 {
-	if (m_modemState != STATE_P25 && m_modemState != STATE_IDLE)
+	if (m_modem.modemState != STATE_P25 && m_modem.modemState != STATE_IDLE)
 		return;
 
-	if (!m_p25Enable)
+	if (!m_modem.p25Enable)
 		return;
 
 	uint8_t reply[250U];
@@ -964,8 +1308,8 @@ void CSerialPort::writeP25Ldu(const uint8_t* data, uint8_t length)
 }
 
 void CSerialPort::writeP25Lost() {
-	if (!m_p25Enable ||
-	    (m_modemState != STATE_P25 && m_modemState != STATE_IDLE))
+	if (!m_modem.p25Enable ||
+	    (m_modem.modemState != STATE_P25 && m_modem.modemState != STATE_IDLE))
 		return;
 
 	writeSingleByteReply(MMDVM_P25_LOST);
@@ -973,10 +1317,10 @@ void CSerialPort::writeP25Lost() {
 
 void CSerialPort::writeNXDNData(const uint8_t* data, uint8_t length)
 {
-	if (m_modemState != STATE_NXDN && m_modemState != STATE_IDLE)
+	if (m_modem.modemState != STATE_NXDN && m_modem.modemState != STATE_IDLE)
 		return;
 
-	if (!m_nxdnEnable)
+	if (!m_modem.nxdnEnable)
 		return;
 
 	uint8_t reply[130U];
@@ -995,8 +1339,8 @@ void CSerialPort::writeNXDNData(const uint8_t* data, uint8_t length)
 }
 
 void CSerialPort::writeNXDNLost() {
-	if (!m_nxdnEnable ||
-	    (m_modemState != STATE_NXDN && m_modemState != STATE_IDLE))
+	if (!m_modem.nxdnEnable ||
+	    (m_modem.modemState != STATE_NXDN && m_modem.modemState != STATE_IDLE))
 		return;
 
 	writeSingleByteReply(MMDVM_NXDN_LOST);
@@ -1004,7 +1348,7 @@ void CSerialPort::writeNXDNLost() {
 
 void CSerialPort::writeCalData(const uint8_t* data, uint8_t length)
 {
-	if (m_modemState != STATE_DSTARCAL)
+	if (m_modem.modemState != STATE_DSTARCAL)
 		return;
 
 	uint8_t reply[130U];
@@ -1024,7 +1368,7 @@ void CSerialPort::writeCalData(const uint8_t* data, uint8_t length)
 
 void CSerialPort::writeRSSIData(const uint8_t* data, uint8_t length)
 {
-	if (m_modemState != STATE_RSSICAL)
+	if (m_modem.modemState != STATE_RSSICAL)
 		return;
 
 	uint8_t reply[30U];
@@ -1042,6 +1386,34 @@ void CSerialPort::writeRSSIData(const uint8_t* data, uint8_t length)
 	write(reply, count);
 }
 
+void CSerialPort::writeDebugLog()
+{
+	DebugEvent event;
+	while (m_modem.debug.get(event)) {
+		switch (event.count) {
+		case 0U:
+			writeDebug(event.text);
+			break;
+		case 1U:
+			writeDebug(event.text, event.n[0U]);
+			break;
+		case 2U:
+			writeDebug(event.text, event.n[0U], event.n[1U]);
+			break;
+		case 3U:
+			writeDebug(event.text, event.n[0U], event.n[1U], event.n[2U]);
+			break;
+		default:
+			writeDebug(event.text, event.n[0U], event.n[1U], event.n[2U], event.n[3U]);
+			break;
+		}
+	}
+
+	uint32_t dropped = m_modem.debug.getDropped();
+	if (dropped > 0U)
+		writeDebug("Debug messages dropped", int16_t(dropped > 32767U ? 32767U : dropped));
+}
+
 void CSerialPort::writeDebug(const char* text)
 {
 	if (!m_debug)
@@ -21,8 +21,10 @@
 
 #include "Globals.h"
 #include "SerialRB.h"
+#include "FrameRB.h"
 #include "SerialController.h"
 
+#include <mutex>
 #include <string>
 
 // XXX This may need to move out of here so other things can access it
@@ -67,9 +69,13 @@ struct mmdvm_frame {
 
 #pragma pack(pop)
 
+const uint8_t MAX_OUTBOUND = 4U;
+
+class CModem;
+
 class CSerialPort {
 public:
-  CSerialPort();
+  CSerialPort(CModem& modem);
 
   void setPtyPath(const std::string& ptyPath);
 
@@ -77,6 +83,15 @@ public:
 
   void process();
 
+  // Frames written from a worker thread are queued here instead
+  static void setThreadOutbound(CFrameRB* outbound);
+  void addOutbound(CFrameRB* outbound);
+  // Writes out what is left in the queues and forgets them
+  void clearOutbound();
+
+  // When the last sample of the block being received on this thread was captured
+  static void setCaptureTime(uint64_t captured);
+
   void writeDStarHeader(const uint8_t* header, uint8_t length);
   void writeDStarData(const uint8_t* data, uint8_t length);
   void writeDStarLost();
@@ -98,6 +113,9 @@ public:
   void writeCalData(const uint8_t* data, uint8_t length);
   void writeRSSIData(const uint8_t* data, uint8_t length);
 
+  // Sends the messages queued in the modem's debug log, from the CDebugWriter thread
+  void writeDebugLog();
+
   void writeDebug(const char* text);
   void writeDebug(const char* text, int16_t n1);
   void writeDebug(const char* text, int16_t n1, int16_t n2);
@@ -105,6 +123,12 @@ public:
   void writeDebug(const char* text, int16_t n1, int16_t n2, int16_t n3, int16_t n4);
 
 private:
+  // The offline tools write the frames to a pipe
+  friend class CBench;
+  friend class CBERTest;
+  friend class CGoldenTest;
+
+  CModem&   m_modem;
   uint8_t   m_ptr;
   uint8_t   m_len;
   bool      m_debug;
@@ -112,11 +136,20 @@ private:
   std::string m_ptyPath;
 
   int     m_fd;
+  // Held for each frame written to the pty, the debug writer has its own thread
+  std::mutex m_fdLock;
+
+  CFrameRB* m_outbound[MAX_OUTBOUND];
+  uint8_t   m_outboundCount;
 
   void    sendACK(mmdvm_frame &frame);
   void    sendNAK(mmdvm_frame &frame, uint8_t err);
   void    getStatus();
   void    getVersion();
+  void    getAudio();
+#if defined(STAGE_STATS)
+  void    getStats();
+#endif
   uint8_t setConfig(mmdvm_frame &frame);
   uint8_t setMode(mmdvm_frame &frame);
   void    setMode(MMDVM_STATE modemState);
@@ -132,6 +165,9 @@ private:
   void writeDataFrame(const uint8_t operation, const uint8_t *data, uint8_t length);
 
   int write(const unsigned char* buffer, unsigned int length);
+  // Straight to the pty, for frames already counted when they were queued
+  int writePty(const unsigned char* buffer, unsigned int length);
+  void writeOutbound();
 };
 
 #endif
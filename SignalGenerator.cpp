@@ -0,0 +1,234 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "SignalGenerator.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+// The modulator is flushed once this many passes give nothing but silence
+const unsigned int FLUSH_PASSES = 100U;
+
+static uint64_t getNanoseconds()
+{
+  struct timespec ts;
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return uint64_t(ts.tv_sec) * 1000000000U + ts.tv_nsec;
+}
+
+CSignalGenerator::CSignalGenerator(MMDVM_STATE state) :
+m_state(state),
+m_modem(NULL),
+m_header(state == STATE_DSTAR),
+m_frames()
+{
+  m_modem = new CModem;
+
+  m_modem->modemState = state;
+  m_modem->io.start();
+
+  ::srand(1U);
+}
+
+CSignalGenerator::~CSignalGenerator()
+{
+  delete m_modem;
+}
+
+uint64_t CSignalGenerator::generate(unsigned int frames, unsigned int samples, std::vector<float>& signal)
+{
+  float buffer[TX_RINGBUFFER_SIZE];
+
+  unsigned int count = 0U;
+  unsigned int idle  = 0U;
+  size_t end = signal.size();
+
+  uint64_t start = getNanoseconds();
+
+  while (signal.size() < samples && idle < FLUSH_PASSES) {
+    if (count < frames && writeFrame())
+      count++;
+
+    process();
+
+    int n = TX_RINGBUFFER_SIZE - m_modem->io.getSpace();
+    m_modem->io.writeCallback(buffer, n);
+    signal.insert(signal.end(), buffer, buffer + n);
+
+    // Some modulators pad with silence once they run dry
+    bool silent = true;
+    for (int i = 0; i < n && silent; i++)
+      silent = buffer[i] == 0.0F;
+
+    if (!silent)
+      end = signal.size();
+
+    if (count >= frames && silent)
+      idle++;
+    else
+      idle = 0U;
+  }
+
+  // Drop the padding from the flush
+  if (count >= frames)
+    signal.resize(end);
+
+  return getNanoseconds() - start;
+}
+
+const std::vector<std::vector<uint8_t> >& CSignalGenerator::getFrames() const
+{
+  return m_frames;
+}
+
+bool CSignalGenerator::writeFrame()
+{
+#if defined(MODE_DSTAR)
+  // The D-Star modulator reports a full buffer on the serial port
+  if (m_state == STATE_DSTAR && m_modem->dstarTX.getSpace() == 0U)
+    return false;
+#endif
+
+  uint8_t frame[P25_LDU_FRAME_LENGTH_BYTES + 1U];
+
+  frame[0U] = 0x00U;
+  for (unsigned int i = 1U; i < sizeof(frame); i++)
+    frame[i] = ::rand();
+
+  unsigned int length = 0U;
+  uint8_t ret = 0U;
+
+  switch (m_state) {
+#if defined(MODE_DSTAR)
+    case STATE_DSTAR:
+      if (m_header) {
+        // The header needs a valid checksum, CRC-CCITT as in CDStarRX::checksum()
+        uint8_t* header = frame + 1U;
+        header[0U] = header[1U] = header[2U] = 0x00U;
+
+        uint16_t crc = 0xFFFFU;
+        for (unsigned int i = 0U; i < (DSTAR_HEADER_LENGTH_BYTES - 2U); i++) {
+          crc ^= header[i];
+          for (unsigned int j = 0U; j < 8U; j++)
+            crc = (crc & 0x0001U) ? ((crc >> 1) ^ 0x8408U) : (crc >> 1);
+        }
+        crc = ~crc;
+
+        header[DSTAR_HEADER_LENGTH_BYTES - 2U] = crc & 0xFFU;
+        header[DSTAR_HEADER_LENGTH_BYTES - 1U] = crc >> 8;
+
+        if (m_modem->dstarTX.writeHeader(header, DSTAR_HEADER_LENGTH_BYTES) == 0U)
+          m_header = false;
+
+        return false;
+      }
+
+      // Every 21st frame carries the data sync
+      if ((m_frames.size() % 21U) == 0U)
+        ::memcpy(frame + 1U, DSTAR_DATA_SYNC_BYTES, DSTAR_DATA_LENGTH_BYTES);
+
+      length = DSTAR_DATA_LENGTH_BYTES;
+      ret    = m_modem->dstarTX.writeData(frame + 1U, length);
+      break;
+#endif
+#if defined(MODE_DMR)
+    case STATE_DMR:
+      // Voice superframes, only the first of every six frames has a sync
+      if ((m_frames.size() % 6U) == 0U) {
+        for (unsigned int i = 0U; i < 7U; i++)
+          frame[i + 14U] = (frame[i + 14U] & ~DMR_SYNC_BYTES_MASK[i]) | DMR_MS_VOICE_SYNC_BYTES[i];
+      }
+
+      length = DMR_FRAME_LENGTH_BYTES;
+      ret    = m_modem->dmrDMOTX.writeData(frame, length + 1U);
+      break;
+#endif
+#if defined(MODE_YSF)
+    case STATE_YSF:
+      ::memcpy(frame + 1U, YSF_SYNC_BYTES, YSF_SYNC_BYTES_LENGTH);
+
+      length = YSF_FRAME_LENGTH_BYTES;
+      ret    = m_modem->ysfTX.writeData(frame, length + 1U);
+      break;
+#endif
+#if defined(MODE_P25)
+    case STATE_P25:
+      // An LDU1 NID
+      ::memcpy(frame + 1U, P25_SYNC_BYTES, P25_SYNC_BYTES_LENGTH);
+      frame[7U] = frame[7U] & 0xF0U;
+      frame[8U] = (frame[8U] & 0xF0U) | 0x05U;
+
+      length = P25_LDU_FRAME_LENGTH_BYTES;
+      ret    = m_modem->p25TX.writeData(frame, length + 1U);
+      break;
+#endif
+#if defined(MODE_NXDN)
+    case STATE_NXDN:
+      ::memcpy(frame + 1U, NXDN_FSW_BYTES, NXDN_FSW_BYTES_LENGTH);
+      frame[3U] = (frame[3U] & 0x0FU) | (NXDN_FSW_BYTES[2U] & 0xF0U);
+
+      length = NXDN_FRAME_LENGTH_BYTES;
+      ret    = m_modem->nxdnTX.writeData(frame, length + 1U);
+      break;
+#endif
+    default:
+      return false;
+  }
+
+  if (ret != 0U)
+    return false;
+
+  m_frames.push_back(std::vector<uint8_t>(frame + 1U, frame + 1U + length));
+
+  return true;
+}
+
+void CSignalGenerator::process()
+{
+  switch (m_state) {
+#if defined(MODE_DSTAR)
+    case STATE_DSTAR:
+      m_modem->dstarTX.process();
+      break;
+#endif
+#if defined(MODE_DMR)
+    case STATE_DMR:
+      m_modem->dmrDMOTX.process();
+      break;
+#endif
+#if defined(MODE_YSF)
+    case STATE_YSF:
+      m_modem->ysfTX.process();
+      break;
+#endif
+#if defined(MODE_P25)
+    case STATE_P25:
+      m_modem->p25TX.process();
+      break;
+#endif
+#if defined(MODE_NXDN)
+    case STATE_NXDN:
+      m_modem->nxdnTX.process();
+      break;
+#endif
+    default:
+      break;
+  }
+}
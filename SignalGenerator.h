@@ -0,0 +1,50 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(SIGNALGENERATOR_H)
+#define  SIGNALGENERATOR_H
+
+#include "Globals.h"
+
+#include <vector>
+
+// Makes the signal of a mode with the modem's own modulator, from random
+// payloads with the syncs that the receivers look for. Used by the offline tools.
+class CSignalGenerator {
+public:
+  CSignalGenerator(MMDVM_STATE state);
+  ~CSignalGenerator();
+
+  // Modulates until either the frames or the samples run out, the modulator is
+  // flushed after the last frame. Returns the time taken in ns.
+  uint64_t generate(unsigned int frames, unsigned int samples, std::vector<float>& signal);
+
+  // The payloads, as a receiver gives them to the host
+  const std::vector<std::vector<uint8_t> >& getFrames() const;
+
+private:
+  MMDVM_STATE  m_state;
+  CModem*      m_modem;
+  bool         m_header;
+  std::vector<std::vector<uint8_t> > m_frames;
+
+  bool writeFrame();
+  void process();
+};
+
+#endif
@@ -195,6 +195,7 @@ m_writeDevice(writeDevice),
 m_sampleRate(sampleRate),
 m_blockSize(blockSize),
 m_callback(NULL),
+m_leftCallback(NULL),
 m_reader(NULL),
 m_writer(NULL)
 {
@@ -213,6 +214,15 @@ void CSoundCardReaderWriter::setCallback(IAudioCallback* callback)
 	m_callback = callback;
 }
 
+void CSoundCardReaderWriter::setCallback(IAudioCallback* leftCallback, IAudioCallback* rightCallback)
+{
+	assert(leftCallback != NULL);
+	assert(rightCallback != NULL);
+
+	m_leftCallback = leftCallback;
+	m_callback     = rightCallback;
+}
+
 bool CSoundCardReaderWriter::open()
 {
 	int err = 0;
@@ -267,7 +277,7 @@ bool CSoundCardReaderWriter::open()
 
 	unsigned int playChannels = 1U;
 
-	if ((err = ::snd_pcm_hw_params_set_channels(playHandle, hw_params, 1)) < 0) {
+	if (m_leftCallback != NULL || (err = ::snd_pcm_hw_params_set_channels(playHandle, hw_params, 1)) < 0) {
 		playChannels = 2U;
 
 		if ((err = ::snd_pcm_hw_params_set_channels(playHandle, hw_params, 2)) < 0) {
@@ -322,7 +332,7 @@ bool CSoundCardReaderWriter::open()
 
 	unsigned int recChannels = 1U;
 
-	if ((err = ::snd_pcm_hw_params_set_channels(recHandle, hw_params, 1)) < 0) {
+	if (m_leftCallback != NULL || (err = ::snd_pcm_hw_params_set_channels(recHandle, hw_params, 1)) < 0) {
 		recChannels = 2U;
 
 		if ((err = ::snd_pcm_hw_params_set_channels (recHandle, hw_params, 2)) < 0) {
@@ -349,8 +359,8 @@ bool CSoundCardReaderWriter::open()
 
 	::printf("Opened %s %s Rate %u\n", writeDevice.c_str(), readDevice.c_str(), m_sampleRate);
 
-	m_reader = new CSoundCardReader(recHandle,  m_blockSize, recChannels,  m_callback);
-	m_writer = new CSoundCardWriter(playHandle, m_blockSize, playChannels, m_callback);
+	m_reader = new CSoundCardReader(recHandle,  m_blockSize, recChannels,  m_callback, m_leftCallback);
+	m_writer = new CSoundCardWriter(playHandle, m_blockSize, playChannels, m_callback, m_leftCallback);
 
 	m_reader->run();
 	m_writer->run();
@@ -372,28 +382,33 @@ bool CSoundCardReaderWriter::isWriterBusy() const
 	return m_writer->isBusy();
 }
 
-CSoundCardReader::CSoundCardReader(snd_pcm_t* handle, unsigned int blockSize, unsigned int channels, IAudioCallback* callback) :
+CSoundCardReader::CSoundCardReader(snd_pcm_t* handle, unsigned int blockSize, unsigned int channels, IAudioCallback* callback, IAudioCallback* leftCallback) :
 CThread(),
 m_handle(handle),
 m_blockSize(blockSize),
 m_channels(channels),
 m_callback(callback),
+m_leftCallback(leftCallback),
 m_killed(false),
 m_buffer(NULL),
+m_leftBuffer(NULL),
 m_samples(NULL)
 {
 	assert(handle != NULL);
 	assert(blockSize > 0U);
 	assert(channels == 1U || channels == 2U);
 	assert(callback != NULL);
+	assert(leftCallback == NULL || channels == 2U);
 
-	m_buffer  = new float[blockSize];
-	m_samples = new short[2U * blockSize];
+	m_buffer     = new float[blockSize];
+	m_leftBuffer = new float[blockSize];
+	m_samples    = new short[2U * blockSize];
 }
 
 CSoundCardReader::~CSoundCardReader()
 {
 	delete[] m_buffer;
+	delete[] m_leftBuffer;
 	delete[] m_samples;
 }
 
@@ -402,8 +417,13 @@ void CSoundCardReader::entry()
 	while (!m_killed) {
 		snd_pcm_sframes_t ret;
 		while ((ret = ::snd_pcm_readi(m_handle, m_samples, m_blockSize)) < 0) {
-			if (ret != -EPIPE)
+			if (ret != -EPIPE) {
 				::fprintf(stderr, "snd_pcm_readi returned %ld (%s)\n", ret, ::snd_strerror(ret));
+			} else {
+				if (m_leftCallback != NULL)
+					m_leftCallback->xrunCallback(true);
+				m_callback->xrunCallback(true);
+			}
 
 			::snd_pcm_recover(m_handle, ret, 1);
 		}
@@ -411,10 +431,18 @@ void CSoundCardReader::entry()
 		if (m_channels == 1U) {
 			for (int n = 0; n < ret; n++)
 				m_buffer[n] = float(m_samples[n]) / 32768.0F;
-		} else {
+		} else if (m_leftCallback == NULL) {
 			int i = 0;
 			for (int n = 0; n < (ret * 2); n += 2)
 				m_buffer[i++] = float(m_samples[n + 1]) / 32768.0F;
+		} else {
+			int i = 0;
+			for (int n = 0; n < (ret * 2); n += 2) {
+				m_leftBuffer[i] = float(m_samples[n]) / 32768.0F;
+				m_buffer[i++]   = float(m_samples[n + 1]) / 32768.0F;
+			}
+
+			m_leftCallback->readCallback(m_leftBuffer, (unsigned int)ret);
 		}
 
 		m_callback->readCallback(m_buffer, (unsigned int)ret);
@@ -428,28 +456,33 @@ void CSoundCardReader::kill()
 	m_killed = true;
 }
 
-CSoundCardWriter::CSoundCardWriter(snd_pcm_t* handle, unsigned int blockSize, unsigned int channels, IAudioCallback* callback) :
+CSoundCardWriter::CSoundCardWriter(snd_pcm_t* handle, unsigned int blockSize, unsigned int channels, IAudioCallback* callback, IAudioCallback* leftCallback) :
 CThread(),
 m_handle(handle),
 m_blockSize(blockSize),
 m_channels(channels),
 m_callback(callback),
+m_leftCallback(leftCallback),
 m_killed(false),
 m_buffer(NULL),
+m_leftBuffer(NULL),
 m_samples(NULL)
 {
 	assert(handle != NULL);
 	assert(blockSize > 0U);
 	assert(channels == 1U || channels == 2U);
 	assert(callback != NULL);
+	assert(leftCallback == NULL || channels == 2U);
 
-	m_buffer  = new float[2U * blockSize];
-	m_samples = new short[4U * blockSize];
+	m_buffer     = new float[2U * blockSize];
+	m_leftBuffer = new float[2U * blockSize];
+	m_samples    = new short[4U * blockSize];
 }
 
 CSoundCardWriter::~CSoundCardWriter()
 {
 	delete[] m_buffer;
+	delete[] m_leftBuffer;
 	delete[] m_samples;
 }
 
@@ -459,27 +492,52 @@ void CSoundCardWriter::entry()
 		int nSamples = 2U * m_blockSize;
 		m_callback->writeCallback(m_buffer, nSamples);
 
+		// Both channels are written together, the shorter one is padded with silence
+		if (m_leftCallback != NULL) {
+			int nLeft = 2U * m_blockSize;
+			m_leftCallback->writeCallback(m_leftBuffer, nLeft);
+
+			for (int n = nSamples; n < nLeft; n++)
+				m_buffer[n] = 0.0F;
+			for (int n = nLeft; n < nSamples; n++)
+				m_leftBuffer[n] = 0.0F;
+
+			if (nLeft > nSamples)
+				nSamples = nLeft;
+		}
+
 		if (nSamples == 0U) {
 			sleep(5UL);
 		} else {
 			if (m_channels == 1U) {
 				for (int n = 0U; n < nSamples; n++)
 					m_samples[n] = short(m_buffer[n] * 32767.0F);
-			} else {
+			} else if (m_leftCallback == NULL) {
 				int i = 0U;
 				for (int n = 0U; n < nSamples; n++) {
 					short sample = short(m_buffer[n] * 32767.0F);
 					m_samples[i++] = sample;
 					m_samples[i++] = sample;			// Same value to both channels
 				}
+			} else {
+				int i = 0U;
+				for (int n = 0U; n < nSamples; n++) {
+					m_samples[i++] = short(m_leftBuffer[n] * 32767.0F);
+					m_samples[i++] = short(m_buffer[n] * 32767.0F);
+				}
 			}
 
 			int offset = 0U;
 			snd_pcm_sframes_t ret;
-			while ((ret = ::snd_pcm_writei(m_handle, m_samples + offset, nSamples - offset)) != (nSamples - offset)) {
+			while ((ret = ::snd_pcm_writei(m_handle, m_samples + offset * m_channels, nSamples - offset)) != (nSamples - offset)) {
 				if (ret < 0) {
-					if (ret != -EPIPE)
+					if (ret != -EPIPE) {
 						::fprintf(stderr, "snd_pcm_writei returned %ld (%s)\n", ret, ::snd_strerror(ret));
+					} else {
+						if (m_leftCallback != NULL)
+							m_leftCallback->xrunCallback(false);
+						m_callback->xrunCallback(false);
+					}
 
 					::snd_pcm_recover(m_handle, ret, 1);
 				} else {
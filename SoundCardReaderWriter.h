@@ -52,7 +52,7 @@ private:
 
 class CSoundCardReader : public CThread {
 public:
-	CSoundCardReader(snd_pcm_t* handle, unsigned int blockSize, unsigned int channels, IAudioCallback* callback);
+	CSoundCardReader(snd_pcm_t* handle, unsigned int blockSize, unsigned int channels, IAudioCallback* callback, IAudioCallback* leftCallback);
 	virtual ~CSoundCardReader();
 
 	virtual void entry();
@@ -64,14 +64,16 @@ private:
 	unsigned int    m_blockSize;
 	unsigned int    m_channels;
 	IAudioCallback* m_callback;
+	IAudioCallback* m_leftCallback;
 	bool            m_killed;
 	float*          m_buffer;
+	float*          m_leftBuffer;
 	short*          m_samples;
 };
 
 class CSoundCardWriter : public CThread {
 public:
-	CSoundCardWriter(snd_pcm_t* handle, unsigned int blockSize, unsigned int channels, IAudioCallback* callback);
+	CSoundCardWriter(snd_pcm_t* handle, unsigned int blockSize, unsigned int channels, IAudioCallback* callback, IAudioCallback* leftCallback);
 	virtual ~CSoundCardWriter();
 
 	virtual void entry();
@@ -85,8 +87,10 @@ private:
 	unsigned int    m_blockSize;
 	unsigned int    m_channels;
 	IAudioCallback* m_callback;
+	IAudioCallback* m_leftCallback;
 	bool            m_killed;
 	float*          m_buffer;
+	float*          m_leftBuffer;
 	short*          m_samples;
 };
 
@@ -96,6 +100,8 @@ public:
 	~CSoundCardReaderWriter();
 
 	void setCallback(IAudioCallback* callback);
+	// One callback per channel of a stereo device
+	void setCallback(IAudioCallback* leftCallback, IAudioCallback* rightCallback);
 	bool open();
 	void close();
 
@@ -107,6 +113,7 @@ private:
 	unsigned int         m_sampleRate;
 	unsigned int         m_blockSize;
 	IAudioCallback*      m_callback;
+	IAudioCallback*      m_leftCallback;
 	CSoundCardReader*    m_reader;
 	CSoundCardWriter*    m_writer;
 };
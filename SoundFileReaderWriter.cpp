@@ -0,0 +1,207 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "SoundFileReaderWriter.h"
+#include "Globals.h"
+
+#include <cassert>
+#include <ctime>
+
+static uint64_t getMicroseconds()
+{
+  struct timespec ts;
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return uint64_t(ts.tv_sec) * 1000000U + ts.tv_nsec / 1000U;
+}
+
+CSoundFileReaderWriter::CSoundFileReaderWriter(const std::string& readFile, const std::string& writeFile, unsigned int sampleRate, unsigned int blockSize) :
+CThread(),
+m_reader(readFile),
+m_writeFile(writeFile),
+m_writer(NULL),
+m_sampleRate(sampleRate),
+m_blockSize(blockSize),
+m_callback(NULL),
+m_leftCallback(NULL),
+m_modems(),
+m_modemCount(0U),
+m_killed(false),
+m_samples(NULL),
+m_buffer(NULL),
+m_leftBuffer(NULL)
+{
+  assert(sampleRate > 0U);
+  assert(blockSize > 0U);
+
+  m_samples    = new float[2U * blockSize];
+  m_buffer     = new float[2U * blockSize];
+  m_leftBuffer = new float[2U * blockSize];
+}
+
+CSoundFileReaderWriter::~CSoundFileReaderWriter()
+{
+  delete[] m_samples;
+  delete[] m_buffer;
+  delete[] m_leftBuffer;
+
+  delete m_writer;
+}
+
+void CSoundFileReaderWriter::setCallback(IAudioCallback* callback)
+{
+  assert(callback != NULL);
+
+  m_callback = callback;
+}
+
+void CSoundFileReaderWriter::setCallback(IAudioCallback* leftCallback, IAudioCallback* rightCallback)
+{
+  assert(leftCallback != NULL);
+  assert(rightCallback != NULL);
+
+  m_leftCallback = leftCallback;
+  m_callback     = rightCallback;
+}
+
+void CSoundFileReaderWriter::setFreeRun(CModem* modem)
+{
+  assert(modem != NULL);
+  assert(m_modemCount < 2U);
+
+  m_modems[m_modemCount++] = modem;
+}
+
+bool CSoundFileReaderWriter::open()
+{
+  assert(m_callback != NULL);
+
+  if (!m_reader.open())
+    return false;
+
+  // Raw files have no rate of their own
+  if (m_reader.getSampleRate() != 0U && m_reader.getSampleRate() != m_sampleRate) {
+    ::fprintf(stderr, "The sound file is at %u Hz, %u Hz is needed\n", m_reader.getSampleRate(), m_sampleRate);
+    return false;
+  }
+
+  if (!m_writeFile.empty()) {
+    m_writer = new CWAVFileWriter(m_writeFile, m_sampleRate, m_leftCallback != NULL ? 2U : 1U);
+    if (!m_writer->open())
+      return false;
+  }
+
+  ::printf("Opened the sound file, %u channel(s) at %u Hz\n", m_reader.getChannels(), m_sampleRate);
+
+  return run();
+}
+
+void CSoundFileReaderWriter::close()
+{
+  m_killed = true;
+
+  wait();
+
+  m_reader.close();
+}
+
+void CSoundFileReaderWriter::entry()
+{
+  unsigned int channels = m_reader.getChannels();
+  bool freeRun = m_modemCount > 0U;
+
+  if (freeRun) {
+    ::fprintf(stderr, "Waiting for the host to configure the modem\n");
+
+    for (unsigned int i = 0U; i < m_modemCount && !m_killed; ) {
+      if (m_modems[i]->io.isStarted()) {
+        i++;
+      } else {
+        for (unsigned int j = 0U; j < m_modemCount; j++)
+          m_modems[j]->process();
+
+        CThread::sleep(5U);
+      }
+    }
+  }
+
+  uint64_t start = getMicroseconds();
+  uint64_t count = 0U;
+
+  while (!m_killed) {
+    unsigned int n = m_reader.read(m_samples, m_blockSize);
+    if (n == 0U && freeRun)
+      break;
+
+    // Silence follows the end of the file
+    for (unsigned int i = n * channels; i < (m_blockSize * channels); i++)
+      m_samples[i] = 0.0F;
+
+    // As with a sound card, a single callback gets the right channel
+    for (unsigned int i = 0U; i < m_blockSize; i++) {
+      m_buffer[i]     = m_samples[i * channels + channels - 1U];
+      m_leftBuffer[i] = m_samples[i * channels];
+    }
+
+    if (m_leftCallback != NULL)
+      m_leftCallback->readCallback(m_leftBuffer, m_blockSize);
+    m_callback->readCallback(m_buffer, m_blockSize);
+
+    // Each block is exactly one pass of the modem's receive processing
+    for (unsigned int i = 0U; i < m_modemCount; i++)
+      m_modems[i]->process();
+
+    int nSamples = m_blockSize;
+    if (m_leftCallback != NULL)
+      m_leftCallback->writeCallback(m_leftBuffer, nSamples);
+    nSamples = m_blockSize;
+    m_callback->writeCallback(m_buffer, nSamples);
+
+    if (m_writer != NULL) {
+      if (m_leftCallback != NULL) {
+        for (unsigned int i = 0U; i < m_blockSize; i++) {
+          m_samples[i * 2U + 0U] = m_leftBuffer[i];
+          m_samples[i * 2U + 1U] = m_buffer[i];
+        }
+
+        m_writer->write(m_samples, m_blockSize);
+      } else {
+        m_writer->write(m_buffer, m_blockSize);
+      }
+    }
+
+    count += m_blockSize;
+
+    // Keep to the sample rate
+    while (!freeRun && !m_killed && (getMicroseconds() - start) < ((count * 1000000U) / m_sampleRate))
+      CThread::sleep(1U);
+  }
+
+  if (freeRun) {
+    uint64_t elapsed = getMicroseconds() - start;
+    if (elapsed == 0U)
+      elapsed = 1U;
+
+    double seconds = double(count) / double(m_sampleRate);
+
+    ::fprintf(stderr, "Replayed %.1f s of audio in %.1f s, %.1fx real time, %.0f samples/s\n", seconds, double(elapsed) / 1000000.0, (seconds * 1000000.0) / double(elapsed), (double(count) * 1000000.0) / double(elapsed));
+  }
+
+  if (m_writer != NULL)
+    m_writer->close();
+}
@@ -0,0 +1,68 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(SOUNDFILEREADERWRITER_H)
+#define  SOUNDFILEREADERWRITER_H
+
+#include "AudioCallback.h"
+#include "WAVFileReader.h"
+#include "WAVFileWriter.h"
+#include "Thread.h"
+
+#include <string>
+
+class CModem;
+
+// Plays a sound file into the callbacks, in place of a sound card, and
+// optionally records what they transmit to a WAV file
+class CSoundFileReaderWriter : public CThread {
+public:
+  CSoundFileReaderWriter(const std::string& readFile, const std::string& writeFile, unsigned int sampleRate, unsigned int blockSize);
+  virtual ~CSoundFileReaderWriter();
+
+  void setCallback(IAudioCallback* callback);
+  // One callback per channel, a mono file goes to both
+  void setCallback(IAudioCallback* leftCallback, IAudioCallback* rightCallback);
+
+  // Rather than in real time, the file is played as fast as the modem
+  // processes it and the thread ends with the file. The modem's own
+  // thread must not be run.
+  void setFreeRun(CModem* modem);
+
+  bool open();
+  void close();
+
+  virtual void entry();
+
+private:
+  CWAVFileReader  m_reader;
+  std::string     m_writeFile;
+  CWAVFileWriter* m_writer;
+  unsigned int    m_sampleRate;
+  unsigned int    m_blockSize;
+  IAudioCallback* m_callback;
+  IAudioCallback* m_leftCallback;
+  CModem*         m_modems[2U];
+  unsigned int    m_modemCount;
+  bool            m_killed;
+  float*          m_samples;
+  float*          m_buffer;
+  float*          m_leftBuffer;
+};
+
+#endif
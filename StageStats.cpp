@@ -0,0 +1,182 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "StageStats.h"
+#include "StageTrace.h"
+
+#include <cstdio>
+#include <ctime>
+
+const uint64_t REPORT_INTERVAL = 1000000000U;
+
+// In the order of STATS_STAGE
+static const char* STAGE_NAMES[STAGE_COUNT] = {
+  "loop", "host", "rx_block", "decimator", "dc_filter", "gate",
+  "fir_gaussian", "fir_boxcar", "fir_nxdn", "fir_rrc",
+  "rx_dstar", "rx_dmr", "rx_ysf", "rx_p25", "rx_nxdn", "rx_cal",
+  "tx_dstar", "tx_dmr", "tx_ysf", "tx_p25", "tx_nxdn", "tx_pocsag", "tx_other",
+  "serial_write", "audio_read", "audio_write"
+};
+
+// In the order of RX_MODE
+static const char* RX_MODE_NAMES[RX_MODE_COUNT] = {
+  "dstar", "dmr", "ysf", "p25", "nxdn"
+};
+
+CStageStats::CStageStats() :
+m_time(),
+m_calls(),
+m_lastTime(),
+m_lastCalls(),
+m_used(),
+m_rate(),
+m_reportTime(now()),
+m_latency(),
+m_trace(NULL),
+m_modem(0U)
+{
+  for (unsigned int i = 0U; i < STAGE_COUNT; i++) {
+    m_time[i].store(0U, std::memory_order_relaxed);
+    m_calls[i].store(0U, std::memory_order_relaxed);
+  }
+}
+
+void CStageStats::setTrace(CStageTrace* trace, unsigned int modem)
+{
+  m_trace = trace;
+  m_modem = modem;
+}
+
+uint64_t CStageStats::now()
+{
+  struct timespec ts;
+#if defined(CLOCK_MONOTONIC_RAW)
+  ::clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+#else
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+
+  return uint64_t(ts.tv_sec) * 1000000000U + ts.tv_nsec;
+}
+
+void CStageStats::add(STATS_STAGE stage, uint64_t start, unsigned int weight)
+{
+  uint64_t end = now();
+
+  m_time[stage].fetch_add((end - start) * weight, std::memory_order_relaxed);
+  m_calls[stage].fetch_add(weight, std::memory_order_relaxed);
+
+  if (m_trace != NULL)
+    m_trace->add(m_modem, stage, start, end);
+}
+
+bool CStageStats::update()
+{
+  uint64_t time = now();
+  uint64_t elapsed = time - m_reportTime;
+  if (elapsed < REPORT_INTERVAL)
+    return false;
+
+  for (unsigned int i = 0U; i < STAGE_COUNT; i++) {
+    uint64_t total = m_time[i].load(std::memory_order_relaxed);
+    uint64_t calls = m_calls[i].load(std::memory_order_relaxed);
+
+    m_used[i] = ((total - m_lastTime[i]) * REPORT_INTERVAL) / elapsed;
+    m_rate[i] = uint32_t(((calls - m_lastCalls[i]) * REPORT_INTERVAL) / elapsed);
+
+    m_lastTime[i]  = total;
+    m_lastCalls[i] = calls;
+  }
+
+  m_reportTime = time;
+
+  return true;
+}
+
+uint16_t CStageStats::getBudget(STATS_STAGE stage) const
+{
+  uint64_t budget = (m_used[stage] * 10000U) / REPORT_INTERVAL;
+
+  return budget > 0xFFFFU ? 0xFFFFU : uint16_t(budget);
+}
+
+uint32_t CStageStats::getCalls(STATS_STAGE stage) const
+{
+  return m_rate[stage];
+}
+
+uint64_t CStageStats::getTotalTime(STATS_STAGE stage) const
+{
+  return m_time[stage].load(std::memory_order_relaxed);
+}
+
+uint64_t CStageStats::getTotalCalls(STATS_STAGE stage) const
+{
+  return m_calls[stage].load(std::memory_order_relaxed);
+}
+
+const char* CStageStats::getName(STATS_STAGE stage)
+{
+  return STAGE_NAMES[stage];
+}
+
+void CStageStats::addLatency(RX_MODE mode, uint64_t captured)
+{
+  uint64_t time = now();
+
+  // The capture time is an estimate, it may be a little in the future
+  m_latency[mode].add(time > captured ? time - captured : 0U);
+}
+
+const CLatencyHistogram& CStageStats::getLatency(RX_MODE mode) const
+{
+  return m_latency[mode];
+}
+
+const char* CStageStats::getName(RX_MODE mode)
+{
+  return RX_MODE_NAMES[mode];
+}
+
+// Written to a temporary file and renamed, so that a reader never sees half of it
+bool CStageStats::writeFile(const std::string& fileName) const
+{
+  std::string tempName = fileName + ".tmp";
+
+  FILE* fp = ::fopen(tempName.c_str(), "wt");
+  if (fp == NULL)
+    return false;
+
+  ::fprintf(fp, "# stage budget_percent calls_per_second ns_per_call\n");
+
+  for (unsigned int i = 0U; i < STAGE_COUNT; i++) {
+    uint16_t budget = getBudget(STATS_STAGE(i));
+    uint64_t ns     = m_rate[i] == 0U ? 0U : m_used[i] / m_rate[i];
+
+    ::fprintf(fp, "%s %u.%02u %u %u\n", STAGE_NAMES[i], budget / 100U, budget % 100U, m_rate[i], (unsigned int)ns);
+  }
+
+  ::fprintf(fp, "# latency p50_us p99_us max_us frames\n");
+
+  for (unsigned int i = 0U; i < RX_MODE_COUNT; i++)
+    ::fprintf(fp, "latency_%s %u %u %u %llu\n", RX_MODE_NAMES[i], m_latency[i].getPercentile(50U), m_latency[i].getPercentile(99U), m_latency[i].getMax(), (unsigned long long)m_latency[i].getCount());
+
+  ::fclose(fp);
+
+  return ::rename(tempName.c_str(), fileName.c_str()) == 0;
+}
@@ -0,0 +1,135 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(STAGESTATS_H)
+#define  STAGESTATS_H
+
+#include "LatencyHistogram.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+class CStageTrace;
+
+// The parts of the modem that are timed, the receivers include the frames they write
+enum STATS_STAGE {
+  STAGE_LOOP,           // One pass of the main loop
+  STAGE_HOST,           // Reading and acting on host commands
+  STAGE_RX_BLOCK,       // A receive block through CIO, everything below
+  STAGE_DECIMATOR,
+  STAGE_DC_FILTER,
+  STAGE_GATE,
+  STAGE_FIR_GAUSSIAN,
+  STAGE_FIR_BOXCAR,
+  STAGE_FIR_NXDN,
+  STAGE_FIR_RRC,
+  STAGE_RX_DSTAR,
+  STAGE_RX_DMR,
+  STAGE_RX_YSF,
+  STAGE_RX_P25,
+  STAGE_RX_NXDN,
+  STAGE_RX_CAL,
+  STAGE_TX_DSTAR,
+  STAGE_TX_DMR,
+  STAGE_TX_YSF,
+  STAGE_TX_P25,
+  STAGE_TX_NXDN,
+  STAGE_TX_POCSAG,
+  STAGE_TX_OTHER,       // Calibration and the CW ID
+  STAGE_SERIAL_WRITE,
+  STAGE_AUDIO_READ,     // A block from the sound card or file into the receive ring
+  STAGE_AUDIO_WRITE,    // A block from the transmit ring to the sound card or file
+  STAGE_COUNT
+};
+
+// The receivers, for the latency from the capture of a frame's last sample to its write to the host
+// and for the metrics
+enum RX_MODE {
+  RX_MODE_DSTAR,
+  RX_MODE_DMR,
+  RX_MODE_YSF,
+  RX_MODE_P25,
+  RX_MODE_NXDN,
+  RX_MODE_COUNT
+};
+
+#if defined(STAGE_STATS)
+// Reading the clock costs more than most of the per block stages, so they are only
+// timed one block in this many and each timing counts for all of them
+const unsigned int STATS_SAMPLE_BLOCKS = 16U;
+
+#define  STATS_START(t)                 const uint64_t t = CStageStats::now()
+#define  STATS_STOP(s, t, stage)        (s).add((stage), t)
+#define  STATS_SAMPLE_START(t, sampled) const uint64_t t = (sampled) ? CStageStats::now() : 0U
+#define  STATS_SAMPLE_STOP(s, t, stage) ((t) != 0U ? (s).add((stage), t, STATS_SAMPLE_BLOCKS) : (void)0)
+#else
+#define  STATS_START(t)
+#define  STATS_STOP(s, t, stage)
+#define  STATS_SAMPLE_START(t, sampled)
+#define  STATS_SAMPLE_STOP(s, t, stage)
+#endif
+
+// Time and calls per stage. Any thread may add to a stage, the main loop turns
+// the totals into the share of one CPU each stage used over the last second.
+class CStageStats {
+public:
+  CStageStats();
+
+  // Also record every timed call in a trace, as the given modem
+  void setTrace(CStageTrace* trace, unsigned int modem);
+
+  static uint64_t now();
+
+  // A sampled call stands for weight calls, the trace only has the sampled ones
+  void add(STATS_STAGE stage, uint64_t start, unsigned int weight = 1U);
+
+  // Returns true once a second, when there are new figures
+  bool update();
+
+  // In hundredths of a percent of one CPU
+  uint16_t getBudget(STATS_STAGE stage) const;
+  uint32_t getCalls(STATS_STAGE stage) const;
+
+  // Since the start, in ns
+  uint64_t getTotalTime(STATS_STAGE stage) const;
+  uint64_t getTotalCalls(STATS_STAGE stage) const;
+
+  static const char* getName(STATS_STAGE stage);
+
+  void addLatency(RX_MODE mode, uint64_t captured);
+  const CLatencyHistogram& getLatency(RX_MODE mode) const;
+
+  static const char* getName(RX_MODE mode);
+
+  bool writeFile(const std::string& fileName) const;
+
+private:
+  std::atomic<uint64_t> m_time[STAGE_COUNT];
+  std::atomic<uint64_t> m_calls[STAGE_COUNT];
+  uint64_t              m_lastTime[STAGE_COUNT];
+  uint64_t              m_lastCalls[STAGE_COUNT];
+  uint64_t              m_used[STAGE_COUNT];     // ns per second
+  uint32_t              m_rate[STAGE_COUNT];     // Calls per second
+  uint64_t              m_reportTime;
+  CLatencyHistogram     m_latency[RX_MODE_COUNT];
+  CStageTrace*          m_trace;
+  unsigned int          m_modem;
+};
+
+#endif
@@ -0,0 +1,125 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "StageTrace.h"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdio>
+
+// How the duration, thread id, stage and modem are packed into an event
+const unsigned int INFO_THREAD_SHIFT = 32U;
+const unsigned int INFO_STAGE_SHIFT  = 54U;
+const unsigned int INFO_MODEM_SHIFT  = 60U;
+
+const uint64_t INFO_DURATION_MASK = 0xFFFFFFFFU;
+const uint64_t INFO_THREAD_MASK   = 0x3FFFFFU;
+const uint64_t INFO_STAGE_MASK    = 0x3FU;
+const uint64_t INFO_MODEM_MASK    = 0x0FU;
+
+static_assert(STAGE_COUNT <= INFO_STAGE_MASK, "Too many stages for a trace event");
+
+static thread_local uint64_t t_thread = 0U;
+
+CStageTrace::CStageTrace(unsigned int length) :
+m_events(NULL),
+m_mask(length - 1U),
+m_head()
+{
+  assert(length > 0U && (length & (length - 1U)) == 0U);
+
+  m_events = new Event[length];
+  for (unsigned int i = 0U; i < length; i++)
+    m_events[i].seq.store(0U, std::memory_order_relaxed);
+
+  m_head.store(0U, std::memory_order_relaxed);
+}
+
+CStageTrace::~CStageTrace()
+{
+  delete[] m_events;
+}
+
+void CStageTrace::add(unsigned int modem, STATS_STAGE stage, uint64_t start, uint64_t end)
+{
+  if (t_thread == 0U)
+    t_thread = uint64_t(::syscall(SYS_gettid)) & INFO_THREAD_MASK;
+
+  uint64_t duration = end - start;
+  if (duration > INFO_DURATION_MASK)
+    duration = INFO_DURATION_MASK;
+
+  uint64_t info = duration | (t_thread << INFO_THREAD_SHIFT) | (uint64_t(stage) << INFO_STAGE_SHIFT) | ((uint64_t(modem) & INFO_MODEM_MASK) << INFO_MODEM_SHIFT);
+
+  uint64_t pos = m_head.fetch_add(1U, std::memory_order_relaxed);
+  Event& event = m_events[pos & m_mask];
+
+  event.seq.store(0U, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  event.start.store(start, std::memory_order_relaxed);
+  event.info.store(info, std::memory_order_relaxed);
+  event.seq.store(pos + 1U, std::memory_order_release);
+}
+
+// Events that are being overwritten as they are read are left out
+bool CStageTrace::writeFile(const std::string& fileName) const
+{
+  std::string tempName = fileName + ".tmp";
+
+  FILE* fp = ::fopen(tempName.c_str(), "wt");
+  if (fp == NULL)
+    return false;
+
+  ::fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+  uint64_t head  = m_head.load(std::memory_order_acquire);
+  uint64_t first = head > m_mask ? head - m_mask - 1U : 0U;
+
+  bool comma = false;
+  for (uint64_t pos = first; pos < head; pos++) {
+    const Event& event = m_events[pos & m_mask];
+
+    uint64_t seq   = event.seq.load(std::memory_order_acquire);
+    uint64_t start = event.start.load(std::memory_order_relaxed);
+    uint64_t info  = event.info.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq != pos + 1U || event.seq.load(std::memory_order_relaxed) != seq)
+      continue;
+
+    uint64_t duration = info & INFO_DURATION_MASK;
+    unsigned int thread = (unsigned int)((info >> INFO_THREAD_SHIFT) & INFO_THREAD_MASK);
+    unsigned int stage  = (unsigned int)((info >> INFO_STAGE_SHIFT) & INFO_STAGE_MASK);
+    unsigned int modem  = (unsigned int)((info >> INFO_MODEM_SHIFT) & INFO_MODEM_MASK);
+
+    // Chrome traces are in microseconds
+    ::fprintf(fp, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%llu.%03u,\"dur\":%llu.%03u}", comma ? "," : "",
+      CStageStats::getName(STATS_STAGE(stage)), modem, thread,
+      (unsigned long long)(start / 1000U), (unsigned int)(start % 1000U),
+      (unsigned long long)(duration / 1000U), (unsigned int)(duration % 1000U));
+
+    comma = true;
+  }
+
+  ::fprintf(fp, "\n]}\n");
+
+  ::fclose(fp);
+
+  return ::rename(tempName.c_str(), fileName.c_str()) == 0;
+}
@@ -0,0 +1,54 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(STAGETRACE_H)
+#define  STAGETRACE_H
+
+#include "StageStats.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// A fixed size ring of the most recent timed calls, for a Chrome trace or Perfetto
+// timeline. Any thread may add to it without a lock, the oldest calls are overwritten.
+class CStageTrace {
+public:
+  // The length must be a power of two
+  CStageTrace(unsigned int length);
+  ~CStageTrace();
+
+  void add(unsigned int modem, STATS_STAGE stage, uint64_t start, uint64_t end);
+
+  // Safe to call while calls are still being added
+  bool writeFile(const std::string& fileName) const;
+
+private:
+  // The sequence is the position plus one once the event is complete, zero while it is written
+  struct Event {
+    std::atomic<uint64_t> seq;
+    std::atomic<uint64_t> start;
+    std::atomic<uint64_t> info;     // Duration, thread, stage and modem
+  };
+
+  Event*                m_events;
+  uint64_t              m_mask;
+  std::atomic<uint64_t> m_head;
+};
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "SymbolTiming.h"
+
+// Move the centre once it is a tenth of a symbol out, the noise on the error over a few
+// hundred symbols is a third to a half of that
+const float LIMIT_SYMBOLS = 0.1F;
+
+// Symbols per decision
+const uint16_t TIMING_SYMBOLS = 50U;
+
+// Share of the error carried into the next decision when the centre stays put
+const float TIMING_MEMORY = 0.75F;
+
+CSymbolTiming::CSymbolTiming(uint16_t symbolLength, float gain) :
+m_limit(LIMIT_SYMBOLS * gain / float(symbolLength)),
+m_error(0.0F),
+m_energy(0.0F),
+m_count(0U)
+{
+}
+
+void CSymbolTiming::reset()
+{
+  m_error  = 0.0F;
+  m_energy = 0.0F;
+  m_count  = 0U;
+}
+
+void CSymbolTiming::sample(float early, float onTime, float late)
+{
+  // Positive when the pulse peaks after the current centre
+  m_error  += (late - early) * onTime;
+  m_energy += onTime * onTime;
+
+  m_count++;
+}
+
+int8_t CSymbolTiming::getAdjustment()
+{
+  if (m_count < TIMING_SYMBOLS)
+    return 0;
+
+  int8_t adjustment = 0;
+
+  if (m_energy > 0.0F) {
+    float error = m_error / m_energy;
+
+    if (error > m_limit)
+      adjustment = 1;
+    else if (error < -m_limit)
+      adjustment = -1;
+  }
+
+  if (adjustment != 0) {
+    reset();
+  } else {
+    m_error  *= TIMING_MEMORY;
+    m_energy *= TIMING_MEMORY;
+    m_count   = 0U;
+  }
+
+  return adjustment;
+}
@@ -0,0 +1,48 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(SYMBOLTIMING_H)
+#define  SYMBOLTIMING_H
+
+#include <cstdint>
+
+// Samples either side of the symbol centre still processed once locked, at 24 kHz that is all
+// of them as the sync and the symbols are read between samples
+const uint16_t SYMBOL_TIMING_WINDOW = 2U;
+
+// Early-late gate timing error detector, one decision per TIMING_SYMBOLS symbols
+class CSymbolTiming {
+public:
+  // The gain is the error for one sample of timing offset times the samples per symbol squared
+  CSymbolTiming(uint16_t symbolLength, float gain);
+
+  void reset();
+
+  void sample(float early, float onTime, float late);
+
+  // Returns -1, 0 or +1 samples to move the symbol centre by, always 0 between decisions
+  int8_t getAdjustment();
+
+private:
+  float    m_limit;
+  float    m_error;
+  float    m_energy;
+  uint16_t m_count;
+};
+
+#endif
@@ -0,0 +1,195 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "WAVFileReader.h"
+
+#include <cstring>
+
+const uint16_t WAVE_FORMAT_PCM        = 0x0001U;
+const uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003U;
+const uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFEU;
+
+static uint16_t getUInt16(const uint8_t* p)
+{
+  return p[0U] | (p[1U] << 8);
+}
+
+static uint32_t getUInt32(const uint8_t* p)
+{
+  return p[0U] | (p[1U] << 8) | (p[2U] << 16) | (uint32_t(p[3U]) << 24);
+}
+
+static bool hasExtension(const std::string& fileName, const char* extension)
+{
+  std::string::size_type length = ::strlen(extension);
+
+  return fileName.size() > length && fileName.compare(fileName.size() - length, length, extension) == 0;
+}
+
+CWAVFileReader::CWAVFileReader(const std::string& fileName) :
+m_fileName(fileName),
+m_fp(NULL),
+m_sampleRate(0U),
+m_channels(0U),
+m_float(false),
+m_remaining(0U),
+m_buffer(NULL),
+m_bufferLength(0U)
+{
+}
+
+CWAVFileReader::~CWAVFileReader()
+{
+  close();
+
+  delete[] m_buffer;
+}
+
+bool CWAVFileReader::open()
+{
+  m_fp = ::fopen(m_fileName.c_str(), "rb");
+  if (m_fp == NULL) {
+    ::fprintf(stderr, "Unable to open the sound file %s\n", m_fileName.c_str());
+    return false;
+  }
+
+  // Raw captures have no header, so are taken as mono at whatever rate is wanted
+  if (hasExtension(m_fileName, ".raw") || hasExtension(m_fileName, ".f32")) {
+    m_sampleRate = 0U;
+    m_channels   = 1U;
+    m_float      = hasExtension(m_fileName, ".f32");
+    m_remaining  = 0xFFFFFFFFU;
+    return true;
+  }
+
+  uint8_t header[12U];
+  if (::fread(header, 1U, 12U, m_fp) != 12U || ::memcmp(header, "RIFF", 4U) != 0 || ::memcmp(header + 8U, "WAVE", 4U) != 0) {
+    ::fprintf(stderr, "%s is not a WAV file\n", m_fileName.c_str());
+    close();
+    return false;
+  }
+
+  uint16_t format = 0U;
+  uint16_t bits   = 0U;
+
+  // Walk the chunks until the data, the format must come first
+  for (;;) {
+    uint8_t chunk[8U];
+    if (::fread(chunk, 1U, 8U, m_fp) != 8U) {
+      ::fprintf(stderr, "No data found in the WAV file %s\n", m_fileName.c_str());
+      close();
+      return false;
+    }
+
+    uint32_t length = getUInt32(chunk + 4U);
+
+    if (::memcmp(chunk, "fmt ", 4U) == 0) {
+      uint8_t fmt[40U];
+      uint32_t n = length < 40U ? length : 40U;
+      if (n < 16U || ::fread(fmt, 1U, n, m_fp) != n) {
+        ::fprintf(stderr, "Invalid format in the WAV file %s\n", m_fileName.c_str());
+        close();
+        return false;
+      }
+
+      format       = getUInt16(fmt + 0U);
+      m_channels   = getUInt16(fmt + 2U);
+      m_sampleRate = getUInt32(fmt + 4U);
+      bits         = getUInt16(fmt + 14U);
+
+      if (format == WAVE_FORMAT_EXTENSIBLE && n >= 26U)
+        format = getUInt16(fmt + 24U);
+
+      ::fseek(m_fp, (length - n) + (length & 1U), SEEK_CUR);
+    } else if (::memcmp(chunk, "data", 4U) == 0) {
+      m_remaining = length;
+      break;
+    } else {
+      ::fseek(m_fp, length + (length & 1U), SEEK_CUR);
+    }
+  }
+
+  if (format == WAVE_FORMAT_PCM && bits == 16U) {
+    m_float = false;
+  } else if (format == WAVE_FORMAT_IEEE_FLOAT && bits == 32U) {
+    m_float = true;
+  } else {
+    ::fprintf(stderr, "Only 16-bit PCM and 32-bit float WAV files are supported, %s is format %u with %u bits\n", m_fileName.c_str(), format, bits);
+    close();
+    return false;
+  }
+
+  if (m_channels != 1U && m_channels != 2U) {
+    ::fprintf(stderr, "Only mono and stereo WAV files are supported, %s has %u channels\n", m_fileName.c_str(), m_channels);
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+unsigned int CWAVFileReader::getSampleRate() const
+{
+  return m_sampleRate;
+}
+
+unsigned int CWAVFileReader::getChannels() const
+{
+  return m_channels;
+}
+
+unsigned int CWAVFileReader::read(float* samples, unsigned int frames)
+{
+  if (m_fp == NULL)
+    return 0U;
+
+  unsigned int frameSize = m_channels * (m_float ? 4U : 2U);
+
+  if (m_remaining < 0xFFFFFFFFU && (frames * frameSize) > m_remaining)
+    frames = m_remaining / frameSize;
+
+  unsigned int count = frames * m_channels;
+
+  if (m_float) {
+    frames = ::fread(samples, frameSize, frames, m_fp);
+  } else {
+    if (count > m_bufferLength) {
+      delete[] m_buffer;
+      m_buffer       = new int16_t[count];
+      m_bufferLength = count;
+    }
+
+    frames = ::fread(m_buffer, frameSize, frames, m_fp);
+
+    for (unsigned int i = 0U; i < (frames * m_channels); i++)
+      samples[i] = float(m_buffer[i]) / 32768.0F;
+  }
+
+  if (m_remaining < 0xFFFFFFFFU)
+    m_remaining -= frames * frameSize;
+
+  return frames;
+}
+
+void CWAVFileReader::close()
+{
+  if (m_fp != NULL) {
+    ::fclose(m_fp);
+    m_fp = NULL;
+  }
+}
@@ -0,0 +1,54 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(WAVFILEREADER_H)
+#define  WAVFILEREADER_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+
+// Reads 16-bit PCM or 32-bit float WAV files as float samples, or headerless
+// mono .raw (16-bit) and .f32 (float) files whose sample rate is reported as zero
+class CWAVFileReader {
+public:
+  CWAVFileReader(const std::string& fileName);
+  ~CWAVFileReader();
+
+  bool open();
+
+  unsigned int getSampleRate() const;
+  unsigned int getChannels() const;
+
+  // Returns the number of frames read into the interleaved samples, zero at the end
+  unsigned int read(float* samples, unsigned int frames);
+
+  void close();
+
+private:
+  std::string  m_fileName;
+  FILE*        m_fp;
+  unsigned int m_sampleRate;
+  unsigned int m_channels;
+  bool         m_float;
+  uint32_t     m_remaining;
+  int16_t*     m_buffer;
+  unsigned int m_bufferLength;
+};
+
+#endif
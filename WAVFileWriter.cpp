@@ -0,0 +1,141 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "WAVFileWriter.h"
+
+#include <cassert>
+#include <cstring>
+
+const unsigned int WAV_HEADER_LENGTH = 44U;
+
+static void setUInt16(uint8_t* p, uint16_t n)
+{
+  p[0U] = n >> 0;
+  p[1U] = n >> 8;
+}
+
+static void setUInt32(uint8_t* p, uint32_t n)
+{
+  p[0U] = n >> 0;
+  p[1U] = n >> 8;
+  p[2U] = n >> 16;
+  p[3U] = n >> 24;
+}
+
+CWAVFileWriter::CWAVFileWriter(const std::string& fileName, unsigned int sampleRate, unsigned int channels) :
+m_fileName(fileName),
+m_sampleRate(sampleRate),
+m_channels(channels),
+m_fp(NULL),
+m_length(0U),
+m_buffer(NULL),
+m_bufferLength(0U)
+{
+  assert(sampleRate > 0U);
+  assert(channels == 1U || channels == 2U);
+}
+
+CWAVFileWriter::~CWAVFileWriter()
+{
+  close();
+
+  delete[] m_buffer;
+}
+
+bool CWAVFileWriter::open()
+{
+  m_fp = ::fopen(m_fileName.c_str(), "wb");
+  if (m_fp == NULL) {
+    ::fprintf(stderr, "Unable to create the WAV file %s\n", m_fileName.c_str());
+    return false;
+  }
+
+  m_length = 0U;
+
+  writeHeader();
+
+  return true;
+}
+
+bool CWAVFileWriter::write(const float* samples, unsigned int frames)
+{
+  if (m_fp == NULL)
+    return false;
+
+  unsigned int count = frames * m_channels;
+
+  if (count > m_bufferLength) {
+    delete[] m_buffer;
+    m_buffer       = new int16_t[count];
+    m_bufferLength = count;
+  }
+
+  for (unsigned int i = 0U; i < count; i++) {
+    float sample = samples[i];
+    if (sample > 1.0F)
+      sample = 1.0F;
+    else if (sample < -1.0F)
+      sample = -1.0F;
+
+    m_buffer[i] = int16_t(sample * 32767.0F);
+  }
+
+  if (::fwrite(m_buffer, sizeof(int16_t), count, m_fp) != count) {
+    ::fprintf(stderr, "Unable to write to the WAV file %s\n", m_fileName.c_str());
+    return false;
+  }
+
+  m_length += count * sizeof(int16_t);
+
+  return true;
+}
+
+void CWAVFileWriter::close()
+{
+  if (m_fp == NULL)
+    return;
+
+  ::fseek(m_fp, 0L, SEEK_SET);
+  writeHeader();
+
+  ::fclose(m_fp);
+  m_fp = NULL;
+}
+
+void CWAVFileWriter::writeHeader()
+{
+  uint8_t header[WAV_HEADER_LENGTH];
+
+  ::memcpy(header + 0U, "RIFF", 4U);
+  setUInt32(header + 4U, m_length + WAV_HEADER_LENGTH - 8U);
+  ::memcpy(header + 8U, "WAVE", 4U);
+
+  ::memcpy(header + 12U, "fmt ", 4U);
+  setUInt32(header + 16U, 16U);
+  setUInt16(header + 20U, 1U);                                    // PCM
+  setUInt16(header + 22U, m_channels);
+  setUInt32(header + 24U, m_sampleRate);
+  setUInt32(header + 28U, m_sampleRate * m_channels * 2U);
+  setUInt16(header + 32U, m_channels * 2U);
+  setUInt16(header + 34U, 16U);
+
+  ::memcpy(header + 36U, "data", 4U);
+  setUInt32(header + 40U, m_length);
+
+  ::fwrite(header, 1U, WAV_HEADER_LENGTH, m_fp);
+}
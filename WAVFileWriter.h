@@ -0,0 +1,52 @@
+/*
+ *   Copyright (C) 2019 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(WAVFILEWRITER_H)
+#define  WAVFILEWRITER_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+
+// Writes float samples to a 16-bit PCM WAV file
+class CWAVFileWriter {
+public:
+  CWAVFileWriter(const std::string& fileName, unsigned int sampleRate, unsigned int channels);
+  ~CWAVFileWriter();
+
+  bool open();
+
+  // The samples are interleaved
+  bool write(const float* samples, unsigned int frames);
+
+  // Fills in the lengths in the header
+  void close();
+
+private:
+  std::string  m_fileName;
+  unsigned int m_sampleRate;
+  unsigned int m_channels;
+  FILE*        m_fp;
+  uint32_t     m_length;
+  int16_t*     m_buffer;
+  unsigned int m_bufferLength;
+
+  void writeHeader();
+};
+
+#endif
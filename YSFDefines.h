@@ -19,21 +19,24 @@
 #if !defined(YSFDEFINES_H)
 #define  YSFDEFINES_H
 
+#include "RXRate.h"
+
 const unsigned int YSF_RADIO_SYMBOL_LENGTH = 10U;      // At 48 kHz sample rate
+const unsigned int YSF_RX_SYMBOL_LENGTH    = YSF_RADIO_SYMBOL_LENGTH / RX_DECIMATION;
 
 const unsigned int YSF_FRAME_LENGTH_BYTES   = 120U;
 const unsigned int YSF_FRAME_LENGTH_BITS    = YSF_FRAME_LENGTH_BYTES * 8U;
 const unsigned int YSF_FRAME_LENGTH_SYMBOLS = YSF_FRAME_LENGTH_BYTES * 4U;
-const unsigned int YSF_FRAME_LENGTH_SAMPLES = YSF_FRAME_LENGTH_SYMBOLS * YSF_RADIO_SYMBOL_LENGTH;
+const unsigned int YSF_FRAME_LENGTH_SAMPLES = YSF_FRAME_LENGTH_SYMBOLS * YSF_RX_SYMBOL_LENGTH;
 
 const unsigned int YSF_SYNC_LENGTH_BYTES   = 5U;
 const unsigned int YSF_SYNC_LENGTH_BITS    = YSF_SYNC_LENGTH_BYTES * 8U;
 const unsigned int YSF_SYNC_LENGTH_SYMBOLS = YSF_SYNC_LENGTH_BYTES * 4U;
-const unsigned int YSF_SYNC_LENGTH_SAMPLES = YSF_SYNC_LENGTH_SYMBOLS * YSF_RADIO_SYMBOL_LENGTH;
+const unsigned int YSF_SYNC_LENGTH_SAMPLES = YSF_SYNC_LENGTH_SYMBOLS * YSF_RX_SYMBOL_LENGTH;
 
 const unsigned int YSF_FICH_LENGTH_BITS    = 200U;
 const unsigned int YSF_FICH_LENGTH_SYMBOLS = 100U;
-const unsigned int YSF_FICH_LENGTH_SAMPLES = YSF_FICH_LENGTH_SYMBOLS * YSF_RADIO_SYMBOL_LENGTH;
+const unsigned int YSF_FICH_LENGTH_SAMPLES = YSF_FICH_LENGTH_SYMBOLS * YSF_RX_SYMBOL_LENGTH;
 
 const uint8_t YSF_SYNC_BYTES[] = {0xD4U, 0x71U, 0xC9U, 0x63U, 0x4DU};
 const uint8_t YSF_SYNC_BYTES_LENGTH  = 5U;
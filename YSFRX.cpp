@@ -22,6 +22,9 @@
 
 const float SCALING_FACTOR = 0.5722F;
 
+// Measured with MMDVMBER at 30 dB with the centre held one and two samples out
+const float TIMING_GAIN = 1.6F;
+
 const uint8_t MAX_SYNC_BIT_START_ERRS = 2U;
 const uint8_t MAX_SYNC_BIT_RUN_ERRS   = 4U;
 
@@ -31,13 +34,12 @@ const uint8_t BIT_MASK_TABLE[] = {0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x02
 
 #define WRITE_BIT1(p,i,b) p[(i)>>3] = (b) ? (p[(i)>>3] | BIT_MASK_TABLE[(i)&7]) : (p[(i)>>3] & ~BIT_MASK_TABLE[(i)&7])
 
-const uint8_t NOAVEPTR = 99U;
-
 const uint16_t NOENDPTR = 9999U;
 
 const unsigned int MAX_SYNC_FRAMES = 4U + 1U;
 
-CYSFRX::CYSFRX() :
+CYSFRX::CYSFRX(CModem& modem) :
+m_modem(modem),
 m_state(YSFRXS_NONE),
 m_bitBuffer(),
 m_buffer(),
@@ -51,11 +53,16 @@ m_maxSyncPtr(NOENDPTR),
 m_maxCorr(0.0F),
 m_lostCount(0U),
 m_countdown(0U),
-m_centre(),
 m_centreVal(0.0F),
-m_threshold(),
 m_thresholdVal(0.0F),
-m_averagePtr(NOAVEPTR)
+m_levels(16U),
+m_timing(YSF_RX_SYMBOL_LENGTH, TIMING_GAIN),
+m_frame(),
+m_slicePtr(NOENDPTR),
+m_sliceCount(0U)
+#if defined(RX_24KHZ)
+,m_fraction(0.0F)
+#endif
 {
 }
 
@@ -65,7 +72,6 @@ void CYSFRX::reset()
   m_dataPtr      = 0U;
   m_bitPtr       = 0U;
   m_maxCorr      = 0.0F;
-  m_averagePtr   = NOAVEPTR;
   m_startPtr     = NOENDPTR;
   m_endPtr       = NOENDPTR;
   m_syncPtr      = NOENDPTR;
@@ -75,6 +81,14 @@ void CYSFRX::reset()
   m_thresholdVal = 0.0F;
   m_lostCount    = 0U;
   m_countdown    = 0U;
+  m_slicePtr     = NOENDPTR;
+  m_sliceCount   = 0U;
+#if defined(RX_24KHZ)
+  m_fraction     = 0.0F;
+#endif
+
+  m_levels.reset();
+  m_timing.reset();
 }
 
 void CYSFRX::samples(const float* samples, uint8_t length)
@@ -82,11 +96,26 @@ void CYSFRX::samples(const float* samples, uint8_t length)
   for (uint8_t i = 0U; i < length; i++) {
     float sample = samples[i];
 
+#if defined(SYMBOL_TIMING)
+    // Once locked only the samples around the symbol centre are needed
+    if (m_state == YSFRXS_DATA && !isNearSymbol(sample)) {
+      m_dataPtr++;
+      if (m_dataPtr >= YSF_FRAME_LENGTH_SAMPLES)
+        m_dataPtr = 0U;
+
+      m_bitPtr++;
+      if (m_bitPtr >= YSF_RX_SYMBOL_LENGTH)
+        m_bitPtr = 0U;
+
+      continue;
+    }
+#endif
+
     m_bitBuffer[m_bitPtr] <<= 1;
     if (sample < 0)
       m_bitBuffer[m_bitPtr] |= 0x01U;
 
-    m_buffer[m_dataPtr] = sample;
+    m_buffer[m_dataPtr] = toBuffer(sample);
 
     switch (m_state) {
     case YSFRXS_DATA:
@@ -102,7 +131,7 @@ void CYSFRX::samples(const float* samples, uint8_t length)
       m_dataPtr = 0U;
 
     m_bitPtr++;
-    if (m_bitPtr >= YSF_RADIO_SYMBOL_LENGTH)
+    if (m_bitPtr >= YSF_RX_SYMBOL_LENGTH)
       m_bitPtr = 0U;
   }
 }
@@ -113,10 +142,10 @@ void CYSFRX::processNone(float sample)
   if (ret) {
     // On the first sync, start the countdown to the state change
     if (m_countdown == 0U) {
-      io.setDecode(true);
-      io.setADCDetection(true);
+      m_modem.io.setDecode(true);
+      m_modem.io.setADCDetection(true);
 
-      m_averagePtr = NOAVEPTR;
+      m_levels.reset();
 
       m_countdown = 5U;
     }
@@ -136,6 +165,10 @@ void CYSFRX::processNone(float sample)
 
     m_state      = YSFRXS_DATA;
     m_countdown  = 0U;
+
+    startSlicing();
+
+    m_timing.reset();
   }
 }
 
@@ -149,7 +182,28 @@ void CYSFRX::processData(float sample)
       correlateSync();
   }
 
-  if (m_dataPtr == m_endPtr) {
+  // The symbols are sliced once the sample after them has arrived too
+  uint16_t ptr = m_dataPtr + YSF_FRAME_LENGTH_SAMPLES - RX_SLICE_DELAY;
+  if (ptr >= YSF_FRAME_LENGTH_SAMPLES)
+    ptr -= YSF_FRAME_LENGTH_SAMPLES;
+
+  // Once the sync window has closed the start of the frame is fixed
+  if (ptr == m_maxSyncPtr)
+    startSlicing();
+  else if (m_sliceCount < YSF_FRAME_LENGTH_SYMBOLS && ptr == m_slicePtr) {
+    sliceSymbols(1U);
+
+#if defined(SYMBOL_TIMING)
+    // Clear of the sync window and the end of the frame, the timing loop moves the symbol centre
+    if (m_sliceCount > (YSF_SYNC_LENGTH_SYMBOLS + 1U) && m_sliceCount < (YSF_FRAME_LENGTH_SYMBOLS - 2U)) {
+      int8_t adjustment = m_timing.getAdjustment();
+      if (adjustment != 0)
+        adjustTiming(adjustment);
+    }
+#endif
+  }
+
+  if (ptr == m_endPtr) {
     // Only update the centre and threshold if they are from a good sync
     if (m_lostCount == MAX_SYNC_FRAMES) {
       m_minSyncPtr = m_syncPtr + YSF_FRAME_LENGTH_SAMPLES - 1U;
@@ -161,40 +215,49 @@ void CYSFRX::processData(float sample)
         m_maxSyncPtr -= YSF_FRAME_LENGTH_SAMPLES;
     }
 
-    calculateLevels(m_startPtr, YSF_FRAME_LENGTH_SYMBOLS);
+    // Only the last symbol is left, sliced with the same levels as the rest
+    sliceSymbols(YSF_FRAME_LENGTH_SYMBOLS - m_sliceCount);
 
-    DEBUG4("YSFRX: sync found pos/centre/threshold", m_syncPtr, int16_t(m_centreVal * 2048.0F), int16_t(m_thresholdVal * 2048.0F));
+    // These levels are for the next frame
+    calculateLevels();
 
-    uint8_t frame[YSF_FRAME_LENGTH_BYTES + 3U];
-    samplesToBits(m_startPtr, YSF_FRAME_LENGTH_SYMBOLS, frame, 8U, m_centreVal, m_thresholdVal);
+    DEBUG4("YSFRX: sync found pos/centre/threshold", m_syncPtr, int16_t(m_centreVal * 2048.0F), int16_t(m_thresholdVal * 2048.0F));
 
     // We've not seen a data sync for too long, signal RXLOST and change to RX_NONE
     m_lostCount--;
     if (m_lostCount == 0U) {
       DEBUG1("YSFRX: sync timed out, lost lock");
 
-      io.setDecode(false);
-      io.setADCDetection(false);
+      m_modem.io.setDecode(false);
+      m_modem.io.setADCDetection(false);
 
-      serial.writeYSFLost();
+      m_modem.serial.writeYSFLost();
 
       m_state      = YSFRXS_NONE;
       m_endPtr     = NOENDPTR;
-      m_averagePtr = NOAVEPTR;
       m_countdown  = 0U;
       m_maxCorr    = 0.0F;
+#if defined(RX_24KHZ)
+      m_fraction   = 0.0F;
+#endif
+
+      m_levels.reset();
     } else {
-      frame[0U] = m_lostCount == (MAX_SYNC_FRAMES - 1U) ? 0x01U : 0x00U;
-      writeData(frame);
+      m_frame[0U] = m_lostCount == (MAX_SYNC_FRAMES - 1U) ? 0x01U : 0x00U;
+      writeData(m_frame);
       m_maxCorr = 0.0F;
     }
+
+    // The next frame starts in the same place
+    m_slicePtr   = m_startPtr;
+    m_sliceCount = 0U;
   }
 }
 
 bool CYSFRX::correlateSync()
 {
   if (countBits32((m_bitBuffer[m_bitPtr] & YSF_SYNC_SYMBOLS_MASK) ^ YSF_SYNC_SYMBOLS) <= MAX_SYNC_SYMBOLS_ERRS) {
-    uint16_t ptr = m_dataPtr + YSF_FRAME_LENGTH_SAMPLES - YSF_SYNC_LENGTH_SAMPLES + YSF_RADIO_SYMBOL_LENGTH;
+    uint16_t ptr = m_dataPtr + YSF_FRAME_LENGTH_SAMPLES - YSF_SYNC_LENGTH_SAMPLES + YSF_RX_SYMBOL_LENGTH;
     if (ptr >= YSF_FRAME_LENGTH_SAMPLES)
       ptr -= YSF_FRAME_LENGTH_SAMPLES;
 
@@ -203,7 +266,7 @@ bool CYSFRX::correlateSync()
     float max = -1.0F;
 
     for (uint8_t i = 0U; i < YSF_SYNC_LENGTH_SYMBOLS; i++) {
-      float val = m_buffer[ptr];
+      float val = fromBuffer(m_buffer[ptr]);
 
       if (val > max)
         max = val;
@@ -225,18 +288,18 @@ bool CYSFRX::correlateSync()
         break;
       }
 
-      ptr += YSF_RADIO_SYMBOL_LENGTH;
+      ptr += YSF_RX_SYMBOL_LENGTH;
       if (ptr >= YSF_FRAME_LENGTH_SAMPLES)
         ptr -= YSF_FRAME_LENGTH_SAMPLES;
     }
 
     if (corr > m_maxCorr) {
-      if (m_averagePtr == NOAVEPTR) {
+      if (!m_levels.isValid()) {
         m_centreVal    = (max + min) / 2.0F;
         m_thresholdVal = (max - m_centreVal) * SCALING_FACTOR;
       }
 
-      uint16_t startPtr = m_dataPtr + YSF_FRAME_LENGTH_SAMPLES - YSF_SYNC_LENGTH_SAMPLES + YSF_RADIO_SYMBOL_LENGTH;
+      uint16_t startPtr = m_dataPtr + YSF_FRAME_LENGTH_SAMPLES - YSF_SYNC_LENGTH_SAMPLES + YSF_RX_SYMBOL_LENGTH;
       if (startPtr >= YSF_FRAME_LENGTH_SAMPLES)
         startPtr -= YSF_FRAME_LENGTH_SAMPLES;
 
@@ -260,7 +323,7 @@ bool CYSFRX::correlateSync()
 
         m_startPtr = startPtr;
 
-        m_endPtr = m_dataPtr + YSF_FRAME_LENGTH_SAMPLES - YSF_SYNC_LENGTH_SAMPLES - 1U;
+        m_endPtr = m_dataPtr + YSF_FRAME_LENGTH_SAMPLES - YSF_SYNC_LENGTH_SAMPLES;
         if (m_endPtr >= YSF_FRAME_LENGTH_SAMPLES)
           m_endPtr -= YSF_FRAME_LENGTH_SAMPLES;
 
@@ -272,74 +335,73 @@ bool CYSFRX::correlateSync()
   return false;
 }
 
-void CYSFRX::calculateLevels(uint16_t start, uint16_t count)
+void CYSFRX::calculateLevels()
 {
-  float maxPos = -1.0F;
-  float minPos =  1.0F;
-  float maxNeg =  1.0F;
-  float minNeg = -1.0F;
+  m_levels.update(m_centreVal, m_thresholdVal);
 
-  for (uint16_t i = 0U; i < count; i++) {
-    float sample = m_buffer[start];
+  float posThresh, negThresh;
+  m_levels.getThresholds(posThresh, negThresh);
 
-    if (sample > 0.0F) {
-      if (sample > maxPos)
-        maxPos = sample;
-      if (sample < minPos)
-        minPos = sample;
-    } else {
-      if (sample < maxNeg)
-        maxNeg = sample;
-      if (sample > minNeg)
-        minNeg = sample;
-    }
-
-    start += YSF_RADIO_SYMBOL_LENGTH;
-    if (start >= YSF_FRAME_LENGTH_SAMPLES)
-      start -= YSF_FRAME_LENGTH_SAMPLES;
-  }
+  DEBUG5("YSFRX: pos/neg/centre/threshold", int16_t(posThresh * 2048.0F), int16_t(negThresh * 2048.0F), int16_t(m_centreVal * 2048.0F), int16_t(m_thresholdVal * 2048.0F));
+}
 
-  float posThresh = (maxPos + minPos) / 2.0F;
-  float negThresh = (maxNeg + minNeg) / 2.0F;
+void CYSFRX::startSlicing()
+{
+#if defined(RX_24KHZ)
+  // Only a sync found in this frame says where its symbols peak
+  if (m_maxCorr > 0.0F)
+    findFraction();
+#endif
 
-  float centre = (posThresh + negThresh) / 2.0F;
+  m_slicePtr   = m_startPtr;
+  m_sliceCount = 0U;
 
-  float threshold = posThresh - centre;
+  m_levels.resetFrame();
 
-  DEBUG5("YSFRX: pos/neg/centre/threshold", int16_t(posThresh * 2048.0F), int16_t(negThresh * 2048.0F), int16_t(centre * 2048.0F), int16_t(threshold * 2048.0F));
+  // Catch up with the symbols that have already arrived
+  uint16_t offset = m_dataPtr + YSF_FRAME_LENGTH_SAMPLES - RX_SLICE_DELAY - m_startPtr;
+  if (offset >= YSF_FRAME_LENGTH_SAMPLES)
+    offset -= YSF_FRAME_LENGTH_SAMPLES;
 
-  if (m_averagePtr == NOAVEPTR) {
-    for (uint8_t i = 0U; i < 16U; i++) {
-      m_centre[i]    = centre;
-      m_threshold[i] = threshold;
-    }
+  sliceSymbols(offset / YSF_RX_SYMBOL_LENGTH + 1U);
+}
 
-    m_averagePtr = 0U;
-  } else {
-    m_centre[m_averagePtr] = centre;
-    m_threshold[m_averagePtr] = threshold;
+void CYSFRX::sliceSymbols(uint16_t count)
+{
+  if (count > (YSF_FRAME_LENGTH_SYMBOLS - m_sliceCount))
+    count = YSF_FRAME_LENGTH_SYMBOLS - m_sliceCount;
 
-    m_averagePtr++;
-    if (m_averagePtr >= 16U)
-      m_averagePtr = 0U;
-  }
+  samplesToBits(m_slicePtr, count, m_frame, 8U + m_sliceCount * 2U, m_centreVal, m_thresholdVal);
 
-  m_centreVal    = 0.0F;
-  m_thresholdVal = 0.0F;
+  // The levels for the next frame come from the symbols as they are sliced
+  uint16_t ptr = m_slicePtr;
+  for (uint16_t i = 0U; i < count; i++) {
+#if defined(RX_24KHZ)
+    m_levels.sample(fromBuffer(m_buffer, YSF_FRAME_LENGTH_SAMPLES, ptr, m_fraction));
+#else
+    m_levels.sample(fromBuffer(m_buffer[ptr]));
+#endif
 
-  for (uint8_t i = 0U; i < 16U; i++) {
-    m_centreVal    += m_centre[i];
-    m_thresholdVal += m_threshold[i];
+    ptr += YSF_RX_SYMBOL_LENGTH;
+    if (ptr >= YSF_FRAME_LENGTH_SAMPLES)
+      ptr -= YSF_FRAME_LENGTH_SAMPLES;
   }
 
-  m_centreVal    /= 16.0F;
-  m_thresholdVal /= 16.0F;
+  m_sliceCount += count;
+
+  m_slicePtr += count * YSF_RX_SYMBOL_LENGTH;
+  if (m_slicePtr >= YSF_FRAME_LENGTH_SAMPLES)
+    m_slicePtr -= YSF_FRAME_LENGTH_SAMPLES;
 }
 
 void CYSFRX::samplesToBits(uint16_t start, uint16_t count, uint8_t* buffer, uint16_t offset, float centre, float threshold)
 {
   for (uint16_t i = 0U; i < count; i++) {
-    float sample = m_buffer[start] - centre;
+#if defined(RX_24KHZ)
+    float sample = fromBuffer(m_buffer, YSF_FRAME_LENGTH_SAMPLES, start, m_fraction) - centre;
+#else
+    float sample = fromBuffer(m_buffer[start]) - centre;
+#endif
 
     if (sample < -threshold) {
       WRITE_BIT1(buffer, offset, false);
@@ -363,14 +425,142 @@ void CYSFRX::samplesToBits(uint16_t start, uint16_t count, uint8_t* buffer, uint
       offset++;
     }
 
-    start += YSF_RADIO_SYMBOL_LENGTH;
+    start += YSF_RX_SYMBOL_LENGTH;
     if (start >= YSF_FRAME_LENGTH_SAMPLES)
       start -= YSF_FRAME_LENGTH_SAMPLES;
   }
 }
 
+#if defined(RX_24KHZ)
+float CYSFRX::correlate(uint16_t ptr) const
+{
+  // The sync ends at ptr
+  ptr += YSF_FRAME_LENGTH_SAMPLES - YSF_SYNC_LENGTH_SAMPLES + YSF_RX_SYMBOL_LENGTH;
+  if (ptr >= YSF_FRAME_LENGTH_SAMPLES)
+    ptr -= YSF_FRAME_LENGTH_SAMPLES;
+
+  float corr = 0.0F;
+
+  for (uint8_t i = 0U; i < YSF_SYNC_LENGTH_SYMBOLS; i++) {
+    corr -= float(YSF_SYNC_SYMBOLS_VALUES[i]) * fromBuffer(m_buffer[ptr]);
+
+    ptr += YSF_RX_SYMBOL_LENGTH;
+    if (ptr >= YSF_FRAME_LENGTH_SAMPLES)
+      ptr -= YSF_FRAME_LENGTH_SAMPLES;
+  }
+
+  return corr;
+}
+
+void CYSFRX::findFraction()
+{
+  // At five samples per symbol the nearest sample can be a tenth of a symbol from the centre
+  uint16_t early = (m_syncPtr == 0U) ? (YSF_FRAME_LENGTH_SAMPLES - 1U) : (m_syncPtr - 1U);
+
+  uint16_t late = m_syncPtr + 1U;
+  if (late >= YSF_FRAME_LENGTH_SAMPLES)
+    late = 0U;
+
+  m_fraction = getPeakFraction(correlate(early), correlate(m_syncPtr), correlate(late));
+
+  // The first frame is sliced with the levels of its sync, read at the same point
+  if (m_levels.isValid())
+    return;
+
+  uint16_t ptr = m_startPtr;
+
+  float min =  1.0F;
+  float max = -1.0F;
+
+  for (uint8_t i = 0U; i < YSF_SYNC_LENGTH_SYMBOLS; i++) {
+    float val = fromBuffer(m_buffer, YSF_FRAME_LENGTH_SAMPLES, ptr, m_fraction);
+
+    if (val > max)
+      max = val;
+    if (val < min)
+      min = val;
+
+    ptr += YSF_RX_SYMBOL_LENGTH;
+    if (ptr >= YSF_FRAME_LENGTH_SAMPLES)
+      ptr -= YSF_FRAME_LENGTH_SAMPLES;
+  }
+
+  m_centreVal    = (max + min) / 2.0F;
+  m_thresholdVal = (max - m_centreVal) * SCALING_FACTOR;
+}
+#endif
+
+#if defined(SYMBOL_TIMING)
+bool CYSFRX::isNearSymbol(float sample)
+{
+  uint16_t phase = (m_dataPtr + YSF_FRAME_LENGTH_SAMPLES - m_syncPtr) % YSF_RX_SYMBOL_LENGTH;
+
+#if defined(RX_24KHZ)
+  // The set is read at the slicing point and a sample either side, once the samples around them are in
+  if (phase == 3U) {
+    uint16_t latePtr = m_dataPtr + YSF_FRAME_LENGTH_SAMPLES - 2U;
+    if (latePtr >= YSF_FRAME_LENGTH_SAMPLES)
+      latePtr -= YSF_FRAME_LENGTH_SAMPLES;
+
+    uint16_t onTimePtr = m_dataPtr + YSF_FRAME_LENGTH_SAMPLES - 3U;
+    if (onTimePtr >= YSF_FRAME_LENGTH_SAMPLES)
+      onTimePtr -= YSF_FRAME_LENGTH_SAMPLES;
+
+    uint16_t earlyPtr = m_dataPtr + YSF_FRAME_LENGTH_SAMPLES - 4U;
+    if (earlyPtr >= YSF_FRAME_LENGTH_SAMPLES)
+      earlyPtr -= YSF_FRAME_LENGTH_SAMPLES;
+
+    m_timing.sample(fromBuffer(m_buffer, YSF_FRAME_LENGTH_SAMPLES, earlyPtr, m_fraction) - m_centreVal, fromBuffer(m_buffer, YSF_FRAME_LENGTH_SAMPLES, onTimePtr, m_fraction) - m_centreVal, fromBuffer(m_buffer, YSF_FRAME_LENGTH_SAMPLES, latePtr, m_fraction) - m_centreVal);
+  }
+#else
+  // The late sample completes an early, on time and late set
+  if (phase == 1U) {
+    uint16_t onTimePtr = m_dataPtr + YSF_FRAME_LENGTH_SAMPLES - 1U;
+    if (onTimePtr >= YSF_FRAME_LENGTH_SAMPLES)
+      onTimePtr -= YSF_FRAME_LENGTH_SAMPLES;
+
+    uint16_t earlyPtr = m_dataPtr + YSF_FRAME_LENGTH_SAMPLES - 2U;
+    if (earlyPtr >= YSF_FRAME_LENGTH_SAMPLES)
+      earlyPtr -= YSF_FRAME_LENGTH_SAMPLES;
+
+    m_timing.sample(fromBuffer(m_buffer[earlyPtr]) - m_centreVal, fromBuffer(m_buffer[onTimePtr]) - m_centreVal, sample - m_centreVal);
+  }
+#endif
+
+  return phase <= SYMBOL_TIMING_WINDOW || phase >= (YSF_RX_SYMBOL_LENGTH - SYMBOL_TIMING_WINDOW);
+}
+
+void CYSFRX::adjustTiming(int8_t adjustment)
+{
+#if defined(RX_24KHZ)
+  // Half a sample at a time, the pointers only move when the slicing point passes a sample
+  m_fraction += adjustment > 0 ? 0.5F : -0.5F;
+
+  if (m_fraction > 0.5F) {
+    m_fraction -= 1.0F;
+  } else if (m_fraction < -0.5F) {
+    m_fraction += 1.0F;
+  } else {
+    DEBUG2("YSFRX: symbol timing adjusted", adjustment);
+    return;
+  }
+#endif
+
+  uint16_t offset = adjustment > 0 ? 1U : (YSF_FRAME_LENGTH_SAMPLES - 1U);
+
+  m_syncPtr    = (m_syncPtr + offset) % YSF_FRAME_LENGTH_SAMPLES;
+  m_startPtr   = (m_startPtr + offset) % YSF_FRAME_LENGTH_SAMPLES;
+  m_endPtr     = (m_endPtr + offset) % YSF_FRAME_LENGTH_SAMPLES;
+  m_minSyncPtr = (m_minSyncPtr + offset) % YSF_FRAME_LENGTH_SAMPLES;
+  m_maxSyncPtr = (m_maxSyncPtr + offset) % YSF_FRAME_LENGTH_SAMPLES;
+  m_slicePtr   = (m_slicePtr + offset) % YSF_FRAME_LENGTH_SAMPLES;
+
+  DEBUG2("YSFRX: symbol timing adjusted", adjustment);
+}
+#endif
+
 void CYSFRX::writeData(uint8_t* data)
 {
-  serial.writeYSFData(data, YSF_FRAME_LENGTH_BYTES + 1U);
+  m_modem.serial.writeYSFData(data, YSF_FRAME_LENGTH_BYTES + 1U);
 }
 
@@ -23,19 +23,18 @@
 #include "YSFDefines.h"
 
 // Generated using rcosdesign(0.2, 8, 10, 'sqrt') in MATLAB
-static float RRC_0_2_FILTER[] = {0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,
-								 0.0000000F,  0.0259407F,  0.0180670F,  0.0066836F, -0.0071413F, -0.0219733F, -0.0359813F, -0.0472427F,
-								-0.0539872F, -0.0547807F, -0.0487381F, -0.0357677F, -0.0166021F,  0.0072329F,  0.0333262F,  0.0588092F,
-								 0.0804773F,  0.0952177F,  0.1002838F,  0.0937834F,  0.0748924F,  0.0441603F,  0.0035401F, -0.0436720F,
-								-0.0928678F, -0.1386761F, -0.1751457F, -0.1966002F, -0.1978515F, -0.1750236F, -0.1257668F, -0.0498367F,
-								 0.0509354F,  0.1724601F,  0.3087863F,  0.4523453F,  0.5946226F,  0.7266457F,  0.8398694F,  0.9267555F,
-								 0.9813532F,  1.0000000F,  0.9813532F,  0.9267555F,  0.8398694F,  0.7266457F,  0.5946226F,  0.4523453F,
-								 0.3087863F,  0.1724601F,  0.0509354F, -0.0498367F, -0.1257668F, -0.1750236F, -0.1978515F, -0.1966002F,
-							    -0.1751457F, -0.1386761F, -0.0928678F, -0.0436720F,  0.0035401F,  0.0441603F,  0.0748924F,  0.0937834F,
-								 0.1002838F,  0.0952177F,  0.0804773F,  0.0588092F,  0.0333262F,  0.0072329F, -0.0166021F, -0.0357677F,
-								-0.0487381F, -0.0547807F, -0.0539872F, -0.0472427F, -0.0359813F, -0.0219733F, -0.0071413F,  0.0066836F,
-								 0.0180670F,  0.0259407F}; // numTaps = 90, L = 10
-const uint16_t RRC_0_2_FILTER_PHASE_LEN = 9U; // phaseLength = numTaps/L
+const float CYSFTX::RRC_0_2_FILTER[] = {0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,  0.0000000F,
+								        0.0000000F,  0.0259407F,  0.0180670F,  0.0066836F, -0.0071413F, -0.0219733F, -0.0359813F, -0.0472427F,
+								       -0.0539872F, -0.0547807F, -0.0487381F, -0.0357677F, -0.0166021F,  0.0072329F,  0.0333262F,  0.0588092F,
+								        0.0804773F,  0.0952177F,  0.1002838F,  0.0937834F,  0.0748924F,  0.0441603F,  0.0035401F, -0.0436720F,
+								       -0.0928678F, -0.1386761F, -0.1751457F, -0.1966002F, -0.1978515F, -0.1750236F, -0.1257668F, -0.0498367F,
+								        0.0509354F,  0.1724601F,  0.3087863F,  0.4523453F,  0.5946226F,  0.7266457F,  0.8398694F,  0.9267555F,
+								        0.9813532F,  1.0000000F,  0.9813532F,  0.9267555F,  0.8398694F,  0.7266457F,  0.5946226F,  0.4523453F,
+								        0.3087863F,  0.1724601F,  0.0509354F, -0.0498367F, -0.1257668F, -0.1750236F, -0.1978515F, -0.1966002F,
+							           -0.1751457F, -0.1386761F, -0.0928678F, -0.0436720F,  0.0035401F,  0.0441603F,  0.0748924F,  0.0937834F,
+								        0.1002838F,  0.0952177F,  0.0804773F,  0.0588092F,  0.0333262F,  0.0072329F, -0.0166021F, -0.0357677F,
+								       -0.0487381F, -0.0547807F, -0.0539872F, -0.0472427F, -0.0359813F, -0.0219733F, -0.0071413F,  0.0066836F,
+								        0.0180670F,  0.0259407F}; // numTaps = 90, L = 10
 
 const float YSF_LEVELA_HI =  0.757;
 const float YSF_LEVELB_HI =  0.252;
@@ -51,9 +50,10 @@ const uint8_t YSF_START_SYNC = 0x77U;
 const uint8_t YSF_END_SYNC   = 0xFFU;
 const uint8_t YSF_HANG       = 0x00U;
 
-CYSFTX::CYSFTX() :
+CYSFTX::CYSFTX(CModem& modem) :
+m_modem(modem),
 m_buffer(4000U),
-m_modFilter(YSF_RADIO_SYMBOL_LENGTH, RRC_0_2_FILTER_PHASE_LEN, RRC_0_2_FILTER, 4U),
+m_modFilter(),
 m_poBuffer(),
 m_poLen(0U),
 m_poPtr(0U),
@@ -71,7 +71,7 @@ void CYSFTX::process()
 
   // If we have YSF data to transmit, do so.
   if (m_poLen == 0U && m_buffer.getData() > 0U) {
-    if (!m_tx) {
+    if (!m_modem.tx) {
       for (uint16_t i = 0U; i < m_txDelay; i++)
         m_poBuffer[m_poLen++] = YSF_START_SYNC;
     } else {
@@ -86,7 +86,7 @@ void CYSFTX::process()
 
   if (m_poLen > 0U) {
     // Transmit YSF data.
-    uint16_t space = io.getSpace();
+    uint16_t space = m_modem.io.getSpace();
 
     while (space > (4U * YSF_RADIO_SYMBOL_LENGTH)) {
       uint8_t c = m_poBuffer[m_poPtr++];
@@ -94,7 +94,7 @@ void CYSFTX::process()
 
       // Reduce space and reset the hang timer.
       space -= 4U * YSF_RADIO_SYMBOL_LENGTH;
-      if (m_duplex)
+      if (m_modem.duplex)
         m_txCount = m_txHang;
 
       if (m_poPtr >= m_poLen) {
@@ -105,7 +105,7 @@ void CYSFTX::process()
     }
   } else if (m_txCount > 0U) {
     // Transmit silence until the hang timer has expired.
-    uint16_t space = io.getSpace();
+    uint16_t space = m_modem.io.getSpace();
 
     while (space > (4U * YSF_RADIO_SYMBOL_LENGTH)) {
       writeSilence();
@@ -160,7 +160,7 @@ void CYSFTX::writeByte(uint8_t c)
 
   m_modFilter.process(inBuffer, outBuffer, 4U);
 
-  io.write(STATE_YSF, outBuffer, YSF_RADIO_SYMBOL_LENGTH * 4U);
+  m_modem.io.write(STATE_YSF, outBuffer, YSF_RADIO_SYMBOL_LENGTH * 4U);
 }
 
 void CYSFTX::writeSilence()
@@ -170,7 +170,7 @@ void CYSFTX::writeSilence()
 
   m_modFilter.process(inBuffer, outBuffer, 4U);
 
-  io.write(STATE_YSF, outBuffer, YSF_RADIO_SYMBOL_LENGTH * 4U);
+  m_modem.io.write(STATE_YSF, outBuffer, YSF_RADIO_SYMBOL_LENGTH * 4U);
 }
 
 void CYSFTX::setTXDelay(uint8_t delay)
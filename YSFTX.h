@@ -20,11 +20,14 @@
 #define  YSFTX_H
 
 #include "FIRInterpolator.h"
+#include "YSFDefines.h"
 #include "SerialRB.h"
 
+class CModem;
+
 class CYSFTX {
 public:
-  CYSFTX();
+  CYSFTX(CModem& modem);
 
   uint8_t writeData(const uint8_t* data, uint8_t length);
 
@@ -37,8 +40,14 @@ public:
   void setParams(bool on, uint8_t txHang);
 
 private:
+  // The modulation filter, defined in YSFTX.cpp
+  static const uint16_t RRC_0_2_FILTER_PHASE_LEN = 9U; // phaseLength = numTaps/L
+
+  static const float RRC_0_2_FILTER[];
+
+  CModem&          m_modem;
   CSerialRB        m_buffer;
-  CFIRInterpolator m_modFilter;
+  CStaticFIRInterpolator<YSF_RADIO_SYMBOL_LENGTH, RRC_0_2_FILTER_PHASE_LEN, RRC_0_2_FILTER, 4U> m_modFilter;
   uint8_t          m_poBuffer[1200U];
   uint16_t         m_poLen;
   uint16_t         m_poPtr;